@@ -0,0 +1,46 @@
+// backgroundtask.cpp
+#include "backgroundtask.h"
+#include <QEventLoop>
+#include <QProgressDialog>
+#include <QTimer>
+#include <algorithm>
+#include <thread>
+
+namespace BackgroundTask {
+
+bool run(QWidget* parent, const QString& label, int total, const Job& job) {
+    std::atomic<int>  done{0};
+    std::atomic<bool> cancel{false};
+    std::atomic<bool> finished{false};
+
+    QProgressDialog dlg(label, "Отмена", 0, std::max(1, total), parent);
+    dlg.setWindowModality(Qt::WindowModal);
+    dlg.setAutoClose(false);
+    dlg.setAutoReset(false);
+    // Модально сразу: задача считает по состоянию на момент запуска, и правка окна,
+    // пока диалог ещё не показан, была бы потеряна (или запустила бы задачу повторно).
+    dlg.open();
+
+    std::thread worker([&] {
+        job(done, cancel);
+        finished.store(true);
+    });
+
+    QEventLoop loop;
+    QTimer poll;
+    poll.setInterval(50);
+    QObject::connect(&poll, &QTimer::timeout, &loop, [&] {
+        dlg.setValue(std::min(done.load(), dlg.maximum()));
+        if (finished.load()) loop.quit();
+    });
+    QObject::connect(&dlg, &QProgressDialog::canceled, &loop, [&] {
+        cancel.store(true);
+        dlg.setLabelText("Отмена…");
+    });
+    poll.start();
+    loop.exec();
+    worker.join();
+    return !cancel.load();
+}
+
+} // namespace BackgroundTask
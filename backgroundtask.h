@@ -0,0 +1,27 @@
+// backgroundtask.h
+#pragma once
+#include <QString>
+#include <atomic>
+#include <functional>
+
+class QWidget;
+
+/**
+ * \brief Запуск долгой операции вне GUI-потока с модальным индикатором прогресса.
+ * \details Задача выполняется в отдельном потоке и сама раздаёт работу пулу;
+ *          GUI-поток крутит цикл событий и раз в 50 мс обновляет QProgressDialog.
+ *          Диалог модален с самого запуска: окно не принимает правок, пока задача идёт.
+ *          Кнопка "Отмена" взводит флаг cancel, задача должна его проверять.
+ */
+namespace BackgroundTask {
+
+/// \brief Тело задачи: увеличивает done по мере работы, проверяет cancel.
+using Job = std::function<void(std::atomic<int>& done, const std::atomic<bool>& cancel)>;
+
+/**
+ * \brief Выполнить job, показывая прогресс done/total.
+ * \return false, если пользователь нажал "Отмена".
+ */
+bool run(QWidget* parent, const QString& label, int total, const Job& job);
+
+} // namespace BackgroundTask
@@ -0,0 +1,146 @@
+// bench_bitplane.cpp
+// Микробенчмарк: BitPlane против прежних путей на QBitArray (бит за битом).
+#include "bitplane.h"
+
+#include <QBitArray>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QVector>
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+/// \brief Прежняя реализация PixelGridWidget поверх QBitArray — эталон для сравнения.
+struct LegacyGrid {
+    int rows = 0, cols = 0;
+    QBitArray bits;
+
+    LegacyGrid(int r, int c) : rows(r), cols(c), bits(r * c) {}
+
+    void invert() {
+        for (int i = 0; i < bits.size(); ++i)
+            bits.setBit(i, !bits.testBit(i));
+    }
+    void shiftLeft() {
+        for (int r = 0; r < rows; ++r) {
+            int base = r * cols;
+            for (int c = 0; c < cols - 1; ++c)
+                bits.setBit(base + c, bits.testBit(base + c + 1));
+            bits.clearBit(base + cols - 1);
+        }
+    }
+    void shiftRight() {
+        for (int r = 0; r < rows; ++r) {
+            int base = r * cols;
+            for (int c = cols - 1; c > 0; --c)
+                bits.setBit(base + c, bits.testBit(base + c - 1));
+            bits.clearBit(base);
+        }
+    }
+    void shiftUp() {
+        for (int r = 0; r < rows - 1; ++r)
+            for (int c = 0; c < cols; ++c)
+                bits.setBit(r * cols + c, bits.testBit((r + 1) * cols + c));
+        for (int c = 0; c < cols; ++c)
+            bits.clearBit((rows - 1) * cols + c);
+    }
+    void shiftDown() {
+        for (int r = rows - 1; r > 0; --r)
+            for (int c = 0; c < cols; ++c)
+                bits.setBit(r * cols + c, bits.testBit((r - 1) * cols + c));
+        for (int c = 0; c < cols; ++c)
+            bits.clearBit(c);
+    }
+    void resizePreserve(int newRows, int newCols) {
+        QBitArray nb(newRows * newCols);
+        const int cr = std::min(rows, newRows), cc = std::min(cols, newCols);
+        for (int r = 0; r < cr; ++r)
+            for (int c = 0; c < cc; ++c)
+                nb.setBit(r * newCols + c, bits.testBit(r * cols + c));
+        bits = nb; rows = newRows; cols = newCols;
+    }
+    void importBytes(const QVector<quint8>& bytes, int bpr) {
+        int idx = 0;
+        for (int r = 0; r < rows; ++r)
+            for (int b = 0; b < bpr; ++b) {
+                const quint8 V = bytes[idx++];
+                for (int bit = 7; bit >= 0; --bit)
+                    bits.setBit(r * cols + b * 8 + (7 - bit), (V >> bit) & 1);
+            }
+    }
+    QVector<quint8> exportBytes() const {
+        const int bpr = cols / 8;
+        QVector<quint8> out(rows * bpr);
+        int idx = 0;
+        for (int r = 0; r < rows; ++r)
+            for (int b = 0; b < bpr; ++b) {
+                quint8 V = 0;
+                for (int x = 0; x < 8; ++x)
+                    V |= (bits.testBit(r * cols + b * 8 + x) ? 1 : 0) << (7 - x);
+                out[idx++] = V;
+            }
+        return out;
+    }
+};
+
+/// \brief Прогнать fn достаточно раз (не менее ~50 мс) и вернуть среднее время в мкс.
+double measureUs(const std::function<void()>& fn) {
+    QElapsedTimer t;
+    int iters = 0;
+    t.start();
+    do {
+        fn();
+        ++iters;
+    } while (t.nsecsElapsed() < 50'000'000 || iters < 3);
+    return double(t.nsecsElapsed()) / iters / 1000.0;
+}
+
+void row(QTextStream& out, const QString& name, double legacyUs, double planeUs) {
+    out << qSetFieldWidth(22) << Qt::left << name << qSetFieldWidth(14) << Qt::right
+        << QString::number(legacyUs, 'f', 2) << QString::number(planeUs, 'f', 3)
+        << QString::number(legacyUs / planeUs, 'f', 0) + "x" << qSetFieldWidth(0) << Qt::endl;
+}
+
+void benchSize(QTextStream& out, int n) {
+    const int bpr = n / 8;
+    QVector<quint8> bytes(n * bpr);
+    for (int i = 0; i < bytes.size(); ++i)
+        bytes[i] = quint8(i * 131 + 7);
+
+    LegacyGrid legacy(n, n);
+    legacy.importBytes(bytes, bpr);
+    BitPlane plane(n, n);
+    plane.importRows(bytes.constData(), bpr, true);
+
+    out << Qt::endl << n << "x" << n << Qt::endl;
+    out << qSetFieldWidth(22) << Qt::left << "op" << qSetFieldWidth(14) << Qt::right
+        << "QBitArray, us" << "BitPlane, us" << "speedup" << qSetFieldWidth(0) << Qt::endl;
+
+    row(out, "invert",     measureUs([&]{ legacy.invert(); }),     measureUs([&]{ plane.invert(); }));
+    row(out, "shiftLeft",  measureUs([&]{ legacy.shiftLeft(); }),  measureUs([&]{ plane.shiftLeft(); }));
+    row(out, "shiftRight", measureUs([&]{ legacy.shiftRight(); }), measureUs([&]{ plane.shiftRight(); }));
+    row(out, "shiftUp",    measureUs([&]{ legacy.shiftUp(); }),    measureUs([&]{ plane.shiftUp(); }));
+    row(out, "shiftDown",  measureUs([&]{ legacy.shiftDown(); }),  measureUs([&]{ plane.shiftDown(); }));
+    row(out, "resizePreserve",
+        measureUs([&]{ legacy.resizePreserve(n + 8, n + 8); legacy.resizePreserve(n, n); }),
+        measureUs([&]{ plane = plane.resized(n + 8, n + 8); plane = plane.resized(n, n); }));
+    row(out, "importBytes",
+        measureUs([&]{ legacy.importBytes(bytes, bpr); }),
+        measureUs([&]{ plane.importRows(bytes.constData(), bpr, true); }));
+    QVector<quint8> sink(n * bpr);
+    row(out, "exportBytes",
+        measureUs([&]{ sink = legacy.exportBytes(); }),
+        measureUs([&]{ plane.exportRows(sink.data(), bpr, true); }));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    for (int n : {256, 1024})
+        benchSize(out, n);
+    return 0;
+}
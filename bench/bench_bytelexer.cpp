@@ -0,0 +1,105 @@
+// bench_bytelexer.cpp
+// Микробенчмарк: ByteLexer против прежнего parseBytes на QRegularExpression.
+#include "bytelexer.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QTextStream>
+#include <QVector>
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+/// \brief Прежний parseBytes (регулярные выражения) — эталон для сравнения.
+QVector<quint8> legacyParseBytes(const QString& text) {
+    QString s = text;
+    s.replace(QRegularExpression(R"(//[^\n\r]*)"), " ");
+    QRegularExpression rx(R"(0x([0-9A-Fa-f]{1,2})|\b(\d{1,3})\b)",
+                          QRegularExpression::CaseInsensitiveOption);
+    QVector<quint8> out;
+    auto it = rx.globalMatch(s);
+    while (it.hasNext()) {
+        auto m = it.next();
+        bool ok = false; int v = 0;
+        if (m.captured(1).size()) v = m.captured(1).toInt(&ok, 16);
+        else                      v = m.captured(2).toInt(&ok, 10);
+        if (ok && v >= 0 && v <= 255) out.push_back(static_cast<quint8>(v));
+    }
+    return out;
+}
+
+/// \brief Сгенерировать C-заголовок шрифта ~targetBytes: строки "0xNN, ..., // ####".
+QByteArray makeHeader(qsizetype targetBytes) {
+    QByteArray h;
+    h.reserve(targetBytes + 256);
+    h += "// generated font\nstatic const unsigned char font[] = {\n";
+    quint32 x = 12345;
+    static const char digits[] = "0123456789ABCDEF";
+    while (h.size() < targetBytes) {
+        QByteArray art;
+        h += "    ";
+        for (int b = 0; b < 4; ++b) {
+            x = x * 1103515245u + 12345u;
+            const quint8 v = quint8(x >> 16);
+            h += "0x"; h += digits[v >> 4]; h += digits[v & 15]; h += ", ";
+            for (int k = 7; k >= 0; --k) art += (v >> k) & 1 ? '#' : ' ';
+        }
+        h += " // " + art + "\n";
+    }
+    h += "};\n";
+    return h;
+}
+
+/// \brief Время одного прогона fn в мс (лучшее из n).
+double bestMs(const std::function<void()>& fn, int n) {
+    double best = 1e300;
+    for (int i = 0; i < n; ++i) {
+        QElapsedTimer t;
+        t.start();
+        fn();
+        best = std::min(best, t.nsecsElapsed() / 1e6);
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const QByteArray utf8 = makeHeader(10 << 20);
+    const QString text = QString::fromUtf8(utf8);
+
+    QVector<quint8> a, b, c;
+    const double legacyMs = bestMs([&]{ a = legacyParseBytes(text); }, 1);
+    const double utf16Ms  = bestMs([&]{ b = ByteLexer::parse(text); }, 5);
+    const double utf8Ms   = bestMs([&]{
+        ByteLexer lx;
+        for (qsizetype off = 0; off < utf8.size(); off += 64 * 1024)
+            lx.feed(utf8.constData() + off, std::min<qsizetype>(64 * 1024, utf8.size() - off));
+        lx.finish();
+        c = lx.takeBytes();
+    }, 5);
+
+    out << "header: " << utf8.size() / 1024 << " KB, bytes: " << a.size() << Qt::endl;
+    out << qSetFieldWidth(26) << Qt::left << "path" << qSetFieldWidth(12) << Qt::right
+        << "ms" << "MB/s" << "speedup" << qSetFieldWidth(0) << Qt::endl;
+    auto row = [&](const char* name, double ms) {
+        out << qSetFieldWidth(26) << Qt::left << name << qSetFieldWidth(12) << Qt::right
+            << QString::number(ms, 'f', 1)
+            << QString::number(utf8.size() / 1048576.0 / (ms / 1000.0), 'f', 0)
+            << QString::number(legacyMs / ms, 'f', 1) + "x" << qSetFieldWidth(0) << Qt::endl;
+    };
+    row("QRegularExpression", legacyMs);
+    row("ByteLexer UTF-16", utf16Ms);
+    row("ByteLexer UTF-8 chunks", utf8Ms);
+
+    if (a != b || a != c) {
+        out << "MISMATCH: results differ" << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+// bench_codec.cpp
+// Микробенчмарк сжатия глифов: размер и скорость распаковки каждой схемы GlyphCodec.
+#include "fontdocument.h"
+#include "fontrasterizer.h"
+#include "glyphcodec.h"
+
+#include <QElapsedTimer>
+#include <QFontDatabase>
+#include <QGuiApplication>
+#include <QTextStream>
+#include <QVector>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#  else
+#    include <x86intrin.h>
+#  endif
+#  define FONTCREATOR_HAVE_RDTSC 1
+#endif
+
+namespace {
+
+/// \brief Набор глифов: системный шрифт заданного размера, иначе синтетические фигуры.
+FontDocument makeFont(int pixelSize) {
+    FontDocument doc;
+    RasterizeOptions opt;
+    opt.family = QFontDatabase::systemFont(QFontDatabase::GeneralFont).family();
+    opt.pixelSize = pixelSize;
+    opt.ranges = FontRasterizer::parseRanges("0x20-0x7E, 0x410-0x44F");
+    if (FontRasterizer::rasterize(opt, doc) && !doc.isEmpty())
+        return doc;
+
+    doc.clear();
+    for (int g = 0; g < 160; ++g) {
+        BitPlane b(pixelSize, pixelSize);
+        const int r = 2 + g % (pixelSize / 2 - 1);
+        for (int y = 0; y < pixelSize; ++y)
+            for (int x = 0; x < pixelSize; ++x) {
+                const int dx = x - pixelSize / 2, dy = y - pixelSize / 2;
+                const int d2 = dx * dx + dy * dy;
+                b.setPixel(y, x, (d2 <= r * r && d2 >= (r - 2) * (r - 2)) || (g & 1 && x == y));
+            }
+        doc.setGlyph(doc.addGlyph(quint32(g), pixelSize, pixelSize), b);
+    }
+    return doc;
+}
+
+void benchFont(QTextStream& out, const FontDocument& doc, int pixelSize) {
+    qint64 rawBytes = 0;
+    for (const GlyphEntry& e : doc.entries())
+        rawBytes += e.byteSize();
+
+    out << Qt::endl << pixelSize << " px, " << doc.glyphCount() << " glyphs, raw " << rawBytes << " bytes" << Qt::endl;
+    out << qSetFieldWidth(10) << Qt::left << "codec" << qSetFieldWidth(12) << Qt::right
+        << "bytes" << "ratio" << "ns/byte" << "cyc/byte" << qSetFieldWidth(0) << Qt::endl;
+
+    for (const QString& name : GlyphCodec::names()) {
+        const GlyphCodecKind kind = GlyphCodec::fromName(name);
+        QVector<QByteArray> streams;
+        qint64 packed = 0;
+        for (int i = 0; i < doc.glyphCount(); ++i) {
+            streams.append(GlyphCodec::encode(kind, doc.glyphData(i), doc.entry(i).byteSize()));
+            packed += streams.last().size();
+        }
+
+        QVector<quint8> dst(4096 * 512);
+        // Проверка туда и обратно до замера: байты распаковки должны совпасть с глифом.
+        bool ok = true;
+        for (int i = 0; i < doc.glyphCount() && ok; ++i) {
+            const QByteArray& s = streams[i];
+            const int n = doc.entry(i).byteSize();
+            ok = GlyphCodec::decode(kind, reinterpret_cast<const quint8*>(s.constData()), int(s.size()), dst.data(), n)
+                 && std::memcmp(dst.constData(), doc.glyphData(i), size_t(n)) == 0;
+        }
+
+        int passes = 0;
+        QElapsedTimer t;
+#ifdef FONTCREATOR_HAVE_RDTSC
+        const quint64 c0 = __rdtsc();
+#endif
+        t.start();
+        do {
+            for (int i = 0; i < doc.glyphCount(); ++i) {
+                const QByteArray& s = streams[i];
+                ok &= GlyphCodec::decode(kind, reinterpret_cast<const quint8*>(s.constData()), int(s.size()),
+                                         dst.data(), doc.entry(i).byteSize());
+            }
+            ++passes;
+        } while (t.nsecsElapsed() < 100'000'000);
+        const double ns = double(t.nsecsElapsed());
+#ifdef FONTCREATOR_HAVE_RDTSC
+        const double cycles = double(__rdtsc() - c0);
+#else
+        const double cycles = 0;
+#endif
+        const double bytes = double(rawBytes) * passes;
+
+        out << qSetFieldWidth(10) << Qt::left << name << qSetFieldWidth(12) << Qt::right
+            << packed
+            << QString::number(double(packed) / rawBytes, 'f', 3)
+            << QString::number(ns / bytes, 'f', 3)
+            << (cycles > 0 ? QString::number(cycles / bytes, 'f', 2) : QString("n/a"))
+            << qSetFieldWidth(0) << (ok ? "" : "  DECODE ERROR") << Qt::endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // Без дисплея (сборочный сервер) QRawFont работает и на offscreen-платформе.
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+    QTextStream out(stdout);
+    for (int px : { 12, 16, 32, 64 })
+        benchFont(out, makeFont(px), px);
+    return 0;
+}
@@ -0,0 +1,260 @@
+// bench_suite.cpp
+// Набор бенчмарков горячих путей глифа (PixelGridWidget + GlyphIO) на сетках 8×8 … 4096×4096.
+// Результат — JSON (для отслеживания регрессий между релизами), таблица — в stderr.
+//
+//   FontCreator_bench                          :: все размеры, JSON в stdout
+//   FontCreator_bench --json bench.json        :: JSON в файл
+//   FontCreator_bench --sizes 64,1024 --filter shift --min-ms 200
+#include "bitstream.h"
+#include "fontdocument.h"
+#include "glyphbatch.h"
+#include "glyphio.h"
+#include "pixelgridwidget.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegion>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+/// \brief Область экрана для замера paintEvent (видимая часть сетки в окне).
+const QSize kViewport(1024, 768);
+/// \brief Сколько независимых прогонов делается для каждого случая (берётся лучший).
+constexpr int kRuns = 3;
+
+struct Case {
+    QString               name;
+    std::function<void()> fn;
+};
+
+struct Result {
+    qint64 iterations = 0;
+    double bestNs = 0;  ///< лучшее среднее по прогонам, нс/операцию
+    double meanNs = 0;  ///< среднее по всем итерациям
+};
+
+/// \brief kRuns прогонов по minMs / kRuns мс (не меньше одной итерации) после одного прогрева.
+Result measure(const std::function<void()>& fn, double minMs) {
+    fn();
+    Result r;
+    r.bestNs = 1e300;
+    qint64 totalNs = 0;
+    const qint64 budgetNs = qint64(minMs * 1e6 / kRuns);
+    for (int run = 0; run < kRuns; ++run) {
+        QElapsedTimer t;
+        qint64 iters = 0;
+        t.start();
+        do {
+            fn();
+            ++iters;
+        } while (t.nsecsElapsed() < budgetNs);
+        const qint64 ns = t.nsecsElapsed();
+        r.bestNs = std::min(r.bestNs, double(ns) / iters);
+        r.iterations += iters;
+        totalNs += ns;
+    }
+    r.meanNs = double(totalNs) / r.iterations;
+    return r;
+}
+
+/// \brief Псевдослучайные байты глифа (детерминированно, без внешних зависимостей).
+QVector<quint8> makeBytes(qsizetype n) {
+    QVector<quint8> bytes(n);
+    quint32 x = 0x12345678u;
+    for (quint8& b : bytes) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        b = quint8(x >> 24);
+    }
+    return bytes;
+}
+
+/// \brief Шрифт из n глифов 16×16 с байтами из bytes (по кругу).
+FontDocument makeFont(int n, const QVector<quint8>& bytes) {
+    FontDocument doc;
+    doc.addRange(0, n, 16, 16);
+    for (int i = 0; i < n; ++i) {
+        quint8* dst = doc.mutableGlyphData(i);
+        for (int k = 0; k < doc.entry(i).byteSize(); ++k)
+            dst[k] = bytes[(qsizetype(i) * 32 + k) % bytes.size()];
+    }
+    return doc;
+}
+
+/// \brief Картинка-«скан» для importFromImage: шум с крупными пятнами, RGB32.
+QImage makeImage(int n) {
+    QImage img(n, n, QImage::Format_RGB32);
+    quint32 x = 0x9E3779B9u;
+    for (int y = 0; y < n; ++y) {
+        QRgb* line = reinterpret_cast<QRgb*>(img.scanLine(y));
+        for (int c = 0; c < n; ++c) {
+            x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+            const int v = ((c / 8 + y / 8) & 1 ? 200 : 40) + int(x >> 28);
+            line[c] = qRgb(v, v, v);
+        }
+    }
+    return img;
+}
+
+QVector<Case> makeCases(PixelGridWidget& w, int n, const QVector<quint8>& bytes, const QString& hexList,
+                        const QString& escaped, const QImage& image, QImage& target) {
+    const PackFormat fmt;
+    const QByteArray stream = BitStream::pack(w.bits());
+    return {
+        { "importBytes",        [&w, &bytes, n, fmt] { w.importBytes(bytes, n, fmt); } },
+        { "exportBytes",        [&w] { const QVector<quint8> out = w.exportBytes(); Q_UNUSED(out); } },
+        { "exportCWithAscii",   [&w] { const QString out = w.exportCWithAscii(); Q_UNUSED(out); } },
+        { "parseBytes",         [&hexList] { const QVector<quint8> out = GlyphIO::parseBytes(hexList); Q_UNUSED(out); } },
+        { "parseHexString",     [&escaped] { const QByteArray out = GlyphIO::parseHexString(escaped); Q_UNUSED(out); } },
+        { "importFromImage",    [&w, &image] { w.importFromImage(image, true, 128, false); } },
+        { "toQImage",           [&w] { const QImage out = w.toQImage(); Q_UNUSED(out); } },
+        // Квантование картинки в 16 уровней серого (4 бита на пиксель).
+        { "imageToLevels4",     [&image, n, plane = BitPlane(n, n * 4)]() mutable {
+              GlyphIO::imageToLevels(image, plane, 4);
+          } },
+        // Пакетная обработка шрифта из n глифов 16×16: сдвиг и инверсия за один проход.
+        // Копия документа делит арену с исходным: каждая итерация начинает с тех же глифов.
+        { "glyphBatch",         [font = makeFont(n, bytes)] {
+              GlyphTransform t;
+              t.invert = true;
+              t.shiftX = 1;
+              t.shiftY = 1;
+              FontDocument doc = font;
+              GlyphBatch::apply(doc, {}, t);
+          } },
+        // Плотный поток бит экспорта шрифта: упаковка и распаковка всей сетки.
+        { "bitstreamPack",      [&w] { const QByteArray out = BitStream::pack(w.bits()); Q_UNUSED(out); } },
+        { "bitstreamUnpack",    [stream, n, plane = BitPlane()]() mutable { BitStream::unpack(stream, plane, n, n); } },
+        // Промах кэша плиток обзора: плитка 1:4 с ближайшим соседом.
+        { "renderNearestTile",  [&w] {
+              const QImage out = GlyphIO::renderNearest(w.bits(), 1, 4, QRect(0, 0, PixelGridWidget::kLodTile,
+                                                                               PixelGridWidget::kLodTile));
+              Q_UNUSED(out);
+          } },
+        { "shiftLeft",          [&w] { w.shiftLeft(); } },
+        { "shiftRight",         [&w] { w.shiftRight(); } },
+        { "shiftUp",            [&w] { w.shiftUp(); } },
+        { "shiftDown",          [&w] { w.shiftDown(); } },
+        { "invert",             [&w] { w.invert(); } },
+        // Туда и обратно: размер сетки между итерациями не накапливается.
+        { "resizeGridPreserve", [&w, n] { w.resizeGridPreserve(n + 8, n + 8); w.resizeGridPreserve(n, n); } },
+        { "paintEvent",         [&w, &target] {
+              w.render(&target, QPoint(), QRegion(QRect(QPoint(), target.size())));
+          } },
+    };
+}
+
+QVector<int> parseSizes(const QString& s) {
+    QVector<int> sizes;
+    for (const QString& part : s.split(',', Qt::SkipEmptyParts)) {
+        const int n = part.trimmed().toInt();
+        if (n >= 8) sizes.append(n / 8 * 8);
+    }
+    return sizes;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // Без дисплея (сборочный сервер): paintEvent рисуется в QImage через offscreen-платформу.
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName("FontCreator_bench");
+
+    QCommandLineParser cli;
+    cli.setApplicationDescription("Бенчмарки горячих путей глифа, JSON для отслеживания регрессий.");
+    cli.addHelpOption();
+    const QCommandLineOption optJson("json", "Записать JSON в файл (по умолчанию — stdout).", "file");
+    const QCommandLineOption optSizes("sizes", "Стороны сеток через запятую (кратно 8).", "list",
+                                      "8,16,32,64,128,256,512,1024,2048,4096");
+    const QCommandLineOption optFilter("filter", "Только случаи, имя которых содержит строку.", "text");
+    const QCommandLineOption optMinMs("min-ms", "Время замера одного случая, мс.", "ms", "60");
+    cli.addOptions({ optJson, optSizes, optFilter, optMinMs });
+    cli.process(app);
+
+    const QVector<int> sizes = parseSizes(cli.value(optSizes));
+    const QString filter = cli.value(optFilter);
+    const double minMs = std::max(1.0, cli.value(optMinMs).toDouble());
+
+    QTextStream table(stderr);
+    table << qSetFieldWidth(20) << Qt::left << "case" << qSetFieldWidth(12) << Qt::right
+          << "size" << "iters" << "ns/op" << "MB/s" << qSetFieldWidth(0) << Qt::endl;
+
+    QJsonArray results;
+    for (int n : sizes) {
+        const int bpr = n / 8;
+        const QVector<quint8> bytes = makeBytes(qsizetype(n) * bpr);
+        const QString hexList = GlyphIO::formatHexList(bytes);
+        const QString escaped = GlyphIO::bytesToEscapedHex(
+            QByteArray(reinterpret_cast<const char*>(bytes.constData()), bytes.size()));
+        const QImage image = makeImage(n);
+
+        PixelGridWidget w;
+        w.setCellSize(6);
+        w.importBytes(bytes, n, PackFormat());
+        w.resize(w.sizeHint());
+        QImage target(w.size().boundedTo(kViewport), QImage::Format_ARGB32_Premultiplied);
+
+        const QString size = QString("%1x%1").arg(n);
+        const double payload = double(bytes.size()); // байты битмапа — общая мера для MB/s
+        for (const Case& c : makeCases(w, n, bytes, hexList, escaped, image, target)) {
+            if (!filter.isEmpty() && !c.name.contains(filter, Qt::CaseInsensitive))
+                continue;
+            const Result r = measure(c.fn, minMs);
+            const double mbps = payload / (r.bestNs / 1e9) / 1048576.0;
+
+            QJsonObject o;
+            o["name"] = c.name;
+            o["rows"] = n;
+            o["cols"] = n;
+            o["payload_bytes"] = payload;
+            o["iterations"] = r.iterations;
+            o["ns_per_op"] = r.bestNs;
+            o["ns_per_op_mean"] = r.meanNs;
+            o["mb_per_s"] = mbps;
+            results.append(o);
+
+            table << qSetFieldWidth(20) << Qt::left << c.name << qSetFieldWidth(12) << Qt::right
+                  << size << r.iterations << QString::number(r.bestNs, 'f', 0)
+                  << QString::number(mbps, 'f', 1) << qSetFieldWidth(0) << Qt::endl;
+        }
+    }
+
+    QJsonObject root;
+    root["benchmark"] = "FontCreator_bench";
+    root["qt"] = QString(qVersion());
+#ifdef FONTCREATOR_SSE2
+    root["sse2"] = true;
+#else
+    root["sse2"] = false;
+#endif
+    root["threads"] = QThread::idealThreadCount();
+    root["min_ms"] = minMs;
+    root["viewport"] = QString("%1x%2").arg(kViewport.width()).arg(kViewport.height());
+    root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["results"] = results;
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+
+    if (cli.isSet(optJson)) {
+        QFile f(cli.value(optJson));
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate) || f.write(json) != json.size()) {
+            table << "cannot write " << f.fileName() << Qt::endl;
+            return 1;
+        }
+    } else {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+}
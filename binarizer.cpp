@@ -0,0 +1,176 @@
+// binarizer.cpp
+#include "binarizer.h"
+#include "glyphio.h"
+#include "workstealingpool.h"
+#include <QVector>
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace Binarizer {
+
+namespace {
+
+constexpr int kBand = 64; ///< строк в одной параллельной полосе
+
+/// \brief Классическая матрица Байера 8×8 (значения 0..63).
+constexpr quint8 kBayer[8][8] = {
+    {  0, 32,  8, 40,  2, 34, 10, 42 },
+    { 48, 16, 56, 24, 50, 18, 58, 26 },
+    { 12, 44,  4, 36, 14, 46,  6, 38 },
+    { 60, 28, 52, 20, 62, 30, 54, 22 },
+    {  3, 35, 11, 43,  1, 33,  9, 41 },
+    { 51, 19, 59, 27, 49, 17, 57, 25 },
+    { 15, 47,  7, 39, 13, 45,  5, 37 },
+    { 63, 31, 55, 23, 61, 29, 53, 21 },
+};
+
+/// \brief Строка y Grayscale8-данных с шагом bpl.
+inline const uchar* line(const uchar* gray, qsizetype bpl, int y) { return gray + qsizetype(y) * bpl; }
+
+/// \brief Выполнить fn(y0, y1) по строкам: параллельно, если изображение большое.
+template <typename Fn>
+void forRows(int width, int height, Fn&& fn) {
+    if (qint64(width) * height < GlyphIO::kParallelPixels) fn(0, height);
+    else WorkStealingPool::global().parallelFor(0, height, kBand, fn);
+}
+
+void ordered(const uchar* g, qsizetype bpl, quint8* base, int stride, int w, int h, int bias, bool invert) {
+    quint8 pattern[8][16];
+    for (int y = 0; y < 8; ++y)
+        for (int x = 0; x < 16; ++x)
+            pattern[y][x] = quint8(qBound(1, kBayer[y][x & 7] * 4 + 2 + bias, 255));
+    forRows(w, h, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y)
+            GlyphIO::packGrayRowPattern(line(g, bpl, y), w, base + qsizetype(y) * stride,
+                                        pattern[y & 7], invert);
+    });
+}
+
+void floydSteinberg(const uchar* g, qsizetype bpl, quint8* base, int stride, int w, int h, int mid, bool invert) {
+    // Ошибка хранится в 1/16 долях; +2 на края, чтобы не проверять границы.
+    QVector<int> errA(w + 2, 0), errB(w + 2, 0);
+    int* cur = errA.data() + 1;
+    int* next = errB.data() + 1;
+    const quint8 flip = invert ? 0xFF : 0x00;
+
+    for (int y = 0; y < h; ++y) {
+        const uchar* src = line(g, bpl, y);
+        quint8* dst = base + qsizetype(y) * stride;
+        std::fill(next - 1, next + w + 1, 0);
+        quint8 acc = 0;
+        for (int x = 0; x < w; ++x) {
+            const int v = src[x] + cur[x] / 16;
+            const bool black = v < mid;
+            const int e = v - (black ? 0 : 255);
+            cur[x + 1]  += e * 7;
+            next[x - 1] += e * 3;
+            next[x]     += e * 5;
+            next[x + 1] += e;
+            acc = quint8((acc << 1) | (black ? 1 : 0));
+            if ((x & 7) == 7) { dst[x >> 3] = acc ^ flip; acc = 0; }
+        }
+        if (w & 7) {
+            const int n = w & 7;
+            dst[w >> 3] = quint8(((acc << (8 - n)) ^ flip) & (0xFF << (8 - n)));
+        }
+        std::swap(cur, next);
+    }
+}
+
+} // namespace
+
+int otsuThreshold(const QImage& gray8) {
+    return otsuThreshold(gray8.constBits(), gray8.bytesPerLine(), gray8.width(), gray8.height());
+}
+
+int otsuThreshold(const uchar* gray, qsizetype bpl, int w, int h) {
+    if (w <= 0 || h <= 0) return 128;
+
+    // Гистограммы по полосам, затем сложение — без блокировок.
+    using Hist = std::array<quint32, 256>;
+    QVector<Hist> bands((h + kBand - 1) / kBand);
+    for (Hist& b : bands) b.fill(0);
+    forRows(w, h, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            Hist& hist = bands[y / kBand];
+            const uchar* p = line(gray, bpl, y);
+            for (int x = 0; x < w; ++x)
+                ++hist[p[x]];
+        }
+    });
+    std::array<quint64, 256> hist{};
+    for (const Hist& b : bands)
+        for (int i = 0; i < 256; ++i)
+            hist[i] += b[i];
+
+    const double total = double(w) * h;
+    double sumAll = 0;
+    for (int i = 0; i < 256; ++i)
+        sumAll += double(i) * hist[i];
+
+    double sumB = 0, wB = 0, best = -1;
+    int bestT = 127;
+    for (int t = 0; t < 256; ++t) {
+        wB += hist[t];
+        if (wB == 0) continue;
+        const double wF = total - wB;
+        if (wF == 0) break;
+        sumB += double(t) * hist[t];
+        const double mB = sumB / wB;
+        const double mF = (sumAll - sumB) / wF;
+        const double between = wB * wF * (mB - mF) * (mB - mF);
+        if (between > best) { best = between; bestT = t; }
+    }
+    return bestT + 1; // класс "тёмных" — [0..bestT]
+}
+
+void binarize(const QImage& src, BitPlane& dst, const BinarizeOptions& opt, int* usedThreshold) {
+    if (usedThreshold) *usedThreshold = opt.threshold;
+    if (opt.mode == BinarizeMode::Threshold) {
+        GlyphIO::imageToBits(src, dst, opt.threshold, opt.invert);
+        return;
+    }
+
+    dst.fill(false);
+    if (src.isNull()) return;
+    const QImage g = src.convertToFormat(QImage::Format_Grayscale8);
+    const int w = std::min(dst.cols(), g.width());
+    const int h = std::min(dst.rows(), g.height());
+    if (w <= 0 || h <= 0) return;
+    binarizeGray(g.constBits(), g.bytesPerLine(), w, h, dst.rowBytes(0), dst.strideBytes(), opt, usedThreshold);
+}
+
+void binarizeGray(const uchar* gray, qsizetype bpl, int w, int h, quint8* dst, int dstStride,
+                  const BinarizeOptions& opt, int* usedThreshold) {
+    if (usedThreshold) *usedThreshold = opt.threshold;
+    if (w <= 0 || h <= 0) return;
+
+    switch (opt.mode) {
+    case BinarizeMode::Threshold:
+    case BinarizeMode::Otsu: {
+        const int t = opt.mode == BinarizeMode::Otsu ? otsuThreshold(gray, bpl, w, h) : opt.threshold;
+        if (usedThreshold) *usedThreshold = t;
+        forRows(w, h, [&](int y0, int y1) {
+            for (int y = y0; y < y1; ++y)
+                GlyphIO::packGrayRow(line(gray, bpl, y), w, dst + qsizetype(y) * dstStride, t, opt.invert);
+        });
+        break;
+    }
+    case BinarizeMode::Ordered:
+        ordered(gray, bpl, dst, dstStride, w, h, opt.threshold - 128, opt.invert);
+        break;
+    case BinarizeMode::FloydSteinberg:
+        floydSteinberg(gray, bpl, dst, dstStride, w, h, opt.threshold, opt.invert);
+        break;
+    }
+}
+
+BitPlane binarized(const QImage& src, const BinarizeOptions& opt, int* usedThreshold) {
+    if (src.isNull()) return {};
+    BitPlane bits(src.height(), src.width());
+    binarize(src, bits, opt, usedThreshold);
+    return bits;
+}
+
+} // namespace Binarizer
@@ -0,0 +1,58 @@
+// binarizer.h
+#pragma once
+#include <QImage>
+#include "bitplane.h"
+
+/** \brief Способ бинаризации изображения. */
+enum class BinarizeMode {
+    Threshold,      ///< фиксированный порог
+    Otsu,           ///< порог Оцу по гистограмме изображения
+    FloydSteinberg, ///< диффузия ошибки Флойда–Стейнберга
+    Ordered         ///< упорядоченный дизеринг (матрица Байера 8×8)
+};
+
+/**
+ * \brief Параметры бинаризации.
+ * \details threshold: для Threshold — порог (< порога → чёрный), для FloydSteinberg —
+ *          середина квантования, для Ordered — сдвиг яркости (128 — без сдвига).
+ *          Для Otsu не используется. invert применяется после бинаризации.
+ */
+struct BinarizeOptions {
+    BinarizeMode mode = BinarizeMode::Threshold;
+    int  threshold = 128;
+    bool invert = false;
+};
+
+/**
+ * \brief Бинаризация изображений в BitPlane построчно по сканлайнам.
+ * \details Пороговые режимы (Threshold, Otsu, Ordered) используют SSE2-ядра GlyphIO и
+ *          обрабатывают строки параллельно в WorkStealingPool::global(); гистограмма Оцу
+ *          считается за один проход, тоже по полосам. Флойд–Стейнберг последователен
+ *          по строкам (ошибка переносится вниз), но пишет биты сразу в плоскость.
+ */
+namespace Binarizer {
+
+/** \brief Порог Оцу для Grayscale8-изображения (в семантике "< порога → чёрный"). */
+int otsuThreshold(const QImage& gray8);
+/** \brief То же для области Grayscale8-данных w×h с шагом строки bpl. */
+int otsuThreshold(const uchar* gray, qsizetype bpl, int w, int h);
+
+/**
+ * \brief Бинаризовать src в существующую плоскость (общая область, остальное — 0).
+ * \param usedThreshold Фактический порог (для Otsu — вычисленный), может быть nullptr.
+ */
+void binarize(const QImage& src, BitPlane& dst, const BinarizeOptions& opt, int* usedThreshold = nullptr);
+
+/**
+ * \brief Бинаризовать область Grayscale8-данных прямо в упакованные строки (MSB слева).
+ * \details Без копий: gray указывает на левый верхний пиксель области внутри большего
+ *          изображения, dst — на первую строку приёмника с шагом dstStride байт.
+ *          Приёмник перезаписывается на ceil(w/8) байт в каждой строке.
+ */
+void binarizeGray(const uchar* gray, qsizetype bpl, int w, int h, quint8* dst, int dstStride,
+                  const BinarizeOptions& opt, int* usedThreshold = nullptr);
+
+/** \brief Бинаризовать в плоскость ровно размера изображения (любой ширины, без дополнения). */
+BitPlane binarized(const QImage& src, const BinarizeOptions& opt, int* usedThreshold = nullptr);
+
+} // namespace Binarizer
@@ -0,0 +1,154 @@
+// bitpacker.cpp
+#include "bitpacker.h"
+#include "fontdocument.h"
+#include "workstealingpool.h"
+
+#ifdef FONTCREATOR_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace BitPacker {
+
+namespace {
+
+/// \brief Глифов в одной порции параллельной упаковки шрифта.
+constexpr int kFontChunk = 512;
+/// \brief С какого объёма арены шрифт пакуется параллельно.
+constexpr qsizetype kParallelBytes = 256 * 1024;
+
+} // namespace
+
+#ifdef FONTCREATOR_SSE2
+/**
+ * \details Три шага распаковки (8 → 16 → 32 бит) собирают в каждой 64-битной половине
+ *          регистра байты j восьми строк (строка 0 — младший байт), затем в обеих половинах
+ *          сразу делается transpose8 и разворот байтов. Порядок строк на входе задаёт
+ *          порядок бит: при msbTop строки подаются снизу вверх.
+ */
+void packBlocks16(const quint8* rows, qsizetype stride, quint8* dst, qsizetype step, bool msbTop) {
+    __m128i r[8];
+    for (int k = 0; k < 8; ++k)
+        r[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows + (msbTop ? 7 - k : k) * stride));
+
+    __m128i a[8], b[8];
+    for (int k = 0; k < 4; ++k) {
+        a[2 * k]     = _mm_unpacklo_epi8(r[2 * k], r[2 * k + 1]);
+        a[2 * k + 1] = _mm_unpackhi_epi8(r[2 * k], r[2 * k + 1]);
+    }
+    for (int k = 0; k < 2; ++k) {
+        b[4 * k]     = _mm_unpacklo_epi16(a[4 * k],     a[4 * k + 2]);
+        b[4 * k + 1] = _mm_unpackhi_epi16(a[4 * k],     a[4 * k + 2]);
+        b[4 * k + 2] = _mm_unpacklo_epi16(a[4 * k + 1], a[4 * k + 3]);
+        b[4 * k + 3] = _mm_unpackhi_epi16(a[4 * k + 1], a[4 * k + 3]);
+    }
+
+    const __m128i m7  = _mm_set1_epi64x(0x00AA00AA00AA00AAll);
+    const __m128i m14 = _mm_set1_epi64x(0x0000CCCC0000CCCCll);
+    const __m128i m28 = _mm_set1_epi64x(0x00000000F0F0F0F0ll);
+    for (int i = 0; i < 8; ++i) {
+        // Группы 2i и 2i+1: байты строк 0..3 из b[i/2], 4..7 — из b[4 + i/2].
+        __m128i x = (i & 1) ? _mm_unpackhi_epi32(b[i / 2], b[4 + i / 2])
+                            : _mm_unpacklo_epi32(b[i / 2], b[4 + i / 2]);
+        __m128i t;
+        t = _mm_and_si128(_mm_xor_si128(x, _mm_srli_epi64(x, 7)), m7);
+        x = _mm_xor_si128(x, _mm_xor_si128(t, _mm_slli_epi64(t, 7)));
+        t = _mm_and_si128(_mm_xor_si128(x, _mm_srli_epi64(x, 14)), m14);
+        x = _mm_xor_si128(x, _mm_xor_si128(t, _mm_slli_epi64(t, 14)));
+        t = _mm_and_si128(_mm_xor_si128(x, _mm_srli_epi64(x, 28)), m28);
+        x = _mm_xor_si128(x, _mm_xor_si128(t, _mm_slli_epi64(t, 28)));
+        x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(0, 1, 2, 3)), _MM_SHUFFLE(0, 1, 2, 3));
+        x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+
+        if (step == 1) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 16), x);
+        } else {
+            alignas(16) quint8 tmp[16];
+            _mm_store_si128(reinterpret_cast<__m128i*>(tmp), x);
+            for (int k = 0; k < 16; ++k)
+                dst[(i * 16 + k) * step] = tmp[k];
+        }
+    }
+}
+#endif
+
+qsizetype packedSize(const PackFormat& f, int rows, int cols) {
+    return f.layout == PackLayout::RowMajor ? RowMajor::size(rows, cols) : Page::size(rows, cols);
+}
+
+int rowsFor(const PackFormat& f, qsizetype bytes, int cols) {
+    return f.layout == PackLayout::RowMajor ? RowMajor::rowsFor(bytes, cols) : Page::rowsFor(bytes, cols);
+}
+
+void pack(const Rows& src, quint8* dst, const PackFormat& f) {
+    dispatch(f, [&](auto packer) { packer.pack(src, dst); });
+}
+
+QVector<quint8> pack(const BitPlane& bits, const PackFormat& f) {
+    QVector<quint8> out(packedSize(f, bits.rows(), bits.cols()));
+    if (!out.isEmpty())
+        pack(rowsOf(bits), out.data(), f);
+    return out;
+}
+
+void unpack(const quint8* src, const MutableRows& dst, const PackFormat& f) {
+    dispatch(f, [&](auto packer) { packer.unpack(src, dst); });
+}
+
+bool unpack(const QVector<quint8>& src, BitPlane& dst, int rows, int cols, const PackFormat& f) {
+    if (rows <= 0 || cols <= 0 || src.size() < packedSize(f, rows, cols))
+        return false;
+    dst.reset(rows, cols);
+    unpack(src.constData(), MutableRows{ dst.rowBytes(0), dst.strideBytes(), rows, cols }, f);
+    return true;
+}
+
+QByteArray packFont(const FontDocument& doc, const PackFormat& f, QVector<quint32>* offsets) {
+    const int n = doc.glyphCount();
+    QVector<quint32> offs(n);
+    qsizetype total = 0;
+    for (int i = 0; i < n; ++i) {
+        const GlyphEntry& e = doc.entry(i);
+        offs[i] = quint32(total);
+        total += packedSize(f, e.rows, e.cols);
+    }
+
+    QByteArray out(total, Qt::Uninitialized);
+    quint8* base = reinterpret_cast<quint8*>(out.data());
+    dispatch(f, [&](auto packer) {
+        auto glyphs = [&](int i0, int i1) {
+            for (int i = i0; i < i1; ++i) {
+                const GlyphEntry& e = doc.entry(i);
+                packer.pack(Rows{ doc.glyphData(i), e.bytesPerRow(), e.rows, e.cols }, base + offs[i]);
+            }
+        };
+        if (total < kParallelBytes) glyphs(0, n);
+        else WorkStealingPool::global().parallelFor(0, n, kFontChunk, glyphs);
+    });
+
+    if (offsets) *offsets = std::move(offs);
+    return out;
+}
+
+QString name(PackLayout layout) {
+    switch (layout) {
+    case PackLayout::RowMajor:    return "row";
+    case PackLayout::ColumnMajor: return "column";
+    case PackLayout::Page:        return "page";
+    }
+    return {};
+}
+
+PackLayout fromName(const QString& n, bool* ok) {
+    const QString s = n.trimmed().toLower();
+    if (ok) *ok = true;
+    if (s == "column") return PackLayout::ColumnMajor;
+    if (s == "page")   return PackLayout::Page;
+    if (ok) *ok = (s == "row");
+    return PackLayout::RowMajor;
+}
+
+QStringList names() {
+    return { "row", "column", "page" };
+}
+
+} // namespace BitPacker
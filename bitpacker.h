@@ -0,0 +1,371 @@
+// bitpacker.h
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVarLengthArray>
+#include <QVector>
+#include <QtEndian>
+#include <QtGlobal>
+#include <cstring>
+#include "bitplane.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FONTCREATOR_SSE2 1
+#endif
+
+class FontDocument;
+
+/**
+ * \brief Раскладка байтов глифа в выходном массиве.
+ * \details RowMajor    — горизонтальные байты, строка за строкой (ceil(cols/8) байт на строку);
+ *          ColumnMajor — вертикальные байты, столбец за столбцом (ceil(rows/8) байт на столбец);
+ *          Page        — "страницы" по 8 строк, в странице по байту на столбец
+ *                        (SSD1306, ST7565, PCD8544).
+ */
+enum class PackLayout { RowMajor, ColumnMajor, Page };
+
+/**
+ * \brief Раскладка и порядок бит.
+ * \details msbFirst для горизонтальных байтов — старший бит слева, для вертикальных —
+ *          старший бит сверху. SSD1306 ожидает Page с msbFirst = false (бит 0 — верхний пиксель).
+ */
+struct PackFormat {
+    PackLayout layout = PackLayout::RowMajor;
+    bool       msbFirst = true;
+};
+
+/**
+ * \brief Упаковка/распаковка глифов во все раскладки.
+ * \details Раскладка и порядок бит — параметры шаблона Packer<Layout, Order>, поэтому во
+ *          внутренних циклах нет ветвлений по формату: выбор делается один раз в dispatch().
+ *          Вертикальные раскладки собираются блоками 8×8 — восемь байтов строк читаются
+ *          одним 64-битным словом и транспонируются тремя шагами обмена бит.
+ *
+ *          Источник и приёмник — строки MSB-first с произвольным шагом: это и BitPlane,
+ *          и байты глифа в арене FontDocument, так что шрифт пакуется без промежуточных копий.
+ */
+namespace BitPacker {
+
+/// \brief Строки MSB-first только для чтения (BitPlane, глиф в арене).
+struct Rows {
+    const quint8* data = nullptr;
+    qsizetype     stride = 0;
+    int           rows = 0;
+    int           cols = 0;
+};
+
+/**
+ * \brief Строки MSB-first для записи.
+ * \details Распаковка пишет ceil(cols/8) байт каждой строки и обнуляет биты за cols;
+ *          остаток шага строки не трогает.
+ */
+struct MutableRows {
+    quint8*   data = nullptr;
+    qsizetype stride = 0;
+    int       rows = 0;
+    int       cols = 0;
+};
+
+#ifdef FONTCREATOR_SSE2
+/**
+ * \brief SSE2-ядро вертикальных раскладок: 16 блоков 8×8 (128 столбцов) одной страницы.
+ * \details rows — 8 строк по 16 байт с шагом stride; вертикальный байт столбца c пишется
+ *          в dst[c * step]. msbTop — верхняя строка в старшем бите.
+ */
+void packBlocks16(const quint8* rows, qsizetype stride, quint8* dst, qsizetype step, bool msbTop);
+#endif
+
+inline Rows rowsOf(const BitPlane& bits) {
+    return { bits.rowBytes(0), bits.strideBytes(), bits.rows(), bits.cols() };
+}
+
+/**
+ * \brief Транспонировать матрицу 8×8 бит.
+ * \details Байт k (считая от старшего) — строка k, бит 7 — столбец 0. После транспонирования
+ *          байт k — столбец k, бит 7 — строка 0. Операция обратна сама себе.
+ */
+inline quint64 transpose8(quint64 x) {
+    quint64 t;
+    t = (x ^ (x >> 7))  & 0x00AA00AA00AA00AAull; x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCull; x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ull; x ^= t ^ (t << 28);
+    return x;
+}
+
+/**
+ * \name Порядок бит
+ * \details map — перевод байта из внутреннего MSB-first и обратно (операция обратна сама себе),
+ *          map64 — то же для восьми байтов слова сразу. MSB-first совпадает с внутренним
+ *          порядком, поэтому для него строки копируются memcpy.
+ */
+/// @{
+struct MsbFirst {
+    static constexpr bool kMsbFirst = true;
+    static quint8  map(quint8 b, const quint8*) { return b; }
+    static quint64 map64(quint64 x) { return x; }
+};
+struct LsbFirst {
+    static constexpr bool kMsbFirst = false;
+    static quint8  map(quint8 b, const quint8* rev) { return rev[b]; }
+    static quint64 map64(quint64 x) {
+        x = ((x >> 1) & 0x5555555555555555ull) | ((x & 0x5555555555555555ull) << 1);
+        x = ((x >> 2) & 0x3333333333333333ull) | ((x & 0x3333333333333333ull) << 2);
+        return ((x >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((x & 0x0F0F0F0F0F0F0F0Full) << 4);
+    }
+};
+/// @}
+
+/// \brief Горизонтальные байты по строкам.
+struct RowMajor {
+    /// \brief Строка из n байт: MSB-first — memcpy, LSB-first — по 8 байт через map64.
+    template <class Order>
+    static void copyRow(const quint8* src, quint8* dst, int n, const quint8* rev) {
+        if constexpr (Order::kMsbFirst) {
+            std::memcpy(dst, src, size_t(n));
+        } else {
+            int i = 0;
+            for (; i + 8 <= n; i += 8) {
+                quint64 x;
+                std::memcpy(&x, src + i, 8);
+                x = Order::map64(x);
+                std::memcpy(dst + i, &x, 8);
+            }
+            for (; i < n; ++i)
+                dst[i] = Order::map(src[i], rev);
+        }
+    }
+
+    static qsizetype size(int rows, int cols) { return qsizetype(rows) * ((cols + 7) / 8); }
+    static int rowsFor(qsizetype bytes, int cols) {
+        const int bpr = (cols + 7) / 8;
+        return bpr > 0 && bytes % bpr == 0 ? int(bytes / bpr) : -1;
+    }
+
+    template <class Order>
+    static void pack(const Rows& s, quint8* dst, const quint8* rev) {
+        const int bpr = (s.cols + 7) / 8;
+        if constexpr (Order::kMsbFirst) {
+            if (s.stride == bpr) {
+                std::memcpy(dst, s.data, size_t(size(s.rows, s.cols)));
+                return;
+            }
+        }
+        for (int r = 0; r < s.rows; ++r, dst += bpr) {
+            const quint8* src = s.data + qsizetype(r) * s.stride;
+            copyRow<Order>(src, dst, bpr, rev);
+        }
+    }
+
+    template <class Order>
+    static void unpack(const quint8* src, const MutableRows& d, const quint8* rev) {
+        const int bpr = (d.cols + 7) / 8;
+        const quint8 tail = d.cols % 8 ? quint8(0xFF << (8 - d.cols % 8)) : quint8(0xFF);
+        for (int r = 0; r < d.rows; ++r, src += bpr) {
+            quint8* dst = d.data + qsizetype(r) * d.stride;
+            copyRow<Order>(src, dst, bpr, rev);
+            if (bpr) dst[bpr - 1] &= tail;
+        }
+    }
+};
+
+/**
+ * \brief Вертикальные байты: общее ядро ColumnMajor и Page.
+ * \details Index::at(page, col, pages, cols) — где лежит вертикальный байт столбца col
+ *          в странице page (строки 8·page … 8·page+7). Неполная последняя страница
+ *          дополняется нулевыми строками во временном буфере, чтобы ядро всегда
+ *          работало с полными блоками 8×8.
+ */
+template <class Index>
+struct Vertical {
+    static qsizetype size(int rows, int cols) { return qsizetype(cols) * ((rows + 7) / 8); }
+    static int rowsFor(qsizetype bytes, int cols) {
+        return cols > 0 && bytes % cols == 0 ? int(bytes / cols) * 8 : -1;
+    }
+
+    template <class Order>
+    static void pack(const Rows& s, quint8* dst, const quint8*) {
+        const int pages = (s.rows + 7) / 8, full = s.rows / 8, bpr = (s.cols + 7) / 8;
+        for (int p = 0; p < full; ++p)
+            packPage<Order>(s.data + qsizetype(p) * 8 * s.stride, s.stride, s.cols, dst, p, pages);
+        if (full < pages) {
+            QVarLengthArray<quint8, 8 * 64> pad(8 * bpr);
+            std::memset(pad.data(), 0, size_t(pad.size()));
+            for (int k = 0; k < s.rows - full * 8; ++k)
+                std::memcpy(pad.data() + k * bpr, s.data + qsizetype(full * 8 + k) * s.stride, size_t(bpr));
+            packPage<Order>(pad.data(), bpr, s.cols, dst, full, pages);
+        }
+    }
+
+    template <class Order>
+    static void unpack(const quint8* src, const MutableRows& d, const quint8*) {
+        const int pages = (d.rows + 7) / 8, full = d.rows / 8, bpr = (d.cols + 7) / 8;
+        for (int p = 0; p < full; ++p)
+            unpackPage<Order>(src, d.data + qsizetype(p) * 8 * d.stride, d.stride, d.cols, p, pages);
+        if (full < pages) {
+            QVarLengthArray<quint8, 8 * 64> pad(8 * bpr);
+            unpackPage<Order>(src, pad.data(), bpr, d.cols, full, pages);
+            for (int k = 0; k < d.rows - full * 8; ++k)
+                std::memcpy(d.data + qsizetype(full * 8 + k) * d.stride, pad.data() + k * bpr, size_t(bpr));
+        }
+    }
+
+private:
+    /// \brief Байт j восьми строк одним словом (строка 0 — старший байт).
+    static quint64 gather(const quint8* rows, qsizetype stride, int j) {
+        quint64 x = 0;
+        for (int k = 0; k < 8; ++k)
+            x = (x << 8) | rows[k * stride + j];
+        return x;
+    }
+
+    static void scatter(quint8* rows, qsizetype stride, int j, quint64 x) {
+        for (int k = 0; k < 8; ++k)
+            rows[k * stride + j] = quint8(x >> (56 - 8 * k));
+    }
+
+    template <class Order>
+    static void packPage(const quint8* rows, qsizetype stride, int cols, quint8* dst,
+                         int p, int pages) {
+        const int groups = cols / 8, tail = cols % 8;
+        int j = 0;
+#ifdef FONTCREATOR_SSE2
+        for (; j + 16 <= groups; j += 16)
+            packBlocks16(rows + j, stride, dst + Index::at(p, j * 8, pages, cols), Index::step(pages),
+                         Order::kMsbFirst);
+#endif
+        for (; j < groups; ++j)
+            Index::store8(dst, p, j * 8, pages, cols, Order::map64(transpose8(gather(rows, stride, j))));
+        if (tail) {
+            const quint64 t = Order::map64(transpose8(gather(rows, stride, groups)));
+            for (int k = 0; k < tail; ++k)
+                dst[Index::at(p, groups * 8 + k, pages, cols)] = quint8(t >> (56 - 8 * k));
+        }
+    }
+
+    template <class Order>
+    static void unpackPage(const quint8* src, quint8* rows, qsizetype stride, int cols,
+                           int p, int pages) {
+        const int groups = cols / 8, tail = cols % 8;
+        for (int j = 0; j < groups; ++j)
+            scatter(rows, stride, j, transpose8(Order::map64(Index::load8(src, p, j * 8, pages, cols))));
+        if (tail) {
+            // Недостающие столбцы — нулевые байты, поэтому биты за cols остаются 0.
+            quint64 x = 0;
+            for (int k = 0; k < tail; ++k)
+                x |= quint64(src[Index::at(p, groups * 8 + k, pages, cols)]) << (56 - 8 * k);
+            scatter(rows, stride, groups, transpose8(Order::map64(x)));
+        }
+    }
+};
+
+/**
+ * \name Адресация вертикальных байтов
+ * \details store8/load8 — восемь соседних столбцов c…c+7 одной страницы; байт k слова
+ *          (считая от старшего) — столбец c+k. step — расстояние между байтами соседних столбцов.
+ */
+/// @{
+struct ColumnIndex {
+    static qsizetype at(int page, int col, int pages, int) { return qsizetype(col) * pages + page; }
+    static qsizetype step(int pages) { return pages; }
+    static void store8(quint8* dst, int page, int col, int pages, int, quint64 x) {
+        quint8* d = dst + qsizetype(col) * pages + page;
+        for (int k = 0; k < 8; ++k)
+            d[k * pages] = quint8(x >> (56 - 8 * k));
+    }
+    static quint64 load8(const quint8* src, int page, int col, int pages, int) {
+        const quint8* s = src + qsizetype(col) * pages + page;
+        quint64 x = 0;
+        for (int k = 0; k < 8; ++k)
+            x = (x << 8) | s[k * pages];
+        return x;
+    }
+};
+struct PageIndex {
+    static qsizetype at(int page, int col, int, int cols) { return qsizetype(page) * cols + col; }
+    static qsizetype step(int) { return 1; }
+    static void store8(quint8* dst, int page, int col, int, int cols, quint64 x) {
+        qToBigEndian(x, dst + qsizetype(page) * cols + col);
+    }
+    static quint64 load8(const quint8* src, int page, int col, int, int cols) {
+        return qFromBigEndian<quint64>(src + qsizetype(page) * cols + col);
+    }
+};
+/// @}
+
+using ColumnMajor = Vertical<ColumnIndex>;
+using Page        = Vertical<PageIndex>;
+
+/**
+ * \brief Упаковщик с раскладкой и порядком бит, заданными при компиляции.
+ */
+template <class Layout, class Order>
+struct Packer {
+    static qsizetype size(int rows, int cols) { return Layout::size(rows, cols); }
+    static void pack(const Rows& src, quint8* dst) {
+        Layout::template pack<Order>(src, dst, BitPlane::bitReverseTable());
+    }
+    static void unpack(const quint8* src, const MutableRows& dst) {
+        Layout::template unpack<Order>(src, dst, BitPlane::bitReverseTable());
+    }
+};
+
+/**
+ * \brief Вызвать fn(Packer<…>{}) со специализацией под формат.
+ * \details Единственное место, где формат проверяется во время выполнения; fn — обобщённая
+ *          лямбда, внутри которой весь цикл (по строкам, глифам) уже без ветвлений.
+ */
+template <class Fn>
+void dispatch(const PackFormat& f, Fn&& fn) {
+    switch (f.layout) {
+    case PackLayout::RowMajor:
+        if (f.msbFirst) fn(Packer<RowMajor, MsbFirst>{}); else fn(Packer<RowMajor, LsbFirst>{});
+        break;
+    case PackLayout::ColumnMajor:
+        if (f.msbFirst) fn(Packer<ColumnMajor, MsbFirst>{}); else fn(Packer<ColumnMajor, LsbFirst>{});
+        break;
+    case PackLayout::Page:
+        if (f.msbFirst) fn(Packer<Page, MsbFirst>{}); else fn(Packer<Page, LsbFirst>{});
+        break;
+    }
+}
+
+/** \brief Размер упакованного глифа rows × cols в байтах. */
+qsizetype packedSize(const PackFormat& f, int rows, int cols);
+
+/**
+ * \brief Сколько строк даёт bytes байт при ширине cols.
+ * \return -1, если bytes не делится на размер строки (RowMajor) или на cols (вертикальные);
+ *         для вертикальных раскладок число строк кратно 8.
+ */
+int rowsFor(const PackFormat& f, qsizetype bytes, int cols);
+
+/** \brief Упаковать строки в dst (packedSize() байт). */
+void pack(const Rows& src, quint8* dst, const PackFormat& f);
+/** \brief Упаковать плоскость. */
+QVector<quint8> pack(const BitPlane& bits, const PackFormat& f);
+
+/** \brief Распаковать packedSize() байт из src в строки dst. */
+void unpack(const quint8* src, const MutableRows& dst, const PackFormat& f);
+/**
+ * \brief Распаковать в плоскость rows × cols (размер dst задаётся заново).
+ * \return false, если src короче packedSize().
+ */
+bool unpack(const QVector<quint8>& src, BitPlane& dst, int rows, int cols, const PackFormat& f);
+
+/**
+ * \brief Упаковать все глифы шрифта подряд в один буфер.
+ * \details Глифы берутся прямо из арены документа; крупные шрифты пакуются параллельно
+ *          (WorkStealingPool::global()), каждый поток пишет в свой участок буфера.
+ * \param offsets Смещение каждого глифа в результате (может быть nullptr).
+ */
+QByteArray packFont(const FontDocument& doc, const PackFormat& f, QVector<quint32>* offsets = nullptr);
+
+/// \name Имена раскладок (CLI, подписи в UI)
+/// @{
+QString name(PackLayout layout);        ///< "row", "column", "page"
+PackLayout fromName(const QString& name, bool* ok = nullptr);
+QStringList names();
+/// @}
+
+} // namespace BitPacker
@@ -0,0 +1,168 @@
+// bitplane.cpp
+#include "bitplane.h"
+#include <QtEndian>
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+
+/// \brief Построить таблицу разворота битов байта на этапе компиляции.
+constexpr std::array<quint8, 256> makeBitReverseTable() {
+    std::array<quint8, 256> t{};
+    for (int i = 0; i < 256; ++i) {
+        int v = 0;
+        for (int b = 0; b < 8; ++b)
+            if (i & (1 << b)) v |= 0x80 >> b;
+        t[size_t(i)] = quint8(v);
+    }
+    return t;
+}
+
+constexpr std::array<quint8, 256> kBitReverse = makeBitReverseTable();
+
+inline quint64 load(const quint64* p)        { return qFromBigEndian(*p); }
+inline void    store(quint64* p, quint64 v)  { *p = qToBigEndian(v); }
+
+} // namespace
+
+const quint8* BitPlane::bitReverseTable() {
+    return kBitReverse.data();
+}
+
+BitPlane::BitPlane(int rows, int cols) {
+    reset(rows, cols);
+}
+
+/** \brief Переразметить и обнулить. */
+void BitPlane::reset(int rows, int cols) {
+    m_rows = std::max(0, rows);
+    m_cols = std::max(0, cols);
+    m_wpr  = (m_cols + 63) / 64;
+    m_words.resize(qsizetype(m_rows) * m_wpr);
+    std::fill(m_words.begin(), m_words.end(), quint64(0));
+}
+
+quint64 BitPlane::tailMask() const {
+    const int valid = m_cols - (m_wpr - 1) * 64; // 1..64
+    return qToBigEndian(~quint64(0) << (64 - valid));
+}
+
+void BitPlane::clearTails() {
+    if (m_wpr == 0) return;
+    const quint64 mask = tailMask();
+    quint64* p = m_words.data() + (m_wpr - 1);
+    for (int r = 0; r < m_rows; ++r, p += m_wpr)
+        *p &= mask;
+}
+
+/** \brief Заполнить всю плоскость нулями или единицами. */
+void BitPlane::fill(bool on) {
+    std::fill(m_words.begin(), m_words.end(), on ? ~quint64(0) : quint64(0));
+    if (on) clearTails();
+}
+
+/** \brief Инверсия: XOR по словам, хвост строки остаётся нулевым. */
+void BitPlane::invert() {
+    if (m_wpr == 0) return;
+    const quint64 mask = tailMask();
+    quint64* p = m_words.data();
+    for (int r = 0; r < m_rows; ++r) {
+        for (int w = 0; w < m_wpr - 1; ++w)
+            *p++ ^= ~quint64(0);
+        *p++ ^= mask;
+    }
+}
+
+/** \brief Сдвиг влево на 1 пиксель: слова сдвигаются влево с переносом из следующего слова. */
+void BitPlane::shiftLeft() {
+    for (int r = 0; r < m_rows; ++r) {
+        quint64* row = rowWords(r);
+        quint64 cur = m_wpr ? load(row) : 0;
+        for (int w = 0; w < m_wpr - 1; ++w) {
+            const quint64 next = load(row + w + 1);
+            store(row + w, (cur << 1) | (next >> 63));
+            cur = next;
+        }
+        if (m_wpr) store(row + m_wpr - 1, cur << 1); // хвост уже нулевой
+    }
+}
+
+/** \brief Сдвиг вправо на 1 пиксель: слова сдвигаются вправо с переносом из предыдущего слова. */
+void BitPlane::shiftRight() {
+    for (int r = 0; r < m_rows; ++r) {
+        quint64* row = rowWords(r);
+        quint64 carry = 0;
+        for (int w = 0; w < m_wpr; ++w) {
+            const quint64 v = load(row + w);
+            store(row + w, (v >> 1) | carry);
+            carry = v << 63;
+        }
+    }
+    clearTails(); // крайний правый пиксель мог уехать в хвост
+}
+
+/** \brief Сдвиг вверх: memmove строк. */
+void BitPlane::shiftUp() {
+    if (m_rows == 0) return;
+    const size_t stride = size_t(m_wpr) * sizeof(quint64);
+    std::memmove(rowWords(0), rowWords(0) + m_wpr, stride * size_t(m_rows - 1));
+    std::memset(rowWords(m_rows - 1), 0, stride);
+}
+
+/** \brief Сдвиг вниз: memmove строк. */
+void BitPlane::shiftDown() {
+    if (m_rows == 0) return;
+    const size_t stride = size_t(m_wpr) * sizeof(quint64);
+    std::memmove(rowWords(0) + m_wpr, rowWords(0), stride * size_t(m_rows - 1));
+    std::memset(rowWords(0), 0, stride);
+}
+
+/** \brief Копия нового размера с сохранением общей области. */
+BitPlane BitPlane::resized(int rows, int cols) const {
+    BitPlane out(rows, cols);
+    const int copyRows  = std::min(m_rows, out.m_rows);
+    const int copyWords = std::min(m_wpr, out.m_wpr);
+    for (int r = 0; r < copyRows; ++r)
+        std::memcpy(out.rowWords(r), rowWords(r), size_t(copyWords) * sizeof(quint64));
+    if (out.m_cols < m_cols)
+        out.clearTails();
+    return out;
+}
+
+/** \brief Импорт горизонтальных байтов: MSB-first — memcpy строки, LSB-first — через таблицу. */
+void BitPlane::importRows(const quint8* src, int bytesPerRow, bool msbFirst) {
+    const int stride = strideBytes();
+    const int n = std::min(bytesPerRow, stride);
+    for (int r = 0; r < m_rows; ++r, src += bytesPerRow) {
+        uchar* dst = rowBytes(r);
+        if (msbFirst) {
+            std::memcpy(dst, src, size_t(n));
+        } else {
+            for (int i = 0; i < n; ++i)
+                dst[i] = kBitReverse[src[i]];
+        }
+        std::memset(dst + n, 0, size_t(stride - n));
+    }
+    clearTails();
+}
+
+/** \brief Экспорт горизонтальных байтов (обратная операция к importRows). */
+void BitPlane::exportRows(quint8* dst, int bytesPerRow, bool msbFirst) const {
+    const int n = std::min(bytesPerRow, strideBytes());
+    for (int r = 0; r < m_rows; ++r, dst += bytesPerRow) {
+        const uchar* src = rowBytes(r);
+        if (msbFirst) {
+            std::memcpy(dst, src, size_t(n));
+        } else {
+            for (int i = 0; i < n; ++i)
+                dst[i] = kBitReverse[src[i]];
+        }
+        if (bytesPerRow > n)
+            std::memset(dst + n, 0, size_t(bytesPerRow - n));
+    }
+}
+
+bool BitPlane::operator==(const BitPlane& o) const {
+    return m_rows == o.m_rows && m_cols == o.m_cols && m_words == o.m_words;
+}
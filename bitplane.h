@@ -0,0 +1,104 @@
+// bitplane.h
+#pragma once
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * \brief Упакованная битовая плоскость глифа (1 бит на пиксель).
+ * \details Каждая строка выровнена на 64-битные слова. Слова лежат в памяти
+ *          в порядке big-endian, поэтому байтовое представление строки совпадает
+ *          с горизонтальными байтами "MSB слева": столбец c — это бит (7 - c%8)
+ *          байта c/8. Биты за пределами cols() в последнем слове строки всегда 0.
+ *
+ *          Благодаря такой раскладке:
+ *          - инверсия — XOR по словам;
+ *          - горизонтальный сдвиг — сдвиг слов с переносом;
+ *          - вертикальный сдвиг — memmove строк;
+ *          - импорт/экспорт MSB-first строк — memcpy.
+ */
+class BitPlane {
+public:
+    BitPlane() = default;
+    /** \brief Создать пустую (обнулённую) плоскость rows × cols. */
+    BitPlane(int rows, int cols);
+
+    /** \brief Переразметить плоскость под rows × cols и обнулить. */
+    void reset(int rows, int cols);
+
+    /// \name Геометрия
+    /// @{
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+    /// \brief Число 64-битных слов на строку.
+    int wordsPerRow() const { return m_wpr; }
+    /// \brief Шаг строки в байтах (кратен 8).
+    int strideBytes() const { return m_wpr * 8; }
+    bool isEmpty() const { return m_rows == 0 || m_cols == 0; }
+    /// @}
+
+    /// \name Доступ к пикселям
+    /// @{
+    bool pixel(int r, int c) const {
+        return (rowBytes(r)[c >> 3] & (0x80u >> (c & 7))) != 0;
+    }
+    void setPixel(int r, int c, bool on) {
+        uchar& b = rowBytes(r)[c >> 3];
+        const uchar m = uchar(0x80u >> (c & 7));
+        b = on ? uchar(b | m) : uchar(b & ~m);
+    }
+    /// @}
+
+    /// \name Сырой доступ к строкам (слова в порядке big-endian)
+    /// @{
+    const quint64* rowWords(int r) const { return m_words.constData() + qsizetype(r) * m_wpr; }
+    quint64*       rowWords(int r)       { return m_words.data() + qsizetype(r) * m_wpr; }
+    const uchar*   rowBytes(int r) const { return reinterpret_cast<const uchar*>(rowWords(r)); }
+    uchar*         rowBytes(int r)       { return reinterpret_cast<uchar*>(rowWords(r)); }
+    /** \brief Общий (implicitly shared) буфер всех строк — чтобы продлить ему жизнь без копии. */
+    const QVector<quint64>& words() const { return m_words; }
+    /// @}
+
+    /// \name Операции над всей плоскостью
+    /// @{
+    void fill(bool on);
+    void invert();
+    void shiftLeft();
+    void shiftRight();
+    void shiftUp();
+    void shiftDown();
+
+    /**
+     * \brief Копия с новым размером; общая область сохраняется, новые зоны — 0.
+     */
+    BitPlane resized(int rows, int cols) const;
+    /// @}
+
+    /// \name Импорт/экспорт горизонтальных байтов
+    /// @{
+    /**
+     * \brief Загрузить rows() строк по bytesPerRow байт из src.
+     * \param msbFirst true — старший бит байта соответствует левому пикселю.
+     * \details Лишние биты справа от cols() отбрасываются, недостающие — 0.
+     */
+    void importRows(const quint8* src, int bytesPerRow, bool msbFirst);
+    /** \brief Выгрузить rows() строк по bytesPerRow байт в dst. */
+    void exportRows(quint8* dst, int bytesPerRow, bool msbFirst) const;
+    /// @}
+
+    /** \brief Таблица разворота битов в байте (LSB-first ↔ MSB-first). */
+    static const quint8* bitReverseTable();
+
+    bool operator==(const BitPlane& o) const;
+    bool operator!=(const BitPlane& o) const { return !(*this == o); }
+
+private:
+    /// \brief Маска значимых битов последнего слова строки (в порядке big-endian).
+    quint64 tailMask() const;
+    /// \brief Обнулить биты за пределами cols() во всех строках.
+    void clearTails();
+
+    int m_rows = 0;
+    int m_cols = 0;
+    int m_wpr  = 0;
+    QVector<quint64> m_words;
+};
@@ -0,0 +1,143 @@
+// bitstream.cpp
+#include "bitstream.h"
+#include "fontdocument.h"
+#include <QtEndian>
+#include <algorithm>
+
+namespace BitStream {
+
+namespace {
+
+/// \brief 8 байт big-endian; за концом (avail < 8) — нули.
+inline quint64 load64(const quint8* p, qsizetype avail) {
+    if (avail >= 8)
+        return qFromBigEndian<quint64>(p);
+    quint64 v = 0;
+    for (qsizetype k = 0; k < 8; ++k)
+        v = (v << 8) | (k < avail ? p[k] : 0u);
+    return v;
+}
+
+/// \brief 64 бита потока с бита pos (за концом потока — нули).
+inline quint64 read64(const quint8* s, qsizetype size, quint64 pos) {
+    const qsizetype byte = qsizetype(pos >> 3);
+    const int shift = int(pos & 7);
+    const quint64 hi = load64(s + byte, size - byte);
+    if (!shift) return hi;
+    const quint64 lo = byte + 8 < size ? s[byte + 8] : 0u;
+    return (hi << shift) | (lo >> (8 - shift));
+}
+
+/// \brief Маска n старших бит (1 ≤ n ≤ 64).
+inline quint64 topBits(int n) {
+    return n >= 64 ? ~quint64(0) : ~(~quint64(0) >> n);
+}
+
+} // namespace
+
+Writer::Writer(quint64 reserveBits) {
+    reserveWords(qsizetype((reserveBits + 63) / 64));
+}
+
+void Writer::reserveWords(qsizetype words) {
+    if (words * 8 > m_out.size())
+        m_out.resize(std::max<qsizetype>(words * 8, m_out.size() * 2));
+}
+
+void Writer::put(quint64 v, int n) {
+    m_bits += quint64(n);
+    m_acc |= v >> m_accBits;
+    const int room = 64 - m_accBits;
+    if (n < room) {
+        m_accBits += n;
+        return;
+    }
+    reserveWords(m_words + 1);
+    qToBigEndian(m_acc, m_out.data() + m_words * 8);
+    ++m_words;
+    m_acc = n > room ? v << room : 0;
+    m_accBits = n - room;
+}
+
+void Writer::appendBits(const quint8* row, int n) {
+    const qsizetype bytes = (n + 7) / 8;
+    for (qsizetype i = 0; n > 0; i += 8, n -= 64) {
+        const int k = std::min(64, n);
+        put(load64(row + i, bytes - i) & topBits(k), k);
+    }
+}
+
+void Writer::append(const BitPacker::Rows& src) {
+    if (src.cols <= 0) return;
+    for (int r = 0; r < src.rows; ++r)
+        appendBits(src.data + qsizetype(r) * src.stride, src.cols);
+}
+
+QByteArray Writer::finish() {
+    if (m_accBits) {
+        reserveWords(m_words + 1);
+        qToBigEndian(m_acc, m_out.data() + m_words * 8);
+    }
+    m_out.truncate(byteSize(m_bits));
+    QByteArray out;
+    out.swap(m_out);
+    m_words = 0;
+    m_acc = 0;
+    m_accBits = 0;
+    m_bits = 0;
+    return out;
+}
+
+bool unpack(const quint8* stream, qsizetype size, quint64 offset, const BitPacker::MutableRows& dst) {
+    if (dst.rows <= 0 || dst.cols <= 0) return true;
+    if (offset + bitSize(dst.rows, dst.cols) > quint64(size) * 8) return false;
+    const int bpr = (dst.cols + 7) / 8;
+    for (int r = 0; r < dst.rows; ++r) {
+        quint8* out = dst.data + qsizetype(r) * dst.stride;
+        const quint64 pos = offset + quint64(r) * quint64(dst.cols);
+        for (int j = 0; j * 64 < dst.cols; ++j) {
+            const int k = std::min(64, dst.cols - j * 64);
+            const quint64 v = read64(stream, size, pos + quint64(j) * 64) & topBits(k);
+            const int bytes = std::min(8, bpr - j * 8);
+            if (bytes == 8) {
+                qToBigEndian(v, out + j * 8);
+            } else {
+                for (int b = 0; b < bytes; ++b)
+                    out[j * 8 + b] = quint8(v >> (56 - 8 * b));
+            }
+        }
+    }
+    return true;
+}
+
+QByteArray pack(const BitPlane& bits) {
+    Writer w(bitSize(bits.rows(), bits.cols()));
+    if (!bits.isEmpty())
+        w.append(BitPacker::rowsOf(bits));
+    return w.finish();
+}
+
+bool unpack(const QByteArray& stream, BitPlane& dst, int rows, int cols) {
+    dst.reset(rows, cols);
+    if (dst.isEmpty()) return true;
+    return unpack(reinterpret_cast<const quint8*>(stream.constData()), stream.size(), 0,
+                  { dst.rowBytes(0), dst.strideBytes(), dst.rows(), dst.cols() });
+}
+
+QByteArray packFont(const FontDocument& doc, QVector<quint32>* bitOffsets) {
+    quint64 total = 0;
+    for (const GlyphEntry& e : doc.entries())
+        total += bitSize(e.rows, e.cols);
+
+    const int n = doc.glyphCount();
+    if (bitOffsets) bitOffsets->resize(n);
+    Writer w(total);
+    for (int i = 0; i < n; ++i) {
+        const GlyphEntry& e = doc.entry(i);
+        if (bitOffsets) (*bitOffsets)[i] = quint32(w.bitCount());
+        w.append({ doc.glyphData(i), e.bytesPerRow(), e.rows, e.cols });
+    }
+    return w.finish();
+}
+
+} // namespace BitStream
@@ -0,0 +1,80 @@
+// bitstream.h
+#pragma once
+#include <QByteArray>
+#include <QVector>
+#include <QtGlobal>
+#include "bitpacker.h"
+
+class FontDocument;
+
+/**
+ * \brief Плотная упаковка глифов в непрерывный поток бит без выравнивания.
+ * \details Строки идут подряд по cols бит, глифы — подряд друг за другом: ни строка, ни глиф
+ *          не дополняются до байта. Пиксель (x, y) глифа со смещением off лежит в бите
+ *          n = off + y · cols + x потока, бит n — (n % 8)-й от старшего в байте n / 8.
+ *          Такой поток читает C-функция gd_bitstream_pixel() (decoders/gd_bitstream.c) за O(1).
+ *
+ *          Ядра работают 64-битными словами: строка источника читается big-endian словами,
+ *          сдвигается в накопитель и выгружается в поток целыми словами; распаковка берёт
+ *          64 бита потока с любого смещения одним невыровненным чтением.
+ */
+namespace BitStream {
+
+/** \brief Бит в потоке на глиф rows × cols. */
+inline quint64 bitSize(int rows, int cols) { return quint64(qMax(0, rows)) * quint64(qMax(0, cols)); }
+
+/** \brief Байт на поток из bits бит. */
+inline qsizetype byteSize(quint64 bits) { return qsizetype((bits + 7) / 8); }
+
+/**
+ * \brief Последовательная запись строк в поток (накопитель на 64 бита).
+ * \details Буфер растёт по мере записи; finish() отрезает его до byteSize(bitCount()).
+ */
+class Writer {
+public:
+    /** \param reserveBits Ожидаемый объём, бит (чтобы не перераспределять буфер). */
+    explicit Writer(quint64 reserveBits = 0);
+
+    /** \brief Дописать строки src (MSB-first) по src.cols бит. */
+    void append(const BitPacker::Rows& src);
+    /** \brief Дописать n бит строки MSB-first (остальные биты последнего байта игнорируются). */
+    void appendBits(const quint8* row, int n);
+
+    /** \brief Сколько бит записано. */
+    quint64 bitCount() const { return m_bits; }
+
+    /** \brief Выгрузить накопитель и вернуть поток. */
+    QByteArray finish();
+
+private:
+    /// \brief n старших бит v (остальные — нули) в накопитель.
+    void put(quint64 v, int n);
+    void reserveWords(qsizetype words);
+
+    QByteArray m_out;
+    qsizetype  m_words = 0;   ///< выгружено целых слов
+    quint64    m_acc = 0;     ///< неполное слово, выровнено к старшему биту
+    int        m_accBits = 0;
+    quint64    m_bits = 0;
+};
+
+/**
+ * \brief Распаковать rows × cols бит потока с бита offset в строки dst.
+ * \param size Размер потока, байт (чтение не выходит за него).
+ * \return false, если глиф не помещается в поток.
+ */
+bool unpack(const quint8* stream, qsizetype size, quint64 offset, const BitPacker::MutableRows& dst);
+
+/** \brief Плоскость одним потоком (rows · cols бит). */
+QByteArray pack(const BitPlane& bits);
+
+/** \brief Плоскость rows × cols из потока (размер dst задаётся заново). */
+bool unpack(const QByteArray& stream, BitPlane& dst, int rows, int cols);
+
+/**
+ * \brief Все глифы шрифта подряд одним потоком.
+ * \param bitOffsets Смещение каждого глифа в потоке, бит (может быть nullptr).
+ */
+QByteArray packFont(const FontDocument& doc, QVector<quint32>* bitOffsets = nullptr);
+
+} // namespace BitStream
@@ -0,0 +1,147 @@
+// bytelexer.cpp
+#include "bytelexer.h"
+
+namespace {
+
+/// \brief Классы ASCII-символов: признак слова, цифры и значение гекс-цифры.
+enum : quint8 { CWord = 0x10, CDigit = 0x20, CHex = 0x40, CValue = 0x0F };
+
+struct CharTable {
+    quint8 cls[128] = {};
+    constexpr CharTable() {
+        for (int c = 'a'; c <= 'z'; ++c) cls[c] = CWord;
+        for (int c = 'A'; c <= 'Z'; ++c) cls[c] = CWord;
+        cls[int('_')] = CWord;
+        for (int c = '0'; c <= '9'; ++c) cls[c] = quint8(CWord | CDigit | CHex | (c - '0'));
+        for (int c = 'a'; c <= 'f'; ++c) cls[c] = quint8(CWord | CHex | (c - 'a' + 10));
+        for (int c = 'A'; c <= 'F'; ++c) cls[c] = quint8(CWord | CHex | (c - 'A' + 10));
+    }
+};
+constexpr CharTable kTable;
+
+inline quint32 unit(QChar c) { return c.unicode(); }
+inline quint32 unit(char c)  { return quint8(c); }
+
+} // namespace
+
+void ByteLexer::feed(const QChar* data, qsizetype n) { run(data, data + n); }
+void ByteLexer::feed(const char* utf8, qsizetype n)  { run(utf8, utf8 + n); }
+
+void ByteLexer::reset() {
+    *this = ByteLexer();
+}
+
+/** \brief Разделитель в конце входа закрывает последнее слово. */
+void ByteLexer::finish() {
+    const char sep = ' ';
+    if (m_mode == Slash) m_mode = Text;
+    if (m_mode == Text) run(&sep, &sep + 1);
+}
+
+template <typename Ch>
+void ByteLexer::run(const Ch* p, const Ch* end) {
+    while (p < end) {
+        switch (m_mode) {
+        case LineComment:
+            while (p < end && unit(*p) != '\n' && unit(*p) != '\r') ++p;
+            if (p < end) m_mode = Text;
+            continue;
+        case BlockComment:
+            while (p < end && unit(*p) != '*') ++p;
+            if (p < end) { m_mode = BlockStar; ++p; }
+            continue;
+        case BlockStar: {
+            const quint32 c = unit(*p++);
+            m_mode = c == '/' ? Text : (c == '*' ? BlockStar : BlockComment);
+            continue;
+        }
+        case Slash: {
+            const quint32 c = unit(*p);
+            m_mode = Text;
+            if (c == '/') { m_mode = LineComment; ++p; continue; }
+            if (c == '*') { m_mode = BlockComment; ++p; continue; }
+            break; // одиночный '/' — просто разделитель, символ разбирается ниже
+        }
+        case Text:
+            break;
+        }
+
+        // Text: основной цикл по символам.
+        while (p < end) {
+            const quint32 c = unit(*p);
+            const quint8 cls = c < 128 ? kTable.cls[c] : 0;
+
+            if (cls & CWord) {
+                ++p;
+                if (!m_inWord) {
+                    m_inWord = true;
+                    m_allDigits = true;
+                    m_wordLen = 0;
+                    m_decVal = 0;
+                    m_hex = HexNone;
+                }
+                if (m_allDigits) {
+                    if (cls & CDigit) {
+                        if (++m_wordLen <= 3) m_decVal = m_decVal * 10 + (cls & CValue);
+                    } else {
+                        m_allDigits = false;
+                    }
+                }
+                switch (m_hex) {
+                case HexDigit:
+                    if (cls & CHex) {
+                        m_out.append(quint8((m_hexVal << 4) | (cls & CValue)));
+                        m_hex = HexNone;
+                        continue;
+                    }
+                    m_out.append(m_hexVal);
+                    m_hex = HexNone; // не гекс-цифра — точно не '0'
+                    continue;
+                case HexPrefix:
+                    if (cls & CHex) {
+                        m_hexVal = quint8(cls & CValue);
+                        m_hex = HexDigit;
+                        continue;
+                    }
+                    m_hex = HexNone;
+                    continue;
+                case HexZero:
+                    if (c == 'x' || c == 'X') { m_hex = HexPrefix; continue; }
+                    break;
+                case HexNone:
+                    break;
+                }
+                m_hex = c == '0' ? HexZero : HexNone;
+                continue;
+            }
+
+            // Разделитель: закрыть слово.
+            ++p;
+            if (m_inWord) {
+                m_inWord = false;
+                if (m_hex == HexDigit)
+                    m_out.append(m_hexVal);
+                else if (m_allDigits && m_wordLen <= 3 && m_decVal <= 255)
+                    m_out.append(quint8(m_decVal));
+                m_hex = HexNone;
+            }
+            if (c == '/') { m_mode = Slash; break; }
+        }
+    }
+}
+
+QVector<quint8> ByteLexer::parse(const QString& text) {
+    ByteLexer lx;
+    lx.reserve(text.size() / 6);
+    lx.feed(text);
+    lx.finish();
+    return lx.takeBytes();
+}
+
+QVector<quint8> ByteLexer::parseUtf8(const QByteArray& utf8) {
+    ByteLexer lx;
+    lx.reserve(utf8.size() / 6);
+    lx.feed(utf8);
+    lx.finish();
+    return lx.takeBytes();
+}
@@ -0,0 +1,68 @@
+// bytelexer.h
+#pragma once
+#include <QByteArray>
+#include <QChar>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * \brief Потоковый лексер байтовых литералов: "0x"/"0X" и десятичные, комментарии // и /* *\/.
+ * \details Однопроходный автомат без аллокаций на токен; текст подаётся порциями
+ *          произвольной длины (UTF-16 или сырой UTF-8), состояние между порциями сохраняется.
+ *
+ *          Правила совпадают с прежним регулярным выражением `0x([0-9A-F]{1,2})|\b(\d{1,3})\b`:
+ *          - "0x" + 1–2 гекс-цифры распознаются в любом месте слова ("a0x12" → 0x12);
+ *          - десятичное число — только слово целиком из 1–3 цифр, значение ≤ 255;
+ *          - словом считаются ASCII [A-Za-z0-9_], всё остальное (включая не-ASCII) — разделитель;
+ *          - комментарии работают как разделители.
+ */
+class ByteLexer {
+public:
+    ByteLexer() = default;
+
+    /// \name Подача текста
+    /// @{
+    void feed(const QChar* data, qsizetype n);
+    void feed(const char* utf8, qsizetype n);
+    void feed(const QString& text) { feed(text.constData(), text.size()); }
+    void feed(const QByteArray& utf8) { feed(utf8.constData(), utf8.size()); }
+
+    /** \brief Конец входа: дописать незавершённый токен. */
+    void finish();
+    /// @}
+
+    /** \brief Сбросить состояние и результат. */
+    void reset();
+
+    /// \name Результат
+    /// @{
+    const QVector<quint8>& bytes() const { return m_out; }
+    QVector<quint8> takeBytes() { QVector<quint8> r; r.swap(m_out); return r; }
+    /** \brief Зарезервировать место под ожидаемое число байтов. */
+    void reserve(qsizetype n) { m_out.reserve(n); }
+    /// @}
+
+    /// \name Разбор целиком
+    /// @{
+    static QVector<quint8> parse(const QString& text);
+    static QVector<quint8> parseUtf8(const QByteArray& utf8);
+    /// @}
+
+private:
+    template <typename Ch> void run(const Ch* p, const Ch* end);
+
+    /// \brief Состояние вне слова/комментария.
+    enum Mode : quint8 { Text, Slash, LineComment, BlockComment, BlockStar };
+    /// \brief Поиск "0x" внутри слова: ничего / '0' / "0x" / "0x" + одна цифра.
+    enum Hex : quint8 { HexNone, HexZero, HexPrefix, HexDigit };
+
+    QVector<quint8> m_out;
+    Mode    m_mode = Text;
+    Hex     m_hex = HexNone;
+    quint8  m_hexVal = 0;
+    bool    m_inWord = false;
+    bool    m_allDigits = false;
+    int     m_wordLen = 0;
+    int     m_decVal = 0;
+};
@@ -0,0 +1,59 @@
+/* gd_bitrle.c — битовый RLE.
+ * Биты глифа (байты строк, MSB первым) идут чередующимися сериями: 0, 1, 0, ...
+ * Длина серии — varint LEB128 (7 бит на байт, старший бит — продолжение).
+ * Первая серия нулей может быть пустой; последняя серия нулей не хранится. */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef GD_BITRLE_C
+#define GD_BITRLE_C
+
+#ifndef GD_API
+#define GD_API /* см. glyph_decode.h */
+#endif
+
+static inline void gd_bitrle_ones(uint8_t* dst, size_t pos, size_t n)
+{
+    while (n && (pos & 7u)) {
+        dst[pos >> 3] |= (uint8_t)(0x80u >> (pos & 7u));
+        ++pos; --n;
+    }
+    if (n >= 8u) {
+        memset(dst + (pos >> 3), 0xFF, n >> 3);
+        pos += n & ~(size_t)7u;
+        n &= 7u;
+    }
+    while (n) {
+        dst[pos >> 3] |= (uint8_t)(0x80u >> (pos & 7u));
+        ++pos; --n;
+    }
+}
+
+GD_API size_t gd_bitrle_decode(const uint8_t* src, size_t src_len, uint8_t* dst, size_t dst_len)
+{
+    const uint8_t* end = src + src_len;
+    const size_t total = dst_len * 8u;
+    size_t pos = 0;
+    int ones = 0;
+
+    memset(dst, 0, dst_len);
+    while (src < end && pos < total) {
+        size_t n = 0;
+        unsigned shift = 0;
+        uint8_t b;
+        do {
+            if (src >= end) return pos >> 3;
+            b = *src++;
+            n |= (size_t)(b & 0x7Fu) << shift;
+            shift += 7u;
+        } while (b & 0x80u);
+        if (n > total - pos) n = total - pos;
+        if (ones) gd_bitrle_ones(dst, pos, n);
+        pos += n;
+        ones ^= 1;
+    }
+    return dst_len; /* хвост — нули */
+}
+
+#endif /* GD_BITRLE_C */
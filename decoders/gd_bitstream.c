@@ -0,0 +1,56 @@
+/* gd_bitstream.c — плотный поток бит без выравнивания (FontCreator, BitStream).
+ * Строки глифа идут подряд по width бит, глифы — подряд друг за другом; пиксель (x, y)
+ * глифа со смещением bit_offset — бит n = bit_offset + y * width + x, старший бит байта
+ * идёт первым. Ни строки, ни глифы не дополняются до байта. */
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef GD_BITSTREAM_C
+#define GD_BITSTREAM_C
+
+#ifndef GD_API
+#define GD_API /* см. glyph_decode.h */
+#endif
+
+/* Пиксель (x, y) глифа: 1 — закрашен. Без проверки границ. */
+static inline int gd_bitstream_pixel(const uint8_t* bits, uint32_t bit_offset, uint16_t width,
+                                     unsigned x, unsigned y)
+{
+    const uint32_t n = bit_offset + (uint32_t)y * width + x;
+    return (bits[n >> 3] >> (7u - (n & 7u))) & 1u;
+}
+
+/* Уровень пикселя (x, y) серого глифа: bpp бит на пиксель (1, 2 или 4), width — в пикселях,
+ * строка занимает width * bpp бит, старший бит уровня первым. Смещения глифов кратны bpp,
+ * поэтому уровень не пересекает границу байта. Без проверки границ. */
+static inline unsigned gd_bitstream_level(const uint8_t* bits, uint32_t bit_offset, uint16_t width,
+                                          unsigned bpp, unsigned x, unsigned y)
+{
+    const uint32_t n = bit_offset + ((uint32_t)y * width + x) * bpp;
+    return (bits[n >> 3] >> (8u - bpp - (n & 7u))) & ((1u << bpp) - 1u);
+}
+
+/* Распаковка глифа в строки по (width + 7) / 8 байт, старший бит слева. Читаются только
+ * байты, которые содержат биты глифа; выводятся только целые строки, влезающие в dst. */
+GD_API size_t gd_bitstream_decode(const uint8_t* src, uint32_t bit_offset, uint16_t width, uint16_t height,
+                                  uint8_t* dst, size_t dst_len)
+{
+    const size_t bpr = ((size_t)width + 7u) / 8u;
+    uint32_t n = bit_offset;
+    size_t o = 0;
+    unsigned y, x;
+    if (bpr == 0u) return 0;
+    for (y = 0; y < height && bpr <= dst_len - o; ++y) {
+        for (x = 0; x < width; x += 8u) {
+            const unsigned k = width - x < 8u ? width - x : 8u;
+            const unsigned s = n & 7u;
+            unsigned v = (unsigned)src[n >> 3] << s;
+            if (s + k > 8u) v |= (unsigned)src[(n >> 3) + 1u] >> (8u - s);
+            dst[o++] = (uint8_t)(v & (0xFFu << (8u - k)));
+            n += k;
+        }
+    }
+    return o;
+}
+
+#endif /* GD_BITSTREAM_C */
@@ -0,0 +1,57 @@
+/* gd_lz.c — компактный LZ77 с окном 255 байт.
+ * Последовательность: токен (старшие 4 бита — число литералов, младшие — длина
+ * совпадения - 3; значение 15 продолжается байтами до первого != 255), литералы,
+ * затем — если вход не кончился — смещение (1 байт, 1..255). Совпадения могут
+ * перекрываться с выходом. Последняя последовательность — только литералы. */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef GD_LZ_C
+#define GD_LZ_C
+
+#ifndef GD_API
+#define GD_API /* см. glyph_decode.h */
+#endif
+
+GD_API size_t gd_lz_decode(const uint8_t* src, size_t src_len, uint8_t* dst, size_t dst_len)
+{
+    const uint8_t* end = src + src_len;
+    size_t o = 0;
+    while (src < end) {
+        const uint8_t t = *src++;
+        size_t lit = t >> 4;
+        size_t len = (size_t)(t & 15u) + 3u;
+        size_t off, i;
+        uint8_t b;
+
+        if (lit == 15u) {
+            do {
+                if (src >= end) return o;
+                b = *src++;
+                lit += b;
+            } while (b == 255u);
+        }
+        if (lit > (size_t)(end - src) || lit > dst_len - o) return o;
+        memcpy(dst + o, src, lit);
+        src += lit;
+        o += lit;
+        if (src >= end) break;
+
+        off = *src++;
+        if ((t & 15u) == 15u) {
+            do {
+                if (src >= end) return o;
+                b = *src++;
+                len += b;
+            } while (b == 255u);
+        }
+        if (off == 0u || off > o || len > dst_len - o) return o;
+        for (i = 0; i < len; ++i)
+            dst[o + i] = dst[o - off + i];
+        o += len;
+    }
+    return o;
+}
+
+#endif /* GD_LZ_C */
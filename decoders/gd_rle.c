@@ -0,0 +1,37 @@
+/* gd_rle.c — байтовый RLE (PackBits).
+ * Управляющий байт c: 0..127 — далее c+1 литералов; 128..255 — следующий байт
+ * повторяется c-126 раз (2..129). */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef GD_RLE_C
+#define GD_RLE_C
+
+#ifndef GD_API
+#define GD_API /* см. glyph_decode.h */
+#endif
+
+GD_API size_t gd_rle_decode(const uint8_t* src, size_t src_len, uint8_t* dst, size_t dst_len)
+{
+    const uint8_t* end = src + src_len;
+    size_t o = 0;
+    while (src < end && o < dst_len) {
+        const uint8_t c = *src++;
+        if (c < 128u) {
+            const size_t n = (size_t)c + 1u;
+            if (n > (size_t)(end - src) || n > dst_len - o) break;
+            memcpy(dst + o, src, n);
+            src += n;
+            o += n;
+        } else {
+            const size_t n = (size_t)c - 126u;
+            if (src >= end || n > dst_len - o) break;
+            memset(dst + o, *src++, n);
+            o += n;
+        }
+    }
+    return o;
+}
+
+#endif /* GD_RLE_C */
@@ -0,0 +1,31 @@
+/* glyph_decode.h — декодеры сжатых глифов FontCreator (переносимый C99). */
+#ifndef GLYPH_DECODE_H
+#define GLYPH_DECODE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Экспорт шрифта в C вставляет исходник декодера прямо в заголовок и перед ним задаёт
+ * GD_API = static inline: заголовок можно включать в несколько .c без повторных определений.
+ * При сборке gd_*.c как есть GD_API пуст и декодеры видны снаружи, как объявлено ниже. */
+
+/* Каждый декодер распаковывает один глиф из src[0..src_len) в dst[0..dst_len)
+ * и возвращает число записанных байт (dst_len при успехе). */
+size_t gd_rle_decode(const uint8_t* src, size_t src_len, uint8_t* dst, size_t dst_len);
+size_t gd_bitrle_decode(const uint8_t* src, size_t src_len, uint8_t* dst, size_t dst_len);
+size_t gd_lz_decode(const uint8_t* src, size_t src_len, uint8_t* dst, size_t dst_len);
+
+/* Плотный поток бит: глиф width × height начинается с бита bit_offset массива src,
+ * строки распаковываются по (width + 7) / 8 байт; возвращает число записанных байт. */
+size_t gd_bitstream_decode(const uint8_t* src, uint32_t bit_offset, uint16_t width, uint16_t height,
+                           uint8_t* dst, size_t dst_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GLYPH_DECODE_H */
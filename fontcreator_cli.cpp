@@ -0,0 +1,418 @@
+// fontcreator_cli.cpp
+// FontCreator-cli — пакетный конвертер без GUI (QtCore/QtGui).
+// Входы: изображения, текстовые заголовки с байтами, бинарные дампы (файлы или каталоги).
+// Выходы: C-массив с ASCII-рисунком, Python-список, список байтов или сырой бинарник.
+#include "binarizer.h"
+#include "bitpacker.h"
+#include "bitplane.h"
+#include "glyphbatch.h"
+#include "glyphio.h"
+#include "graydepth.h"
+#include "hexwriter.h"
+#include "workstealingpool.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSet>
+#include <QImage>
+#include <QMutex>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+enum class InputKind { Image, Text, Binary, Unknown };
+enum class OutputFormat { C, Py, Bytes, Bin };
+
+/// \brief Параметры конвертации, общие для всех файлов.
+struct Options {
+    OutputFormat format = OutputFormat::C;
+    QString outDir;
+    int  bytesPerRow = 2;
+    int  cols = 0;           ///< ширина глифа в пикселях; 0 — bytesPerRow * 8
+    int  rowsPerGlyph = 0;   ///< 0 — весь файл один глиф
+    PackFormat pack;         ///< раскладка и порядок бит байтов (вход и выход)
+    BinarizeOptions binarize;
+    int  depth = 1;          ///< бит на пиксель (GrayDepth); при 2 и 4 — только построчно
+    GlyphTransform transform; ///< пакетное преобразование всех глифов перед выводом
+};
+
+/// \brief Байты глифа: уровни серого (exportLevels) или биты в раскладке o.pack.
+QVector<quint8> glyphBytes(const BitPlane& g, const Options& o) {
+    return o.depth > 1 ? GlyphIO::exportLevels(g, o.depth, o.pack.msbFirst) : GlyphIO::exportBytes(g, o.pack);
+}
+
+InputKind kindOf(const QFileInfo& fi) {
+    static const QStringList images = { "bmp", "png", "jpg", "jpeg", "gif", "pbm", "pgm", "ppm" };
+    static const QStringList texts  = { "txt", "h", "hpp", "c", "cpp", "inc" };
+    const QString ext = fi.suffix().toLower();
+    if (images.contains(ext)) return InputKind::Image;
+    if (texts.contains(ext))  return InputKind::Text;
+    if (ext == "bin" || ext == "raw") return InputKind::Binary;
+    return InputKind::Unknown;
+}
+
+QString extensionOf(OutputFormat f) {
+    switch (f) {
+    case OutputFormat::C:     return "h";
+    case OutputFormat::Py:    return "py";
+    case OutputFormat::Bytes: return "txt";
+    case OutputFormat::Bin:   return "bin";
+    }
+    return "out";
+}
+
+/// \brief Имя файла → допустимый идентификатор C/Python.
+QString identifierOf(const QString& baseName) {
+    QString id;
+    id.reserve(baseName.size() + 1);
+    for (QChar ch : baseName)
+        id += (ch.isLetterOrNumber() && ch.unicode() < 128) ? ch : QChar(QLatin1Char('_'));
+    if (id.isEmpty() || id.at(0).isDigit())
+        id.prepend(QLatin1Char('_'));
+    return id;
+}
+
+/**
+ * \brief Разрезать поток байтов на глифы по rowsPerGlyph строк шириной cols (или bytesPerRow * 8).
+ * \details При depth > 1 ширина строки — cols · depth бит уровней (построчно).
+ */
+bool bytesToGlyphs(const QVector<quint8>& input, const Options& o, QVector<BitPlane>& out, QString& err) {
+    const int cols = (o.cols > 0 ? o.cols : o.bytesPerRow * 8 / o.depth) * o.depth;
+    const PackFormat pack = o.depth > 1 ? PackFormat{ PackLayout::RowMajor, true } : o.pack;
+    QVector<quint8> bytes = input;
+    if (bytes.isEmpty()) { err = "не найдено байтов"; return false; }
+    if (o.depth > 1 && !o.pack.msbFirst)
+        GrayDepth::reversePixels(bytes.data(), bytes.size(), o.depth);
+    const qsizetype glyphBytes = o.rowsPerGlyph > 0 ? BitPacker::packedSize(pack, o.rowsPerGlyph, cols)
+                                                    : bytes.size();
+    const int rows = o.rowsPerGlyph > 0 ? o.rowsPerGlyph : BitPacker::rowsFor(pack, glyphBytes, cols);
+    if (rows <= 0 || bytes.size() % glyphBytes != 0) {
+        err = QString("число байтов (%1) не кратно размеру глифа (%2)").arg(bytes.size()).arg(glyphBytes);
+        return false;
+    }
+    for (qsizetype off = 0; off < bytes.size(); off += glyphBytes) {
+        BitPlane bits(rows, cols);
+        BitPacker::unpack(bytes.constData() + off, { bits.rowBytes(0), bits.strideBytes(), rows, cols }, pack);
+        out.append(bits);
+    }
+    return true;
+}
+
+bool loadGlyphs(const QFileInfo& fi, const Options& o, QVector<BitPlane>& out, QString& err) {
+    switch (kindOf(fi)) {
+    case InputKind::Image: {
+        QImage img(fi.filePath());
+        if (img.isNull()) { err = "не удалось открыть изображение"; return false; }
+        if (o.depth > 1) {
+            BitPlane levels(img.height(), img.width() * o.depth);
+            GlyphIO::imageToLevels(img, levels, o.depth, o.binarize.invert);
+            out.append(levels);
+        } else {
+            out.append(Binarizer::binarized(img, o.binarize));
+        }
+        return true;
+    }
+    case InputKind::Text: {
+        QVector<quint8> bytes;
+        if (!GlyphIO::parseFile(fi.filePath(), bytes)) { err = "не удалось открыть файл"; return false; }
+        return bytesToGlyphs(bytes, o, out, err);
+    }
+    case InputKind::Binary: {
+        QFile f(fi.filePath());
+        if (!f.open(QIODevice::ReadOnly)) { err = "не удалось открыть файл"; return false; }
+        const QByteArray raw = f.readAll();
+        QVector<quint8> bytes(raw.size());
+        std::copy(raw.cbegin(), raw.cend(), bytes.begin());
+        return bytesToGlyphs(bytes, o, out, err);
+    }
+    case InputKind::Unknown:
+        break;
+    }
+    err = "неизвестный тип файла";
+    return false;
+}
+
+/// \brief Записать глифы в выходной файл в нужном формате (потоково, через HexWriter).
+bool render(QIODevice* dev, const QVector<BitPlane>& glyphs, const QString& name, const Options& o) {
+    if (o.format == OutputFormat::Bin) {
+        for (const BitPlane& g : glyphs) {
+            const QVector<quint8> bytes = glyphBytes(g, o);
+            if (dev->write(reinterpret_cast<const char*>(bytes.constData()), bytes.size()) != bytes.size())
+                return false;
+        }
+        return true;
+    }
+
+    HexWriter w(dev);
+    const QByteArray id = identifierOf(name).toUtf8();
+    switch (o.format) {
+    case OutputFormat::Bytes:
+    case OutputFormat::Py: {
+        if (o.format == OutputFormat::Py) { w.put(id.constData()); w.put(" = ["); }
+        bool first = true;
+        for (const BitPlane& g : glyphs) {
+            const QVector<quint8> bytes = glyphBytes(g, o);
+            if (bytes.isEmpty()) continue;
+            if (!first) w.put(", ");
+            w.putHexList(bytes.constData(), bytes.size());
+            first = false;
+        }
+        if (o.format == OutputFormat::Py) w.put(']');
+        w.put('\n');
+        break;
+    }
+    case OutputFormat::C: {
+        qint64 total = 0;
+        for (const BitPlane& g : glyphs)
+            total += o.depth > 1 ? BitPacker::packedSize({ PackLayout::RowMajor, true }, g.rows(), g.cols())
+                                 : BitPacker::packedSize(o.pack, g.rows(), g.cols());
+        w.put("// "); w.put(name); w.put(": ");
+        w.putDecimal(glyphs.size()); w.put(" glyph(s), ");
+        w.putDecimal(total); w.put(" bytes\n");
+        w.put("static const unsigned char "); w.put(id.constData()); w.put("[] = {\n");
+        for (int i = 0; i < glyphs.size(); ++i) {
+            w.put("    // ["); w.putDecimal(i); w.put("] ");
+            w.putDecimal(glyphs[i].cols() / o.depth); w.put('x'); w.putDecimal(glyphs[i].rows());
+            if (o.depth > 1) {
+                w.put(", "); w.putDecimal(o.depth); w.put(" bpp\n");
+                w.putCLevels(glyphs[i], o.depth, o.pack.msbFirst);
+            } else {
+                w.put('\n');
+                w.putCGlyph(glyphs[i], o.pack);
+            }
+        }
+        w.put("};\n");
+        break;
+    }
+    case OutputFormat::Bin:
+        break;
+    }
+    return w.flush();
+}
+
+/// \brief Ключ сравнения путей: абсолютный путь без «..» и ссылок (на Windows — без регистра).
+QString pathKey(const QFileInfo& fi) {
+    const QString canonical = fi.canonicalFilePath();
+    const QString path = canonical.isEmpty() ? QDir::cleanPath(fi.absoluteFilePath()) : canonical;
+#ifdef Q_OS_WIN
+    return path.toLower();
+#else
+    return path;
+#endif
+}
+
+/// \brief Собрать список входных файлов (каталоги — без рекурсии, только известные типы).
+/// \details Файл, названный дважды (сам и через каталог), берётся один раз.
+QFileInfoList collectInputs(const QStringList& args) {
+    QFileInfoList out;
+    QSet<QString> seen;
+    auto add = [&](const QFileInfo& fi) {
+        const QString key = pathKey(fi);
+        if (seen.contains(key)) return;
+        seen.insert(key);
+        out << fi;
+    };
+    for (const QString& a : args) {
+        const QFileInfo fi(a);
+        if (fi.isDir()) {
+            for (const QFileInfo& e : QDir(a).entryInfoList(QDir::Files, QDir::Name))
+                if (kindOf(e) != InputKind::Unknown)
+                    add(e);
+        } else {
+            add(fi);
+        }
+    }
+    return out;
+}
+
+/**
+ * \brief Выходной файл для каждого входа.
+ * \details Обычно — <имя без расширения>.<ext>; входы с одинаковым именем (a.png и a.h)
+ *          получают имя с расширением источника (a.png.h, a.h.h). Выход не может совпадать
+ *          ни с одним входом (иначе вход был бы затёрт своим же результатом) и с другим
+ *          выходом (два потока писали бы в один файл).
+ * \return false и сообщение в err при таком совпадении.
+ */
+bool planOutputs(const QFileInfoList& inputs, const QString& outDir, OutputFormat format,
+                 QStringList& outputs, QString& err) {
+    // Каталог уже создан: его канонический путь сравним с путями входов и через ссылки.
+    const QString canonicalDir = QDir(outDir).canonicalPath();
+    const QDir dir(canonicalDir.isEmpty() ? outDir : canonicalDir);
+    const QString ext = "." + extensionOf(format);
+    QHash<QString, int> baseCount;
+    for (const QFileInfo& fi : inputs)
+        ++baseCount[pathKey(QFileInfo(dir.filePath(fi.completeBaseName() + ext)))];
+
+    QHash<QString, int> inputIndex;
+    for (int i = 0; i < inputs.size(); ++i)
+        inputIndex.insert(pathKey(inputs[i]), i);
+
+    QHash<QString, int> outputIndex;
+    outputs.clear();
+    for (int i = 0; i < inputs.size(); ++i) {
+        const QFileInfo& fi = inputs[i];
+        QString path = dir.filePath(fi.completeBaseName() + ext);
+        if (baseCount.value(pathKey(QFileInfo(path))) > 1)
+            path = dir.filePath(fi.fileName() + ext);
+        const QString key = pathKey(QFileInfo(path));
+        if (inputIndex.contains(key)) {
+            err = QString("%1: результат %2 затёр бы входной файл, задайте другой каталог -o")
+                      .arg(fi.filePath(), path);
+            return false;
+        }
+        const auto other = outputIndex.constFind(key);
+        if (other != outputIndex.cend()) {
+            err = QString("%1 и %2 дают один и тот же файл %3")
+                      .arg(inputs[other.value()].filePath(), fi.filePath(), path);
+            return false;
+        }
+        outputIndex.insert(key, i);
+        outputs << path;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("FontCreator-cli");
+
+    QCommandLineParser p;
+    p.setApplicationDescription("Пакетная конвертация глифов: изображения/заголовки/дампы → C/Python/байты/бинарник.");
+    p.addHelpOption();
+    p.addPositionalArgument("inputs", "Входные файлы или каталоги.", "<input>...");
+    const QCommandLineOption optOut({ "o", "output" }, "Каталог для результатов.", "dir", ".");
+    const QCommandLineOption optFmt({ "f", "format" }, "Формат: c, py, bytes, bin.", "fmt", "c");
+    const QCommandLineOption optBpr("bpr", "Байт на строку для текстовых/бинарных входов.", "n", "2");
+    const QCommandLineOption optCols("cols", "Ширина глифа в пикселях, любая (по умолчанию bpr * 8).", "n", "0");
+    const QCommandLineOption optRows("rows", "Строк на глиф (0 — весь файл один глиф).", "n", "0");
+    const QCommandLineOption optLsb("lsb", "Младший бит первым: слева или сверху (по умолчанию MSB).");
+    const QCommandLineOption optLayout("layout", "Раскладка байтов: row, column, page (SSD1306).", "name", "row");
+    const QCommandLineOption optThr("threshold", "Порог бинаризации изображений (0..255).", "n", "128");
+    const QCommandLineOption optInv("invert", "Инвертировать изображения после бинаризации.");
+    const QCommandLineOption optBinarize("binarize", "Бинаризация изображений: threshold, otsu, fs, ordered.", "mode", "threshold");
+    const QCommandLineOption optBpp("bpp", "Бит на пиксель: 1, 2 или 4 (оттенки серого, построчно).", "n", "1");
+    const QCommandLineOption optNegate("negate", "Инвертировать все глифы после загрузки (любой вход).");
+    const QCommandLineOption optShift("shift", "Сдвинуть все глифы: dx вправо, dy вниз, px.", "dx,dy", "0,0");
+    const QCommandLineOption optResize("resize", "Новый размер глифов WxH (верхний левый угол на месте; 0 — прежний).", "WxH", "0x0");
+    const QCommandLineOption optLevelThr("level-threshold", "Порог уровней серых глифов: не ниже — полная заливка.", "n", "0");
+    const QCommandLineOption optOutBpp("out-bpp", "Перепаковать глифы в глубину 1, 2 или 4 перед выводом.", "n", "0");
+    const QCommandLineOption optJobs({ "j", "jobs" }, "Число потоков (0 — все ядра).", "n", "0");
+    p.addOptions({ optOut, optFmt, optBpr, optCols, optRows, optLsb, optLayout, optThr, optInv, optBinarize, optBpp,
+                   optNegate, optShift, optResize, optLevelThr, optOutBpp, optJobs });
+    p.process(app);
+
+    QTextStream err(stderr);
+    QTextStream out(stdout);
+
+    Options o;
+    const QString fmt = p.value(optFmt).toLower();
+    if      (fmt == "c")     o.format = OutputFormat::C;
+    else if (fmt == "py")    o.format = OutputFormat::Py;
+    else if (fmt == "bytes") o.format = OutputFormat::Bytes;
+    else if (fmt == "bin")   o.format = OutputFormat::Bin;
+    else { err << "Неизвестный формат: " << fmt << Qt::endl; return 2; }
+    o.outDir       = p.value(optOut);
+    o.bytesPerRow  = std::max(1, p.value(optBpr).toInt());
+    o.cols         = std::max(0, p.value(optCols).toInt());
+    o.rowsPerGlyph = std::max(0, p.value(optRows).toInt());
+    o.pack.msbFirst = !p.isSet(optLsb);
+    bool layoutOk = false;
+    o.pack.layout = BitPacker::fromName(p.value(optLayout), &layoutOk);
+    if (!layoutOk) { err << "Неизвестная раскладка: " << p.value(optLayout) << Qt::endl; return 2; }
+    o.binarize.threshold = qBound(0, p.value(optThr).toInt(), 256);
+    o.binarize.invert    = p.isSet(optInv);
+    const QString mode = p.value(optBinarize).toLower();
+    if      (mode == "threshold") o.binarize.mode = BinarizeMode::Threshold;
+    else if (mode == "otsu")      o.binarize.mode = BinarizeMode::Otsu;
+    else if (mode == "fs")        o.binarize.mode = BinarizeMode::FloydSteinberg;
+    else if (mode == "ordered")   o.binarize.mode = BinarizeMode::Ordered;
+    else { err << "Неизвестный режим бинаризации: " << mode << Qt::endl; return 2; }
+    o.depth = p.value(optBpp).toInt();
+    if (!GrayDepth::isValid(o.depth)) { err << "Неверная глубина пикселя: " << p.value(optBpp) << Qt::endl; return 2; }
+
+    GlyphTransform& t = o.transform;
+    const QStringList shift = p.value(optShift).split(',');
+    const QStringList size = p.value(optResize).toLower().split('x');
+    bool okX = false, okY = false, okW = false, okH = false;
+    if (shift.size() == 2) { t.shiftX = shift[0].toInt(&okX); t.shiftY = shift[1].toInt(&okY); }
+    if (size.size() == 2)  { t.cols = size[0].toInt(&okW); t.rows = size[1].toInt(&okH); }
+    if (!okX || !okY) { err << "Неверный сдвиг: " << p.value(optShift) << Qt::endl; return 2; }
+    if (!okW || !okH) { err << "Неверный размер: " << p.value(optResize) << Qt::endl; return 2; }
+    t.invert    = p.isSet(optNegate);
+    t.threshold = p.value(optLevelThr).toInt();
+    t.depth     = p.value(optOutBpp).toInt();
+    const QString badTransform = GlyphBatch::validate(t, o.depth);
+    if (!badTransform.isEmpty()) { err << "Преобразование: " << badTransform << Qt::endl; return 2; }
+    // Вывод — в глубине после преобразования.
+    Options outOpt = o;
+    if (t.depth) outOpt.depth = t.depth;
+
+    const QFileInfoList inputs = collectInputs(p.positionalArguments());
+    if (inputs.isEmpty()) {
+        p.showHelp(1);
+    }
+    if (!QDir().mkpath(o.outDir)) {
+        err << "Не удалось создать каталог: " << o.outDir << Qt::endl;
+        return 2;
+    }
+    QStringList outputs;
+    QString planError;
+    if (!planOutputs(inputs, o.outDir, o.format, outputs, planError)) {
+        err << planError << Qt::endl;
+        return 2;
+    }
+
+    WorkStealingPool pool(p.value(optJobs).toInt());
+    std::atomic<qint64> glyphCount{0};
+    std::atomic<int> failures{0};
+    QMutex logMutex;
+
+    QElapsedTimer timer;
+    timer.start();
+    pool.parallelFor(0, int(inputs.size()), 1, [&](int i0, int i1) {
+        for (int i = i0; i < i1; ++i) {
+            const QFileInfo& fi = inputs[i];
+            QVector<BitPlane> glyphs;
+            QString why;
+            bool ok = loadGlyphs(fi, o, glyphs, why);
+            if (ok && !o.transform.isIdentity(o.depth)) {
+                for (BitPlane& g : glyphs)   // параллельно идут файлы: глифы файла — подряд
+                    g = GlyphBatch::apply(g, o.depth, o.transform);
+            }
+            if (ok) {
+                QFile f(outputs[i]);
+                ok = f.open(QIODevice::WriteOnly | QIODevice::Truncate)
+                     && render(&f, glyphs, fi.completeBaseName(), outOpt);
+                if (!ok) why = "не удалось записать " + f.fileName();
+            }
+            if (ok) {
+                glyphCount += glyphs.size();
+            } else {
+                ++failures;
+                QMutexLocker lk(&logMutex);
+                err << fi.filePath() << ": " << why << Qt::endl;
+            }
+        }
+    });
+    const double sec = std::max(1e-9, timer.nsecsElapsed() / 1e9);
+
+    out << QString("Файлов: %1, ошибок: %2, глифов: %3, время: %4 с, %5 глифов/с, потоков: %6")
+               .arg(inputs.size())
+               .arg(failures.load())
+               .arg(glyphCount.load())
+               .arg(sec, 0, 'f', 3)
+               .arg(glyphCount.load() / sec, 0, 'f', 0)
+               .arg(pool.threadCount())
+        << Qt::endl;
+    return failures.load() ? 1 : 0;
+}
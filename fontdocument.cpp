@@ -0,0 +1,230 @@
+// fontdocument.cpp
+#include "fontdocument.h"
+#include "glyphdedup.h"
+#include "graydepth.h"
+#include <QSet>
+#include <cstring>
+
+namespace {
+/// \brief Размер влезает в 16-битные поля GlyphEntry (те же пределы, что у addGlyph()).
+bool fitsEntry(int rows, int cols) {
+    return rows >= 1 && rows <= 0xFFFF && cols >= 1 && cols <= 0xFFFF;
+}
+} // namespace
+
+quint32 FontDocument::allocate(int n) {
+    const qsizetype off = m_arena.size();
+    m_arena.resize(off + n);
+    std::memset(m_arena.data() + off, 0, size_t(n));
+    return quint32(off);
+}
+
+/** \brief Добавить пустой глиф; если кодпоинт уже есть — вернуть его индекс. */
+int FontDocument::addGlyph(quint32 codepoint, int rows, int cols) {
+    const int existing = indexOf(codepoint);
+    if (existing >= 0) return existing;
+
+    GlyphEntry e;
+    e.codepoint = codepoint;
+    e.rows = quint16(qBound(1, rows, 0xFFFF));
+    e.cols = quint16(qBound(1, cols, 0xFFFF));
+    e.offset = allocate(e.byteSize());
+
+    m_entries.append(e);
+    const int idx = int(m_entries.size()) - 1;
+    m_index.insert(codepoint, idx);
+    return idx;
+}
+
+/** \brief Добавить диапазон пустых глифов с предварительным резервированием памяти. */
+void FontDocument::addRange(quint32 first, int count, int rows, int cols) {
+    if (count <= 0) return;
+    const int glyphBytes = qBound(1, rows, 0xFFFF) * ((qBound(1, cols, 0xFFFF) + 7) / 8);
+    reserve(count, qsizetype(glyphBytes) * count);
+    for (int i = 0; i < count; ++i)
+        addGlyph(first + quint32(i), rows, cols);
+}
+
+void FontDocument::reserve(int glyphs, qsizetype arenaBytes) {
+    m_arena.reserve(m_arena.size() + arenaBytes);
+    m_entries.reserve(m_entries.size() + glyphs);
+    m_index.reserve(int(m_index.size()) + glyphs);
+}
+
+void FontDocument::clear() {
+    m_arena.clear();
+    m_entries.clear();
+    m_index.clear();
+    m_shared.clear();
+    m_backing.reset();
+}
+
+bool FontDocument::assign(const QByteArray& arena, const QVector<GlyphEntry>& entries,
+                          std::shared_ptr<const void> backing, int depth) {
+    if (!GrayDepth::isValid(depth)) return false;
+    QHash<quint32, int> index;
+    QHash<quint32, int> shared;
+    index.reserve(int(entries.size()));
+    for (int i = 0; i < entries.size(); ++i) {
+        const GlyphEntry& e = entries[i];
+        if (e.rows == 0 || e.cols == 0 || e.cols % depth || qsizetype(e.offset) + e.byteSize() > arena.size())
+            return false;
+        if (index.contains(e.codepoint)) return false;
+        index.insert(e.codepoint, i);
+        if (e.flags & GlyphEntry::kSharedSlot) ++shared[e.offset];
+    }
+    for (auto it = shared.begin(); it != shared.end();) {
+        if (it.value() < 2) it = shared.erase(it);
+        else ++it;
+    }
+
+    m_arena = arena;
+    m_entries = entries;
+    m_index = std::move(index);
+    m_shared = std::move(shared);
+    m_backing = std::move(backing);
+    m_depth = depth;
+    return true;
+}
+
+/** \brief Перевести все глифы в новую глубину; одинаковые после перевода — снова общие. */
+void FontDocument::setDepth(int depth) {
+    if (!GrayDepth::isValid(depth) || depth == m_depth) return;
+    const int from = m_depth;
+    m_depth = depth;
+    if (m_entries.isEmpty()) return;
+
+    QByteArray arena;
+    arena.reserve(m_arena.size() * depth / from);
+    m_arena.swap(arena);   // глифы читаются из прежней арены и дописываются в новую
+    for (GlyphEntry& e : m_entries) {
+        BitPlane bits(e.rows, e.cols);
+        bits.importRows(reinterpret_cast<const quint8*>(arena.constData()) + e.offset, e.bytesPerRow(), true);
+        BitPlane converted = GrayDepth::convert(bits, from, depth);
+        const int cols = qMin(e.cols / from, 0xFFFF / depth) * depth;
+        if (converted.cols() != cols)
+            converted = converted.resized(e.rows, cols);
+        e.cols = quint16(cols);
+        e.flags = 0;
+        e.offset = allocate(e.byteSize());
+        converted.exportRows(reinterpret_cast<quint8*>(m_arena.data()) + e.offset, e.bytesPerRow(), true);
+    }
+    m_shared.clear();
+    m_backing.reset();
+    deduplicate();
+}
+
+void FontDocument::detachArena() {
+    if (!m_backing) return;
+    m_arena = QByteArray(m_arena.constData(), m_arena.size());
+    m_backing.reset();
+}
+
+bool FontDocument::release(quint32 offset) {
+    auto it = m_shared.find(offset);
+    if (it == m_shared.end()) return false;
+    if (--it.value() < 2) m_shared.erase(it);
+    return true;
+}
+
+/** \brief Распаковать глиф в плоскость (MSB-first строки → memcpy). */
+BitPlane FontDocument::glyph(int index) const {
+    const GlyphEntry& e = m_entries[index];
+    BitPlane bits(e.rows, e.cols);
+    bits.importRows(glyphData(index), e.bytesPerRow(), true);
+    return bits;
+}
+
+/** \brief Записать плоскость в глиф (на месте или в новый участок арены). */
+bool FontDocument::setGlyph(int index, const BitPlane& bits) {
+    if (!fitsEntry(bits.rows(), bits.cols())) return false;
+    GlyphEntry& e = m_entries[index];
+    const bool shared = release(e.offset);
+    if (shared || e.rows != bits.rows() || e.cols != bits.cols()) {
+        e.rows = quint16(bits.rows());
+        e.cols = quint16(bits.cols());
+        e.offset = allocate(e.byteSize());
+    }
+    bits.exportRows(reinterpret_cast<quint8*>(m_arena.data()) + e.offset, e.bytesPerRow(), true);
+    return true;
+}
+
+/** \brief Записать сырые байты глифа, создав его при необходимости. */
+int FontDocument::setGlyphBytes(quint32 codepoint, int rows, int cols, const quint8* data) {
+    if (!fitsEntry(rows, cols)) return -1;
+    const int idx = addGlyph(codepoint, rows, cols);
+    GlyphEntry& e = m_entries[idx];
+    const bool shared = release(e.offset);
+    if (shared || e.rows != rows || e.cols != cols) {
+        e.rows = quint16(rows);
+        e.cols = quint16(cols);
+        e.offset = allocate(e.byteSize());
+    }
+    std::memcpy(m_arena.data() + e.offset, data, size_t(e.byteSize()));
+    return idx;
+}
+
+qsizetype FontDocument::usedBytes() const {
+    qsizetype n = 0;
+    QSet<quint32> seen;
+    for (const GlyphEntry& e : m_entries) {
+        if (m_shared.contains(e.offset)) {
+            if (seen.contains(e.offset)) continue;
+            seen.insert(e.offset);
+        }
+        n += e.byteSize();
+    }
+    return n;
+}
+
+/** \brief Перепаковать арену по порядку глифов, выбросив мусор; общие участки остаются общими. */
+void FontDocument::compact() {
+    QByteArray packed;
+    packed.reserve(usedBytes());
+    QHash<quint32, quint32> moved; ///< старое смещение общего участка → новое
+    QHash<quint32, int> shared;
+    for (GlyphEntry& e : m_entries) {
+        const auto refs = m_shared.constFind(e.offset);
+        if (refs != m_shared.cend()) {
+            const auto it = moved.constFind(e.offset);
+            if (it != moved.cend()) {
+                e.offset = it.value();
+                continue;
+            }
+            moved.insert(e.offset, quint32(packed.size()));
+            shared.insert(quint32(packed.size()), refs.value());
+        }
+        const quint32 off = quint32(packed.size());
+        packed.append(m_arena.constData() + e.offset, e.byteSize());
+        e.offset = off;
+    }
+    m_arena = packed;
+    m_shared = shared;
+}
+
+int FontDocument::deduplicate() {
+    DedupIndex index(glyphCount());
+    int merged = 0;
+    for (int i = 0; i < m_entries.size(); ++i) {
+        GlyphEntry& e = m_entries[i];
+        const int first = index.findOrInsert(glyphData(i), e.byteSize(), i);
+        const quint32 target = m_entries[first].offset;
+        if (first == i || e.offset == target) continue;
+        release(e.offset);
+        e.offset = target;
+        auto it = m_shared.find(target);
+        if (it == m_shared.end()) m_shared.insert(target, 2);
+        else ++it.value();
+        ++merged;
+    }
+    if (merged) compact();
+    return merged;
+}
+
+void FontDocument::detach(int index) {
+    GlyphEntry& e = m_entries[index];
+    if (!release(e.offset)) return;
+    const quint32 old = e.offset;
+    e.offset = allocate(e.byteSize());
+    std::memcpy(m_arena.data() + e.offset, m_arena.constData() + old, size_t(e.byteSize()));
+}
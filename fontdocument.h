@@ -0,0 +1,190 @@
+// fontdocument.h
+#pragma once
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+#include <QtGlobal>
+#include <memory>
+#include "bitplane.h"
+
+/**
+ * \brief Запись индекса глифа: где в арене лежит битмап и какого он размера.
+ * \details Данные глифа — rows строк по bytesPerRow() байт, горизонтальные байты MSB слева.
+ *          cols — ширина в битах: у серого шрифта (FontDocument::depth() > 1) это
+ *          пиксели · глубина (GrayDepth).
+ */
+struct GlyphEntry {
+    quint32 codepoint = 0;
+    quint32 offset    = 0; ///< смещение в арене, байты
+    quint16 rows      = 0;
+    quint16 cols      = 0; ///< ширина строки, бит
+    quint16 advance   = 0; ///< шаг до следующего глифа, px; 0 — не задан
+    quint16 flags     = 0; ///< служебные флаги хранения (kSharedSlot), в редакторе не используются
+
+    static constexpr quint16 kSharedSlot = 0x0001; ///< участок арены общий с другими глифами
+
+    int bytesPerRow() const { return (cols + 7) / 8; }
+    int byteSize()    const { return rows * bytesPerRow(); }
+};
+
+/**
+ * \brief Модель шрифта из множества глифов.
+ * \details Все битмапы хранятся в одной непрерывной арене (QByteArray), по каждому
+ *          кодпоинту — только запись смещение/размер. Поиск глифа по кодпоинту — O(1)
+ *          через хэш, загрузка/сохранение глифа — O(размер глифа), от числа глифов не зависит.
+ *
+ *          При изменении размера глифа новые данные дописываются в конец арены,
+ *          старый участок становится мусором до вызова compact().
+ *
+ *          После deduplicate() одинаковые глифы ссылаются на один участок арены
+ *          (копирование при записи: setGlyph/setGlyphBytes общего глифа сначала дают
+ *          ему собственный участок).
+ *
+ *          Глубина пикселя (1, 2 или 4 бита, GrayDepth) общая для всего шрифта: глифы
+ *          хранятся плоскостями шириной пиксели · depth() бит.
+ */
+class FontDocument {
+public:
+    FontDocument() = default;
+
+    /// \name Состав шрифта
+    /// @{
+    int  glyphCount() const { return int(m_entries.size()); }
+    bool isEmpty() const { return m_entries.isEmpty(); }
+    const GlyphEntry& entry(int index) const { return m_entries[index]; }
+    const QVector<GlyphEntry>& entries() const { return m_entries; }
+
+    /** \brief Индекс глифа по кодпоинту или -1. */
+    int indexOf(quint32 codepoint) const { return m_index.value(codepoint, -1); }
+    bool contains(quint32 codepoint) const { return m_index.contains(codepoint); }
+    /// @}
+
+    /// \name Глубина пикселя
+    /// @{
+    /** \brief Бит на пиксель: 1 — одноцветный шрифт, 2 или 4 — оттенки серого. */
+    int  depth() const { return m_depth; }
+    /**
+     * \brief Сменить глубину, переведя все глифы (GrayDepth::convert()).
+     * \details Ширина глифов в пикселях сохраняется, cols записей умножается на
+     *          новую глубину; после смены глифы заново склеиваются (deduplicate()).
+     */
+    void setDepth(int depth);
+    /** \brief Ширина глифа в пикселях (cols / depth()). */
+    int  glyphWidth(int index) const { return m_entries[index].cols / m_depth; }
+    /// @}
+
+    /**
+     * \brief Добавить пустой глиф (или вернуть индекс существующего).
+     * \param cols Ширина в битах (пиксели · depth()).
+     * \return Индекс глифа в entries().
+     */
+    int addGlyph(quint32 codepoint, int rows, int cols);
+
+    /**
+     * \brief Добавить диапазон пустых глифов [first, first+count).
+     * \details Арена резервируется одним куском под весь диапазон.
+     */
+    void addRange(quint32 first, int count, int rows, int cols);
+
+    /** \brief Зарезервировать место под glyphs записей и arenaBytes байт данных. */
+    void reserve(int glyphs, qsizetype arenaBytes);
+
+    /** \brief Удалить все глифы и освободить арену (глубина сохраняется). */
+    void clear();
+
+    /**
+     * \brief Заменить содержимое готовыми ареной и индексом (загрузка проекта).
+     * \details Арена не копируется: это может быть QByteArray::fromRawData() поверх
+     *          отображённого файла, тогда backing держит отображение, пока арена на него
+     *          ссылается; первая запись в арену делает её собственную копию. Записи с
+     *          флагом kSharedSlot восстанавливают общие участки (deduplicate()).
+     * \param depth Глубина пикселя; cols каждой записи должен делиться на неё.
+     * \return false, если кодпоинты повторяются, глиф выходит за арену или глубина неверна.
+     */
+    bool assign(const QByteArray& arena, const QVector<GlyphEntry>& entries,
+                std::shared_ptr<const void> backing = {}, int depth = 1);
+
+    /// \name Данные глифов
+    /// @{
+    /** \brief Сырые байты глифа в арене (rows × bytesPerRow, MSB слева). */
+    const quint8* glyphData(int index) const {
+        return reinterpret_cast<const quint8*>(m_arena.constData()) + m_entries[index].offset;
+    }
+
+    /**
+     * \brief Изменяемые байты глифа в арене.
+     * \details Указатель действителен, пока в документ не добавляются глифы и не меняются
+     *          их размеры; разные глифы можно заполнять из разных потоков. Общий глиф
+     *          (isShared()) перед записью нужно отделить через detach().
+     */
+    quint8* mutableGlyphData(int index) {
+        return reinterpret_cast<quint8*>(m_arena.data()) + m_entries[index].offset;
+    }
+
+    /** \brief Распаковать глиф в BitPlane. */
+    BitPlane glyph(int index) const;
+
+    /** \brief Задать шаг глифа (advance), px; 0 — не задан. */
+    void setAdvance(int index, int advance) { m_entries[index].advance = quint16(qBound(0, advance, 0xFFFF)); }
+
+    /**
+     * \brief Записать битмап глифа.
+     * \details При совпадении размера перезаписывает данные на месте, иначе
+     *          дописывает новый участок в конец арены.
+     * \return false (глиф не меняется), если размер вне 1…65535 строк и бит строки.
+     */
+    bool setGlyph(int index, const BitPlane& bits);
+
+    /**
+     * \brief Записать сырые байты глифа (rows × ceil(cols/8), MSB слева).
+     * \return Индекс глифа (создаётся при отсутствии); -1, если размер вне 1…65535.
+     */
+    int setGlyphBytes(quint32 codepoint, int rows, int cols, const quint8* data);
+    /// @}
+
+    /// \name Общие участки
+    /// @{
+    /**
+     * \brief Склеить глифы с одинаковыми байтами в один участок арены.
+     * \details Хэш-индекс по содержимому (DedupIndex), O(1) на глиф; затем compact().
+     * \return Число глифов, которые стали ссылаться на чужой участок.
+     */
+    int deduplicate();
+    /** \brief Глиф делит участок арены с другими глифами. */
+    bool isShared(int index) const { return m_shared.contains(m_entries[index].offset); }
+    /** \brief Дать общему глифу собственную копию участка. */
+    void detach(int index);
+    /// @}
+
+    /// \name Память
+    /// @{
+    /** \brief Размер арены в байтах (включая мусор после изменения размеров). */
+    qsizetype arenaBytes() const { return m_arena.size(); }
+    /** \brief Вся арена (GlyphEntry::offset — смещения в ней). */
+    const QByteArray& arena() const { return m_arena; }
+    /** \brief Арена лежит во внешней памяти (отображённом файле проекта). */
+    bool isArenaMapped() const { return bool(m_backing); }
+    /**
+     * \brief Скопировать арену во внутреннюю память и отпустить файл.
+     * \details Нужно перед перезаписью файла, из которого арена отображена.
+     */
+    void detachArena();
+    /** \brief Байты, реально занятые глифами (общий участок считается один раз). */
+    qsizetype usedBytes() const;
+    /** \brief Перепаковать арену, выбросив неиспользуемые участки. */
+    void compact();
+    /// @}
+
+private:
+    /// \brief Выделить участок арены под n байт (обнулённый), вернуть смещение.
+    quint32 allocate(int n);
+    /// \brief Снять одну ссылку с общего участка; false, если участок не общий.
+    bool release(quint32 offset);
+
+    QByteArray           m_arena;
+    QVector<GlyphEntry>  m_entries;
+    QHash<quint32, int>  m_index;  ///< кодпоинт → индекс в m_entries
+    QHash<quint32, int>  m_shared; ///< смещение общего участка → число глифов на нём (≥ 2)
+    std::shared_ptr<const void> m_backing; ///< владелец внешней памяти арены (отображённый файл)
+    int                  m_depth = 1;  ///< бит на пиксель (GrayDepth)
+};
@@ -0,0 +1,342 @@
+// fontexport.cpp
+#include "fontexport.h"
+#include "bitstream.h"
+#include "fontdocument.h"
+#include "glyphatlas.h"
+#include "glyphdedup.h"
+#include "glyphtrim.h"
+#include "graydepth.h"
+#include "hexwriter.h"
+#include <QVector>
+#include <algorithm>
+#include <cstring>
+
+namespace FontExport {
+
+namespace {
+
+void putCode(HexWriter& w, quint32 v) {
+    static const char digits[] = "0123456789ABCDEF";
+    char tmp[8];
+    int n = 0;
+    for (int shift = 28; shift >= 0; shift -= 4)
+        if ((v >> shift) || shift < 16) tmp[n++] = digits[(v >> shift) & 15];
+    w.put(tmp, n);
+}
+
+void write(HexWriter& w, const FontDocument& doc, const QString& name, const FontExportOptions& opt,
+           FontExportStats* stats) {
+    const QByteArray id = name.toUtf8();
+    const QByteArray idUpper = name.toUpper().toUtf8();
+    // Плотный поток строится из строк MSB-first; раскладка и сжатие к нему не применяются.
+    // Серые уровни (GrayDepth) — только построчно: пиксель не делится между байтами, а
+    // порядок «младшие первыми» переставляет пиксели в байте (reversePixels()).
+    const bool dense = opt.bitstream;
+    const int depth = doc.depth();
+    const bool gray = depth > 1;
+    const PackFormat format = dense || gray ? PackFormat{ PackLayout::RowMajor, dense || opt.format.msbFirst }
+                                            : opt.format;
+    const bool lsbLevels = gray && !format.msbFirst;
+    const bool packed = !dense && opt.codec != GlyphCodecKind::Raw;
+    const int n = doc.glyphCount();
+    // Ширина строки битмапа в битах (metrics — в пикселях).
+    auto bitWidth = [depth](const GlyphMetrics& m) { return int(m.width) * depth; };
+
+    // Битмапы всех глифов в выбранной раскладке: целиком или обрезанные по содержимому.
+    QVector<GlyphMetrics> metrics;
+    QByteArray bitmaps;
+    qint64 fullBytes = 0;
+    const PackFormat msbFormat = { format.layout, format.msbFirst || gray };
+    if (opt.trim) {
+        bitmaps = GlyphTrim::trimFont(doc, msbFormat, metrics);
+        for (const GlyphEntry& e : doc.entries())
+            fullBytes += BitPacker::packedSize(format, e.rows, e.cols);
+    } else {
+        QVector<quint32> offsets;
+        bitmaps = BitPacker::packFont(doc, msbFormat, &offsets);
+        fullBytes = bitmaps.size();
+        metrics.resize(n);
+        for (int i = 0; i < n; ++i) {
+            const GlyphEntry& e = doc.entry(i);
+            GlyphMetrics& m = metrics[i];
+            m.offset = offsets[i];
+            m.size   = quint32(BitPacker::packedSize(format, e.rows, e.cols));
+            m.width  = quint16(e.cols / depth);
+            m.height = e.rows;
+            m.advance = e.advance ? e.advance : m.width;
+        }
+    }
+    if (lsbLevels)
+        GrayDepth::reversePixels(reinterpret_cast<quint8*>(bitmaps.data()), bitmaps.size(), depth);
+    const quint8* base = reinterpret_cast<const quint8*>(bitmaps.constData());
+
+    // Сжатые потоки считаются заранее: размеры нужны в заголовке и таблице.
+    QVector<QByteArray> streams;
+    qint64 outBytes = bitmaps.size();
+    if (packed) {
+        streams.reserve(n);
+        outBytes = 0;
+        for (const GlyphMetrics& m : metrics) {
+            streams.append(GlyphCodec::encode(opt.codec, base + m.offset, int(m.size)));
+            outBytes += streams.last().size();
+        }
+    }
+
+    // В плотном потоке одинаковые байты строк ещё не значат одинаковые биты: ширина
+    // входит в ключ склейки (при равной ширине равны и высота, и биты).
+    if (dense && opt.dedup) {
+        streams.reserve(n);
+        for (const GlyphMetrics& m : metrics) {
+            QByteArray key(reinterpret_cast<const char*>(base + m.offset), qsizetype(m.size));
+            key.append(char(m.width & 0xFF));
+            key.append(char(m.width >> 8));
+            streams.append(key);
+        }
+    }
+
+    // Склейка одинаковых блоков: owner[i] — первый глиф с теми же байтами, out[i] — его смещение
+    // (в плотном потоке — в битах).
+    QVector<int> owner(n);
+    QVector<quint32> out(n);
+    int shared = 0;
+    quint32 offset = 0;
+    {
+        DedupIndex index(opt.dedup ? n : 0);
+        for (int i = 0; i < n; ++i) {
+            const GlyphMetrics& m = metrics[i];
+            const bool keyed = packed || (dense && opt.dedup);
+            const qsizetype size = keyed ? streams[i].size() : m.size;
+            const quint8* data = keyed ? reinterpret_cast<const quint8*>(streams[i].constData()) : base + m.offset;
+            owner[i] = opt.dedup && (dense ? qsizetype(m.size) : size) ? index.findOrInsert(data, size, i) : i;
+            if (owner[i] != i) {
+                out[i] = out[owner[i]];
+                outBytes -= size;
+                ++shared;
+                continue;
+            }
+            out[i] = offset;
+            offset += dense ? quint32(BitStream::bitSize(m.height, bitWidth(m))) : quint32(size);
+        }
+    }
+
+    // Плотный поток: строки глифов-владельцев подряд, без дополнения до байта.
+    QByteArray stream;
+    if (dense) {
+        BitStream::Writer writer(offset);
+        for (int i = 0; i < n; ++i) {
+            const GlyphMetrics& m = metrics[i];
+            if (owner[i] == i)
+                writer.append({ base + m.offset, (bitWidth(m) + 7) / 8, m.height, bitWidth(m) });
+        }
+        stream = writer.finish();
+        outBytes = stream.size();
+    }
+    if (stats) *stats = { fullBytes, outBytes, shared };
+
+    w.put("// "); w.put(id.constData()); w.put(": ");
+    w.putDecimal(n); w.put(" glyph(s)");
+    if (opt.trim) {
+        w.put(", trimmed: "); w.putDecimal(fullBytes); w.put(" -> "); w.putDecimal(bitmaps.size()); w.put(" bytes");
+    }
+    if (packed) {
+        w.put(", codec "); w.put(GlyphCodec::name(opt.codec));
+        w.put(": "); w.putDecimal(bitmaps.size()); w.put(" -> "); w.putDecimal(outBytes); w.put(" bytes");
+    }
+    if (dense) {
+        w.put(", bitstream: "); w.putDecimal(bitmaps.size()); w.put(" -> "); w.putDecimal(outBytes); w.put(" bytes");
+    }
+    if (shared) {
+        w.put(", shared: "); w.putDecimal(shared); w.put(" glyph(s)");
+    }
+    if (dense) {
+        w.put(gray ? "\n// layout: bitstream, rows of width * BPP bits without padding, msb first"
+                   : "\n// layout: bitstream, rows of width bits without padding, msb first");
+        w.put("\n// offset is in bits; each glyph lists the bytes that start inside it");
+    } else {
+        w.put("\n// layout: "); w.put(BitPacker::name(format.layout));
+        w.put(format.msbFirst ? ", msb first" : ", lsb first");
+    }
+    if (gray) {
+        w.put("\n// grayscale: "); w.putDecimal(depth); w.put(" bits per pixel, ");
+        w.putDecimal(GrayDepth::levels(depth)); w.put(" levels (0 = background), ");
+        w.putDecimal(8 / depth); w.put(" pixels per byte, ");
+        w.put(format.msbFirst ? "leftmost pixel in the high bits" : "leftmost pixel in the low bits");
+    }
+    w.put("\n#include <stdint.h>\n\n");
+
+    if (packed || dense) {
+        // Декодер живёт в заголовке: static inline, чтобы заголовок включался в несколько .c.
+        w.put("#ifndef GD_API\n#define GD_API static inline\n#endif\n");
+        w.put(dense ? GlyphCodec::bitstreamSource() : GlyphCodec::decoderSource(opt.codec));
+        w.put('\n');
+    }
+
+    w.put("typedef struct {\n"
+          "    uint32_t codepoint;\n"
+          "    uint32_t offset;   // ");
+    w.put(dense ? "bit offset in " : "in ");
+    w.put(id.constData());
+    w.put("_bitmaps\n");
+    if (packed) w.put("    uint32_t size;     // compressed bytes\n");
+    w.put("    uint16_t width;\n"
+          "    uint16_t height;\n");
+    if (opt.trim) {
+        w.put("    int16_t  x_offset; // bitmap position in the cell\n"
+              "    int16_t  y_offset;\n"
+              "    uint16_t advance;  // pen step to the next glyph\n");
+    }
+    w.put("} ");
+    w.put(id.constData()); w.put("_glyph_t;\n\n");
+
+    w.put("static const uint8_t "); w.put(id.constData()); w.put("_bitmaps[] = {\n");
+    BitPlane glyph;
+    for (int i = 0; i < n; ++i) {
+        const GlyphEntry& e = doc.entry(i);
+        const GlyphMetrics& m = metrics[i];
+        w.put("    // U+"); putCode(w, e.codepoint);
+        w.put(' '); w.putDecimal(m.width); w.put('x'); w.putDecimal(m.height);
+        const int cols = bitWidth(m);
+        if (owner[i] != i) {
+            w.put(" = U+"); putCode(w, doc.entry(owner[i]).codepoint); w.put('\n');
+            continue;
+        }
+        if (dense) {
+            const quint64 from = out[i];
+            const quint64 to = from + BitStream::bitSize(m.height, cols);
+            w.put(", "); w.putDecimal(qint64(to - from)); w.put(" bits\n");
+            const quint8* p = reinterpret_cast<const quint8*>(stream.constData());
+            const qsizetype end = BitStream::byteSize(to);
+            for (qsizetype k = BitStream::byteSize(from); k < end; k += 16) {
+                w.put("    ");
+                w.putHexList(p + k, std::min<qsizetype>(16, end - k));
+                w.put(",\n");
+            }
+            continue;
+        }
+        if (!packed) {
+            w.put('\n');
+            if (m.size) {
+                // Текст строится из тех же байтов, что ушли в размеры и смещения таблицы.
+                glyph.reset(m.height, cols);
+                const BitPacker::MutableRows rows{ glyph.rowBytes(0), glyph.strideBytes(), m.height, cols };
+                if (lsbLevels) {
+                    QByteArray msb(reinterpret_cast<const char*>(base + m.offset), qsizetype(m.size));
+                    GrayDepth::reversePixels(reinterpret_cast<quint8*>(msb.data()), msb.size(), depth);
+                    BitPacker::unpack(reinterpret_cast<const quint8*>(msb.constData()), rows, msbFormat);
+                } else {
+                    BitPacker::unpack(base + m.offset, rows, format);
+                }
+                if (gray) w.putCLevels(glyph, depth, format.msbFirst);
+                else w.putCGlyph(glyph, format);
+            }
+            continue;
+        }
+        const QByteArray& st = streams[i];
+        w.put(", "); w.putDecimal(m.size); w.put(" -> "); w.putDecimal(st.size()); w.put(" bytes\n");
+        const quint8* p = reinterpret_cast<const quint8*>(st.constData());
+        for (int k = 0; k < st.size(); k += 16) {
+            w.put("    ");
+            w.putHexList(p + k, std::min<int>(16, int(st.size()) - k));
+            w.put(",\n");
+        }
+    }
+    w.put("};\n\n");
+
+    w.put("static const "); w.put(id.constData()); w.put("_glyph_t ");
+    w.put(id.constData()); w.put("_glyphs[] = {\n");
+    for (int i = 0; i < n; ++i) {
+        const GlyphMetrics& m = metrics[i];
+        w.put("    { 0x"); putCode(w, doc.entry(i).codepoint);
+        w.put(", "); w.putDecimal(out[i]);
+        if (packed) { w.put(", "); w.putDecimal(streams[i].size()); }
+        w.put(", "); w.putDecimal(m.width);
+        w.put(", "); w.putDecimal(m.height);
+        if (opt.trim) {
+            w.put(", "); w.putDecimal(m.xOffset);
+            w.put(", "); w.putDecimal(m.yOffset);
+            w.put(", "); w.putDecimal(m.advance);
+        }
+        w.put(" },\n");
+    }
+    w.put("};\n");
+    w.put("#define "); w.put(idUpper.constData()); w.put("_GLYPH_COUNT ");
+    w.putDecimal(n); w.put('\n');
+    if (gray) {
+        w.put("#define "); w.put(idUpper.constData()); w.put("_BPP "); w.putDecimal(depth); w.put('\n');
+    }
+    if (dense && gray) {
+        // Уровень пикселя (x, y) глифа g; распаковка — в строки по ((width * BPP + 7) / 8) байт.
+        w.put("#define "); w.put(idUpper.constData()); w.put("_PIXEL(g, x, y) gd_bitstream_level(");
+        w.put(id.constData()); w.put("_bitmaps, (g)->offset, (g)->width, "); w.put(idUpper.constData());
+        w.put("_BPP, (x), (y))\n");
+        w.put("#define "); w.put(idUpper.constData()); w.put("_DECODE(g, dst) gd_bitstream_decode(");
+        w.put(id.constData()); w.put("_bitmaps, (g)->offset, (uint16_t)((g)->width * "); w.put(idUpper.constData());
+        w.put("_BPP), (g)->height, (dst), (size_t)(((g)->width * "); w.put(idUpper.constData());
+        w.put("_BPP + 7) / 8) * (g)->height)\n");
+    } else if (dense) {
+        // Пиксель (x, y) глифа g прямо из потока; распаковка — в строки по ((width + 7) / 8) байт.
+        w.put("#define "); w.put(idUpper.constData()); w.put("_PIXEL(g, x, y) gd_bitstream_pixel(");
+        w.put(id.constData()); w.put("_bitmaps, (g)->offset, (g)->width, (x), (y))\n");
+        w.put("#define "); w.put(idUpper.constData()); w.put("_DECODE(g, dst) gd_bitstream_decode(");
+        w.put(id.constData()); w.put("_bitmaps, (g)->offset, (g)->width, (g)->height, (dst), "
+                                     "(size_t)(((g)->width + 7) / 8) * (g)->height)\n");
+    }
+    if (packed) {
+        // Распаковка глифа g в буфер dst: ((width + 7) / 8) * height байт для строк,
+        // width * ((height + 7) / 8) — для вертикальных раскладок.
+        w.put("#define "); w.put(idUpper.constData()); w.put("_DECODE(g, dst) ");
+        w.put(GlyphCodec::decoderFunction(opt.codec));
+        w.put("("); w.put(id.constData()); w.put("_bitmaps + (g)->offset, (g)->size, (dst), ");
+        if (gray) {
+            w.put("(size_t)(((g)->width * "); w.put(idUpper.constData()); w.put("_BPP + 7) / 8) * (g)->height)\n");
+        } else {
+            w.put(format.layout == PackLayout::RowMajor ? "(size_t)(((g)->width + 7) / 8) * (g)->height)\n"
+                                                        : "(size_t)(g)->width * (((g)->height + 7) / 8))\n");
+        }
+    }
+}
+
+} // namespace
+
+QString toC(const FontDocument& doc, const QString& name, const FontExportOptions& opt, FontExportStats* stats) {
+    HexWriter w;
+    qsizetype size = 512;
+    for (const GlyphEntry& e : doc.entries())
+        size += HexWriter::cGlyphSize(e.rows, e.cols, opt.format) + 64;
+    w.reserve(size);
+    write(w, doc, name, opt, stats);
+    return QString::fromUtf8(w.takeBuffer());
+}
+
+bool writeC(QIODevice* dev, const FontDocument& doc, const QString& name, const FontExportOptions& opt,
+            FontExportStats* stats) {
+    HexWriter w(dev);
+    write(w, doc, name, opt, stats);
+    return w.flush();
+}
+
+QImage toAtlas(const FontDocument& doc, int columns) {
+    GlyphAtlas atlas(columns);
+    atlas.rebuild(doc);
+    if (doc.depth() == 1 || atlas.image().isNull())
+        return atlas.image();
+
+    // Серый шрифт: те же клетки, но индекс пикселя — уровень глифа.
+    const int depth = doc.depth();
+    QImage img(atlas.image().size(), QImage::Format_Indexed8);
+    if (img.isNull()) return img;
+    img.setColorTable(GrayDepth::colorTable(depth));
+    img.fill(0);
+    for (int i = 0; i < doc.glyphCount(); ++i) {
+        const QRect rc = atlas.glyphRect(i);
+        const BitPlane bits = doc.glyph(i);
+        for (int r = 0; r < rc.height(); ++r) {
+            uchar* out = img.scanLine(rc.y() + r) + rc.x();
+            for (int x = 0; x < rc.width(); ++x)
+                out[x] = uchar(GrayDepth::level(bits, depth, r, x));
+        }
+    }
+    return img;
+}
+
+} // namespace FontExport
@@ -0,0 +1,71 @@
+// fontexport.h
+#pragma once
+#include <QImage>
+#include <QString>
+#include "bitpacker.h"
+#include "glyphcodec.h"
+
+class FontDocument;
+class QIODevice;
+
+/**
+ * \brief Параметры экспорта шрифта в C.
+ * \details codec — сжатие глифов; для сжатых схем в исходник вставляется C-декодер,
+ *          дескриптор получает поле size, а макрос <NAME>_DECODE распаковывает глиф.
+ *          trim — глифы обрезаются по содержимому (GlyphTrim), дескриптор получает
+ *          x_offset, y_offset и advance, а width/height описывают обрезанный битмап.
+ *          dedup — одинаковые битмапы (после обрезки/сжатия) пишутся один раз, дескрипторы
+ *          повторов ссылаются на смещение первого такого глифа.
+ *          bitstream — строки всех глифов идут одним потоком бит без дополнения до байта
+ *          (BitStream): offset в дескрипторе — в битах, format и codec не применяются,
+ *          в исходник вставляется gd_bitstream.c и макросы <NAME>_PIXEL / <NAME>_DECODE.
+ *
+ *          Серый шрифт (FontDocument::depth() > 1) пишется построчно независимо от раскладки
+ *          format: строка — width · <NAME>_BPP бит уровней, msbFirst задаёт порядок пикселей
+ *          в байте; ASCII-рисунок передаёт яркость уровня (HexWriter::putCLevels()).
+ */
+struct FontExportOptions {
+    PackFormat     format;                       ///< раскладка байтов глифа и порядок бит
+    GlyphCodecKind codec = GlyphCodecKind::Raw;
+    bool           trim  = false;
+    bool           dedup = true;
+    bool           bitstream = false;            ///< плотный поток бит (BitStream), см. выше
+};
+
+/** \brief Объём битмапов до и после обрезки/сжатия/склейки (для строки состояния). */
+struct FontExportStats {
+    qint64 fullBytes = 0;   ///< глифы целиком, без обрезки и сжатия
+    qint64 bitmapBytes = 0; ///< фактический размер массива <name>_bitmaps
+    int    sharedGlyphs = 0; ///< глифы, ссылающиеся на битмап другого глифа
+};
+
+/**
+ * \brief Экспорт всего шрифта (FontDocument) одной C-таблицей.
+ * \details Битмапы всех глифов идут подряд в одном массиве байтов (C + ASCII-рисунок),
+ *          рядом — таблица дескрипторов {код, смещение, ширина, высота[, метрики]}.
+ */
+namespace FontExport {
+
+/**
+ * \brief Сформировать C-исходник шрифта.
+ * \param name Базовое имя идентификаторов (<name>_bitmaps, <name>_glyphs).
+ */
+QString toC(const FontDocument& doc, const QString& name, const FontExportOptions& opt = {},
+            FontExportStats* stats = nullptr);
+
+/**
+ * \brief Записать тот же C-исходник прямо в устройство (файл) порциями.
+ * \return false при ошибке записи.
+ */
+bool writeC(QIODevice* dev, const FontDocument& doc, const QString& name, const FontExportOptions& opt = {},
+            FontExportStats* stats = nullptr);
+
+/**
+ * \brief Атлас всех глифов одним 1-битным изображением (Format_Mono).
+ * \details Раскладка клеток — как в GlyphAtlas: максимальная ширина (кратно 8) ×
+ *          максимальная высота глифов, по columns в ряд, строки копируются memcpy.
+ *          Серый шрифт — Format_Indexed8 с палитрой GrayDepth::colorTable() в тех же клетках.
+ */
+QImage toAtlas(const FontDocument& doc, int columns = 16);
+
+} // namespace FontExport
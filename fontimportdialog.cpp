@@ -0,0 +1,112 @@
+// fontimportdialog.cpp
+#include "fontimportdialog.h"
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QFontComboBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QVBoxLayout>
+
+FontImportDialog::FontImportDialog(QWidget* parent)
+    : QDialog(parent)
+{
+    setWindowTitle("Импорт TTF/OTF");
+    auto *vl = new QVBoxLayout(this);
+    auto *form = new QFormLayout;
+
+    auto *fileRow = new QHBoxLayout;
+    m_leFile = new QLineEdit(this);
+    m_leFile->setPlaceholderText("пусто — системный шрифт");
+    auto *btnBrowse = new QPushButton("…", this);
+    fileRow->addWidget(m_leFile, 1);
+    fileRow->addWidget(btnBrowse);
+    form->addRow("Файл шрифта:", fileRow);
+
+    m_cbFamily = new QFontComboBox(this);
+    form->addRow("Системный шрифт:", m_cbFamily);
+
+    m_sbPixelSize = new QSpinBox(this);
+    m_sbPixelSize->setRange(4, 512);
+    m_sbPixelSize->setValue(16);
+    m_sbPixelSize->setSuffix(" px");
+    form->addRow("Размер:", m_sbPixelSize);
+
+    m_sbCellWidth = new QSpinBox(this);
+    m_sbCellWidth->setRange(0, 512);
+    m_sbCellWidth->setSpecialValueText("авто");
+    form->addRow("Ширина клетки:", m_sbCellWidth);
+
+    m_leRanges = new QLineEdit("0x20-0x7E", this);
+    m_leRanges->setToolTip("Диапазоны через запятую: 0x20-0x7E, 0x400-0x4FF, U+2116");
+    form->addRow("Диапазоны кодов:", m_leRanges);
+
+    m_cbDepth = new QComboBox(this);
+    m_cbDepth->addItem("1 бит (порог)", 1);
+    m_cbDepth->addItem("2 бита (4 уровня серого)", 2);
+    m_cbDepth->addItem("4 бита (16 уровней серого)", 4);
+    form->addRow("Глубина пикселя:", m_cbDepth);
+
+    m_sbThreshold = new QSpinBox(this);
+    m_sbThreshold->setRange(1, 255);
+    m_sbThreshold->setValue(128);
+    form->addRow("Порог:", m_sbThreshold);
+
+    m_chkInvert = new QCheckBox("Инвертировать", this);
+    m_chkAntialias = new QCheckBox("Сглаживание", this);
+    m_chkAntialias->setChecked(true);
+    form->addRow(QString(), m_chkInvert);
+    form->addRow(QString(), m_chkAntialias);
+    vl->addLayout(form);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    vl->addWidget(buttons);
+
+    connect(btnBrowse, &QPushButton::clicked, this, &FontImportDialog::browseFontFile);
+    // Серые уровни квантуются из сглаженного контура, порог им не нужен.
+    connect(m_cbDepth, qOverload<int>(&QComboBox::currentIndexChanged), this, [this](int) {
+        m_sbThreshold->setEnabled(m_cbDepth->currentData().toInt() == 1);
+    });
+    connect(m_leFile, &QLineEdit::textChanged, this, [this](const QString& t) {
+        m_cbFamily->setEnabled(t.trimmed().isEmpty());
+    });
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(buttons, &QDialogButtonBox::accepted, this, [this] {
+        RasterizeOptions opt;
+        QString why;
+        if (!options(opt, &why)) {
+            QMessageBox::warning(this, "Импорт TTF/OTF", why);
+            return;
+        }
+        accept();
+    });
+}
+
+void FontImportDialog::browseFontFile() {
+    const QString fn = QFileDialog::getOpenFileName(this, "Файл шрифта", m_leFile->text(),
+                                                    "Шрифты (*.ttf *.otf *.ttc);;Все файлы (*)");
+    if (!fn.isEmpty()) m_leFile->setText(fn);
+}
+
+bool FontImportDialog::options(RasterizeOptions& opt, QString* why) const {
+    bool ok = false;
+    opt.ranges = FontRasterizer::parseRanges(m_leRanges->text(), &ok);
+    if (!ok) {
+        if (why) *why = "Неверный список диапазонов кодов.";
+        return false;
+    }
+    opt.fontFile  = m_leFile->text().trimmed();
+    opt.family    = m_cbFamily->currentFont().family();
+    opt.pixelSize = m_sbPixelSize->value();
+    opt.cellWidth = m_sbCellWidth->value();
+    opt.threshold = m_sbThreshold->value();
+    opt.invert    = m_chkInvert->isChecked();
+    opt.antialias = m_chkAntialias->isChecked();
+    opt.depth     = m_cbDepth->currentData().toInt();
+    return true;
+}
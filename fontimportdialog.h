@@ -0,0 +1,37 @@
+// fontimportdialog.h
+#pragma once
+#include <QDialog>
+#include "fontrasterizer.h"
+
+class QCheckBox;
+class QComboBox;
+class QFontComboBox;
+class QLineEdit;
+class QSpinBox;
+
+/**
+ * \brief Диалог параметров импорта TTF/OTF: шрифт (файл или системный),
+ *        размер в пикселях, диапазоны кодов, глубина пикселя и параметры бинаризации.
+ */
+class FontImportDialog : public QDialog {
+    Q_OBJECT
+public:
+    explicit FontImportDialog(QWidget* parent = nullptr);
+
+    /** \brief Собрать параметры; false и сообщение в why при ошибке ввода. */
+    bool options(RasterizeOptions& opt, QString* why = nullptr) const;
+
+private slots:
+    void browseFontFile();
+
+private:
+    QLineEdit*     m_leFile      = nullptr;
+    QFontComboBox* m_cbFamily    = nullptr;
+    QSpinBox*      m_sbPixelSize = nullptr;
+    QSpinBox*      m_sbCellWidth = nullptr;
+    QLineEdit*     m_leRanges    = nullptr;
+    QSpinBox*      m_sbThreshold = nullptr;
+    QCheckBox*     m_chkInvert   = nullptr;
+    QCheckBox*     m_chkAntialias = nullptr;
+    QComboBox*     m_cbDepth     = nullptr;
+};
@@ -0,0 +1,188 @@
+// fontrasterizer.cpp
+#include "fontrasterizer.h"
+#include "fontdocument.h"
+#include "glyphio.h"
+#include "graydepth.h"
+#include "workstealingpool.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFont>
+#include <QImage>
+#include <QPainter>
+#include <QPainterPath>
+#include <QRawFont>
+#include <QRegularExpression>
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+
+namespace FontRasterizer {
+
+namespace {
+
+/// \brief Глифов в одной порции: достаточно, чтобы окупить создание QRawFont.
+constexpr int kChunk = 256;
+
+/// \brief Загрузить шрифт: из файла (данные уже прочитаны) или системный по семейству.
+QRawFont loadFont(const RasterizeOptions& opt, const QByteArray& fileData) {
+    if (!fileData.isEmpty())
+        return QRawFont(fileData, opt.pixelSize);
+    QFont f(opt.family);
+    f.setPixelSize(opt.pixelSize);
+    f.setStyleStrategy(QFont::NoFontMerging);
+    return QRawFont::fromFont(f);
+}
+
+bool parseNumber(const QString& s, quint32& v) {
+    bool ok = false;
+    const QString t = s.trimmed();
+    if (t.startsWith("0x", Qt::CaseInsensitive)) v = t.mid(2).toUInt(&ok, 16);
+    else if (t.startsWith("U+", Qt::CaseInsensitive)) v = t.mid(2).toUInt(&ok, 16);
+    else v = t.toUInt(&ok, 10);
+    return ok && v <= 0x10FFFF;
+}
+
+/// \brief Диапазоны по возрастанию, пересекающиеся и смежные слиты: каждый код — один раз.
+QVector<QPair<quint32, quint32>> mergeRanges(QVector<QPair<quint32, quint32>> ranges) {
+    std::sort(ranges.begin(), ranges.end());
+    QVector<QPair<quint32, quint32>> out;
+    for (const auto& r : ranges) {
+        if (!out.isEmpty() && r.first <= out.last().second + 1)
+            out.last().second = std::max(out.last().second, r.second);
+        else
+            out.append(r);
+    }
+    return out;
+}
+
+} // namespace
+
+QVector<QPair<quint32, quint32>> parseRanges(const QString& text, bool* ok) {
+    QVector<QPair<quint32, quint32>> out;
+    if (ok) *ok = false;
+    const QStringList parts = text.split(QRegularExpression(R"([,;\s]+)"), Qt::SkipEmptyParts);
+    for (const QString& part : parts) {
+        const int dash = part.indexOf('-');
+        quint32 a = 0, b = 0;
+        if (dash < 0) {
+            if (!parseNumber(part, a)) return {};
+            b = a;
+        } else if (!parseNumber(part.left(dash), a) || !parseNumber(part.mid(dash + 1), b) || b < a) {
+            return {};
+        }
+        out.append({ a, b });
+    }
+    if (ok) *ok = !out.isEmpty();
+    return mergeRanges(out);
+}
+
+int codeCount(const QVector<QPair<quint32, quint32>>& ranges) {
+    qint64 n = 0;
+    for (const auto& r : mergeRanges(ranges))
+        n += qint64(r.second) - r.first + 1;
+    return int(std::min<qint64>(n, 0x110000));
+}
+
+bool rasterize(const RasterizeOptions& opt, FontDocument& out, RasterizeResult* result,
+               std::atomic<int>* progress, const std::atomic<bool>* cancel) {
+    RasterizeResult res;
+    QElapsedTimer timer;
+    timer.start();
+    out.clear();
+
+    auto fail = [&](const QString& why) {
+        res.error = why;
+        if (result) *result = res;
+        return false;
+    };
+
+    QByteArray fileData;
+    if (!opt.fontFile.isEmpty()) {
+        QFile f(opt.fontFile);
+        if (!f.open(QIODevice::ReadOnly))
+            return fail("не удалось открыть файл шрифта");
+        fileData = f.readAll();
+    }
+    const QRawFont probe = loadFont(opt, fileData);
+    if (!probe.isValid())
+        return fail("шрифт не распознан");
+
+    // 1) Коды, которые есть в шрифте, и их индексы глифов; повтор кода дал бы два слота
+    //    на один глиф документа, поэтому диапазоны сливаются.
+    QVector<quint32> codes, glyphs;
+    for (const auto& r : mergeRanges(opt.ranges)) {
+        for (quint32 cp = r.first; cp <= r.second; ++cp) {
+            if (!probe.supportsCharacter(cp)) { ++res.missing; continue; }
+            const QVector<quint32> idx = probe.glyphIndexesForString(QString::fromUcs4(reinterpret_cast<const char32_t*>(&cp), 1));
+            if (idx.isEmpty() || idx.first() == 0) { ++res.missing; continue; }
+            codes.append(cp);
+            glyphs.append(idx.first());
+        }
+    }
+    if (progress) progress->fetch_add(res.missing);
+    if (codes.isEmpty())
+        return fail("в шрифте нет ни одного кода из диапазонов");
+
+    // 2) Геометрия клетки: высота — ascent+descent, ширина — максимальный advance (кратно 8).
+    const double ascent = probe.ascent();
+    res.rows = std::max(1, int(std::ceil(ascent + probe.descent())));
+    const QVector<QPointF> advances = probe.advancesForGlyphIndexes(glyphs);
+    int width = opt.cellWidth;
+    if (width <= 0) {
+        double maxAdv = 1.0;
+        for (const QPointF& a : advances)
+            maxAdv = std::max(maxAdv, a.x());
+        width = int(std::ceil(maxAdv));
+    }
+    res.cols = ((std::max(1, width) + 7) / 8) * 8;
+    const int depth = GrayDepth::isValid(opt.depth) ? opt.depth : 1;
+    const int bpr = res.cols * depth / 8;
+
+    // 3) Слоты в арене выделяются заранее, потоки пишут каждый в свои байты.
+    out.setDepth(depth);
+    out.reserve(int(codes.size()), qsizetype(codes.size()) * res.rows * bpr);
+    // Шаг глифа — из метрик шрифта: пригодится при экспорте обрезанных глифов.
+    QVector<int> index(codes.size());
+    for (int i = 0; i < codes.size(); ++i) {
+        index[i] = out.addGlyph(codes[i], res.rows, res.cols * depth);
+        out.setAdvance(index[i], int(std::lround(advances.value(i).x())));
+    }
+    QVector<quint8*> slots(codes.size());
+    for (int i = 0; i < codes.size(); ++i)
+        slots[i] = out.mutableGlyphData(index[i]);
+
+    // 4) Параллельная растеризация порциями.
+    WorkStealingPool::global().parallelFor(0, int(codes.size()), kChunk, [&](int i0, int i1) {
+        if (cancel && cancel->load()) return;
+        const QRawFont font = loadFont(opt, fileData);
+        QImage img(res.cols, res.rows, QImage::Format_Grayscale8);
+        QPainter p(&img);
+        p.setRenderHint(QPainter::Antialiasing, opt.antialias);
+        p.setPen(Qt::NoPen);
+        for (int i = i0; i < i1; ++i) {
+            p.fillRect(img.rect(), Qt::white);
+            p.fillPath(font.pathForGlyph(glyphs[i]).translated(0, ascent), Qt::black);
+            for (int y = 0; y < res.rows; ++y) {
+                if (depth > 1)
+                    GlyphIO::packGrayRowLevels(img.constScanLine(y), res.cols, slots[i] + y * bpr, depth, opt.invert);
+                else
+                    GlyphIO::packGrayRow(img.constScanLine(y), res.cols, slots[i] + y * bpr,
+                                         opt.threshold, opt.invert);
+            }
+        }
+        if (progress) progress->fetch_add(i1 - i0);
+    });
+
+    if (cancel && cancel->load()) {
+        out.clear();
+        return fail("отменено");
+    }
+
+    res.rendered = int(codes.size());
+    res.elapsedNs = timer.nsecsElapsed();
+    if (result) *result = res;
+    return true;
+}
+
+} // namespace FontRasterizer
@@ -0,0 +1,65 @@
+// fontrasterizer.h
+#pragma once
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+class FontDocument;
+
+/**
+ * \brief Параметры растеризации TrueType/OpenType шрифта в битмапы.
+ * \details Бинаризация — та же, что у importFromImage: яркость < threshold → пиксель,
+ *          invert инвертирует результат. При depth 2 или 4 порог не используется: яркость
+ *          сглаженного контура квантуется в уровни серого (GlyphIO::packGrayRowLevels()).
+ */
+struct RasterizeOptions {
+    QString fontFile;           ///< путь к TTF/OTF; если пусто — используется family
+    QString family;             ///< системное семейство шрифта
+    int     pixelSize = 16;
+    int     cellWidth = 0;      ///< ширина клетки, px; 0 — по максимальной ширине глифа
+    QVector<QPair<quint32, quint32>> ranges; ///< диапазоны кодов [first, last]
+    int     threshold = 128;
+    bool    invert = false;
+    bool    antialias = true;
+    int     depth = 1;          ///< бит на пиксель документа (GrayDepth): 1, 2 или 4
+};
+
+/** \brief Итог растеризации. */
+struct RasterizeResult {
+    int     rows = 0;
+    int     cols = 0;           ///< ширина клетки, px
+    int     rendered = 0;       ///< глифов растеризовано
+    int     missing = 0;        ///< кодов, которых нет в шрифте
+    qint64  elapsedNs = 0;
+    QString error;
+};
+
+/**
+ * \brief Растеризация шрифта в FontDocument.
+ * \details Коды делятся на порции и обрабатываются в WorkStealingPool::global();
+ *          у каждой порции свой QRawFont и свой QImage, поэтому потоки не делят
+ *          состояние. Результат бинаризуется сразу в байты арены документа.
+ */
+namespace FontRasterizer {
+
+/**
+ * \brief Разобрать список диапазонов: "0x20-0x7E, 0x400-0x4FF, 65".
+ * \return Диапазоны по возрастанию, пересекающиеся и смежные слиты;
+ *         пустой список при ошибке (ok = false).
+ */
+QVector<QPair<quint32, quint32>> parseRanges(const QString& text, bool* ok = nullptr);
+
+/**
+ * \brief Растеризовать шрифт; документ out очищается и заполняется глифами.
+ * \param progress Счётчик обработанных кодов (может быть nullptr).
+ * \param cancel   Флаг отмены (может быть nullptr); при отмене out пуст.
+ * \return true при успехе.
+ */
+bool rasterize(const RasterizeOptions& opt, FontDocument& out, RasterizeResult* result = nullptr,
+               std::atomic<int>* progress = nullptr, const std::atomic<bool>* cancel = nullptr);
+
+/** \brief Число кодов во всех диапазонах (для индикатора прогресса). */
+int codeCount(const QVector<QPair<quint32, quint32>>& ranges);
+
+} // namespace FontRasterizer
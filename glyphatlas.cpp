@@ -0,0 +1,113 @@
+// glyphatlas.cpp
+#include "glyphatlas.h"
+#include "fontdocument.h"
+#include "graydepth.h"
+#include <algorithm>
+#include <cstring>
+
+GlyphAtlas::GlyphAtlas(int columns) : m_columns(std::max(1, columns)) {}
+
+void GlyphAtlas::rebuild(const FontDocument& doc) {
+    const int n = doc.glyphCount();
+    m_dims.resize(n);
+    m_cellBpr = 1;
+    m_cellH = 1;
+    for (const GlyphEntry& e : doc.entries()) {
+        m_cellBpr = std::max(m_cellBpr, (e.cols / doc.depth() + 7) / 8);
+        m_cellH = std::max(m_cellH, int(e.rows));
+    }
+    if (n == 0) {
+        m_image = QImage();
+        return;
+    }
+
+    const int columns = std::min(m_columns, n);
+    const int gridRows = (n + columns - 1) / columns;
+    m_image = QImage(columns * m_cellBpr * 8, gridRows * m_cellH, QImage::Format_Mono);
+    if (m_image.isNull()) {
+        m_dims.clear();
+        return;
+    }
+    m_image.setColorTable({ qRgb(255, 255, 255), qRgb(0, 0, 0) });
+    m_image.fill(0);
+    for (int i = 0; i < n; ++i)
+        copyGlyph(doc, i);
+}
+
+bool GlyphAtlas::update(const FontDocument& doc, int index) {
+    if (index < 0 || index >= doc.glyphCount())
+        return true;
+    const GlyphEntry& e = doc.entry(index);
+    if (doc.glyphCount() != glyphCount() || (doc.glyphWidth(index) + 7) / 8 > m_cellBpr || e.rows > m_cellH) {
+        rebuild(doc);
+        return false;
+    }
+    quint8* c = cell(index);
+    const qsizetype bpl = m_image.bytesPerLine();
+    for (int r = 0; r < m_cellH; ++r)
+        std::memset(c + r * bpl, 0, size_t(m_cellBpr));
+    copyGlyph(doc, index);
+    return true;
+}
+
+QRect GlyphAtlas::glyphRect(int index) const {
+    const int columns = std::min(m_columns, glyphCount());
+    return QRect((index % columns) * m_cellBpr * 8, (index / columns) * m_cellH,
+                 m_dims[index].cols, m_dims[index].rows);
+}
+
+quint8* GlyphAtlas::cell(int index) {
+    const int columns = std::min(m_columns, glyphCount());
+    return m_image.bits() + qsizetype(index / columns) * m_cellH * m_image.bytesPerLine()
+         + (index % columns) * m_cellBpr;
+}
+
+const quint8* GlyphAtlas::cell(int index) const {
+    const int columns = std::min(m_columns, glyphCount());
+    return m_image.constBits() + qsizetype(index / columns) * m_cellH * m_image.bytesPerLine()
+         + (index % columns) * m_cellBpr;
+}
+
+void GlyphAtlas::copyGlyph(const FontDocument& doc, int index) {
+    const GlyphEntry& e = doc.entry(index);
+    const int depth = doc.depth(), width = doc.glyphWidth(index);
+    m_dims[index] = { e.rows, quint16(width) };
+    const quint8* src = doc.glyphData(index);
+    quint8* dst = cell(index);
+    const qsizetype bpl = m_image.bytesPerLine();
+    for (int r = 0; r < e.rows; ++r, dst += bpl, src += e.bytesPerRow()) {
+        if (depth > 1)
+            GrayDepth::inkRow(src, width, depth, dst);
+        else
+            std::memcpy(dst, src, size_t(e.bytesPerRow()));
+    }
+}
+
+void GlyphAtlas::blit(int index, quint8* dst, qsizetype stride, int width, int height, int x, int y) const {
+    const Dims& d = m_dims[index];
+    if (x < 0 || x >= width || y >= height || y + d.rows <= 0)
+        return;
+    const int dstBpr = (width + 7) / 8;
+    const int b0 = x / 8, s = x % 8;
+    const int n = std::min((d.cols + 7) / 8, dstBpr - b0);
+    // При сдвиге последний байт строки глифа переливается в следующий байт буфера.
+    const bool spill = s && b0 + n < dstBpr;
+    const int r0 = std::max(0, -y), r1 = std::min<int>(d.rows, height - y);
+    const qsizetype bpl = m_image.bytesPerLine();
+
+    const quint8* src = cell(index) + r0 * bpl;
+    quint8* out = dst + qsizetype(y + r0) * stride + b0;
+    for (int r = r0; r < r1; ++r, src += bpl, out += stride) {
+        if (s == 0) {
+            for (int k = 0; k < n; ++k)
+                out[k] |= src[k];
+            continue;
+        }
+        for (int k = 0; k < n - 1; ++k) {
+            out[k]     |= quint8(src[k] >> s);
+            out[k + 1] |= quint8(src[k] << (8 - s));
+        }
+        out[n - 1] |= quint8(src[n - 1] >> s);
+        if (spill) out[n] |= quint8(src[n - 1] << (8 - s));
+    }
+}
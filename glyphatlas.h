@@ -0,0 +1,69 @@
+// glyphatlas.h
+#pragma once
+#include <QImage>
+#include <QRect>
+#include <QVector>
+#include <QtGlobal>
+
+class FontDocument;
+
+/**
+ * \brief Кэш всех глифов шрифта в одном 1-битном изображении (Format_Mono).
+ * \details Клетка — максимальная ширина глифа (кратно 8) × максимальная высота, глифы идут
+ *          по строкам слева направо, по columns в ряд; строки глифа копируются в сканлайны
+ *          memcpy. После правки одного глифа обновляется только его клетка (update()), атлас
+ *          перестраивается целиком лишь при изменении состава шрифта или если глиф перестал
+ *          помещаться в клетку.
+ *
+ *          Серый шрифт (FontDocument::depth() > 1) попадает в атлас маской GrayDepth::inkRow():
+ *          закрашены пиксели с уровнем не меньше половины; размеры — в пикселях.
+ */
+class GlyphAtlas {
+public:
+    explicit GlyphAtlas(int columns = 16);
+
+    /** \brief Перестроить атлас по документу. */
+    void rebuild(const FontDocument& doc);
+
+    /**
+     * \brief Обновить клетку глифа index.
+     * \return false, если пришлось перестроить атлас целиком.
+     */
+    bool update(const FontDocument& doc, int index);
+
+    int   glyphCount() const { return int(m_dims.size()); }
+    /** \brief Размер клетки, px (ширина кратна 8). */
+    QSize cellSize() const { return { m_cellBpr * 8, m_cellH }; }
+    /** \brief Размер глифа index, px. */
+    QSize glyphSize(int index) const { return { m_dims[index].cols, m_dims[index].rows }; }
+    /** \brief Прямоугольник глифа index в image(). */
+    QRect glyphRect(int index) const;
+    /** \brief Атлас: 0 — фон, 1 — закрашенный пиксель. */
+    const QImage& image() const { return m_image; }
+
+    /**
+     * \brief Наложить (OR) глиф index на 1-битный буфер строк MSB-first.
+     * \details Буфер width × height пикселей с шагом stride байт; левый верхний угол глифа
+     *          в (x, y), x ≥ 0. Выходящее за буфер отсекается. Строка глифа сдвигается
+     *          на x % 8 бит и накладывается побайтно.
+     */
+    void blit(int index, quint8* dst, qsizetype stride, int width, int height, int x, int y) const;
+
+private:
+    struct Dims {
+        quint16 rows = 0;
+        quint16 cols = 0;
+    };
+
+    /// \brief Скопировать глиф в его клетку (клетка предварительно очищается).
+    void copyGlyph(const FontDocument& doc, int index);
+    /// \brief Начало клетки глифа index в атласе.
+    quint8* cell(int index);
+    const quint8* cell(int index) const;
+
+    int           m_columns;
+    int           m_cellBpr = 1; ///< ширина клетки, байты
+    int           m_cellH = 1;
+    QVector<Dims> m_dims;
+    QImage        m_image;
+};
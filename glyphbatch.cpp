@@ -0,0 +1,280 @@
+// glyphbatch.cpp
+#include "glyphbatch.h"
+#include "bitpacker.h"
+#include "fontdocument.h"
+#include "graydepth.h"
+#include "trace.h"
+#include "workstealingpool.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QVarLengthArray>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr int kChunk = 64;   ///< глифов на задачу пула
+
+/// \brief 8 бит строки src (n байт) с бита p; за пределами [0, n · 8) — нули.
+inline quint8 bitsAt(const quint8* src, int n, int p) {
+    if (p < 0)
+        return p > -8 && n > 0 ? quint8(src[0] >> -p) : 0;
+    const int q = p >> 3, sh = p & 7;
+    const int hi = q < n ? src[q] : 0;
+    if (!sh) return quint8(hi);
+    const int lo = q + 1 < n ? src[q + 1] : 0;
+    return quint8((hi << sh) | (lo >> (8 - sh)));
+}
+
+/// \brief Строка dst (m байт) — строка src (n байт), сдвинутая на shift бит вправо (< 0 — влево).
+void shiftRow(const quint8* src, int n, int shift, quint8* dst, int m) {
+    if (!(shift & 7)) {
+        // Кратно байту: копия куска и нули по краям.
+        const int q = shift / 8;
+        const int lo = qBound(0, q, m), hi = qBound(lo, n + q, m);
+        std::memset(dst, 0, size_t(lo));
+        if (hi > lo) std::memcpy(dst + lo, src + (lo - q), size_t(hi - lo));
+        std::memset(dst + hi, 0, size_t(m - hi));
+        return;
+    }
+    for (int j = 0; j < m; ++j)
+        dst[j] = bitsAt(src, n, j * 8 - shift);
+}
+
+inline quint8 tailMask(int bits) {
+    return bits & 7 ? quint8(0xFF << (8 - (bits & 7))) : quint8(0xFF);
+}
+
+/**
+ * \brief Преобразование, разобранное под пару глубин from → to.
+ * \details Порог, перевод глубины и инверсия сведены в таблицу уровней; при одинаковой
+ *          глубине — в таблицу на байт (все пиксели байта за одно обращение).
+ */
+class Kernel {
+public:
+    Kernel(const GlyphTransform& t, int from, int to)
+        : m_t(t), m_from(from), m_to(to)
+    {
+        const int topFrom = GrayDepth::levels(from) - 1, topTo = GrayDepth::levels(to) - 1;
+        for (int v = 0; v <= topFrom; ++v) {
+            int u = t.threshold > 0 ? (v >= t.threshold ? topFrom : 0) : v;
+            if (from != to) u = (2 * u * topTo + topFrom) / (2 * topFrom);   // как GrayDepth::convert()
+            if (t.invert) u = topTo - u;
+            m_levelMap[v] = quint8(u);
+        }
+        m_plain = from == to;
+        if (from != to) return;
+        const int per = 8 / from;
+        for (int b = 0; b < 256; ++b) {
+            int out = 0;
+            for (int k = 0; k < per; ++k) {
+                const int shift = 8 - from * (k + 1);
+                out |= m_levelMap[(b >> shift) & topFrom] << shift;
+            }
+            m_byteLut[b] = quint8(out);
+            m_plain = m_plain && out == b;
+        }
+    }
+
+    /// \brief Высота итогового глифа из rows строк.
+    int outRows(int rows) const { return qBound(0, m_t.rows > 0 ? m_t.rows : rows, 0xFFFF); }
+    /// \brief Ширина итоговой строки в битах из строки в cols бит.
+    int outCols(int cols) const {
+        const int pixels = m_t.cols > 0 ? m_t.cols : cols / m_from;
+        return qBound(0, pixels, 0xFFFF / m_to) * m_to;
+    }
+    /// \brief Байт буфера потока на строку источника в cols бит.
+    int scratchBytes(int cols) const { return (cols / m_from * m_to + 7) / 8 + 1; }
+
+    /** \brief Записать в dst (размер — outRows() × outCols()) преобразованный глиф src. */
+    void run(const BitPacker::Rows& src, const BitPacker::MutableRows& dst, quint8* scratch) const {
+        const int pixels = src.cols / m_from;
+        const int midBits = pixels * m_to, midBytes = (midBits + 7) / 8;
+        const int dstBpr = (dst.cols + 7) / 8;
+        const int shift = m_t.shiftX * m_to;
+        const quint8 tail = tailMask(dst.cols);
+        for (int r = 0; r < dst.rows; ++r) {
+            quint8* d = dst.data + qsizetype(r) * dst.stride;
+            const int sr = r - m_t.shiftY;
+            if (m_t.clear || sr < 0 || sr >= src.rows || midBits == 0) {
+                std::memset(d, 0, size_t(dstBpr));
+                continue;
+            }
+            const quint8* s = src.data + qsizetype(sr) * src.stride;
+            if (m_plain) {
+                std::memcpy(scratch, s, size_t(midBytes));
+            } else if (m_from == m_to) {
+                for (int b = 0; b < midBytes; ++b)
+                    scratch[b] = m_byteLut[s[b]];
+            } else {
+                std::memset(scratch, 0, size_t(midBytes));
+                const int mask = GrayDepth::levels(m_from) - 1;
+                for (int x = 0; x < pixels; ++x) {
+                    const int in = x * m_from, out = x * m_to;
+                    const int v = m_levelMap[(s[in >> 3] >> (8 - m_from - (in & 7))) & mask];
+                    scratch[out >> 3] |= quint8(v << (8 - m_to - (out & 7)));
+                }
+            }
+            scratch[midBytes - 1] &= tailMask(midBits);   // лишние биты источника и инверсии
+            shiftRow(scratch, midBytes, shift, d, dstBpr);
+            d[dstBpr - 1] &= tail;
+        }
+    }
+
+private:
+    GlyphTransform m_t;
+    int    m_from;
+    int    m_to;
+    bool   m_plain = false;       ///< строка переносится без изменений
+    quint8 m_levelMap[16] = {};   ///< уровень источника → уровень результата
+    quint8 m_byteLut[256] = {};   ///< при from == to: байт источника → байт результата
+};
+
+BitPlane applyKernel(const Kernel& k, const BitPlane& bits) {
+    BitPlane out(k.outRows(bits.rows()), k.outCols(bits.cols()));
+    if (out.isEmpty()) return out;
+    QVarLengthArray<quint8, 512> scratch(k.scratchBytes(bits.cols()));
+    k.run(bits.isEmpty() ? BitPacker::Rows{} : BitPacker::rowsOf(bits),
+          { out.rowBytes(0), out.strideBytes(), out.rows(), out.cols() }, scratch.data());
+    return out;
+}
+
+} // namespace
+
+bool GlyphTransform::isIdentity(int depth) const {
+    return !invert && !clear && shiftX == 0 && shiftY == 0 && rows == 0 && cols == 0
+           && (threshold == 0 || depth == 1) && (this->depth == 0 || this->depth == depth);
+}
+
+namespace GlyphBatch {
+
+QString validate(const GlyphTransform& t, int depth) {
+    if (!GrayDepth::isValid(depth))
+        return "неверная глубина пикселя";
+    if (t.depth != 0 && !GrayDepth::isValid(t.depth))
+        return QString("неверная новая глубина пикселя: %1").arg(t.depth);
+    if (t.rows < 0 || t.cols < 0)
+        return "размер глифа не может быть отрицательным";
+    const int top = GrayDepth::levels(depth) - 1;
+    if (t.threshold < 0 || t.threshold > top)
+        return QString("порог вне уровней 1…%1").arg(top);
+    return {};
+}
+
+BitPlane apply(const BitPlane& bits, int depth, const GlyphTransform& t) {
+    return applyKernel(Kernel(t, depth, t.depth ? t.depth : depth), bits);
+}
+
+bool apply(QVector<BitPlane>& glyphs, int depth, const GlyphTransform& t,
+           std::atomic<int>* progress, const std::atomic<bool>* cancel) {
+    if (!validate(t, depth).isEmpty()) return false;
+    const Kernel k(t, depth, t.depth ? t.depth : depth);
+    QVector<BitPlane> out(glyphs.size());
+    BitPlane* dst = out.data();
+    const BitPlane* src = glyphs.constData();
+    WorkStealingPool::global().parallelFor(0, int(glyphs.size()), kChunk, [&](int i0, int i1) {
+        if (cancel && cancel->load()) return;
+        for (int i = i0; i < i1; ++i)
+            dst[i] = applyKernel(k, src[i]);
+        if (progress) progress->fetch_add(i1 - i0);
+    });
+    if (cancel && cancel->load()) return false;
+    glyphs.swap(out);
+    return true;
+}
+
+bool apply(FontDocument& doc, const QVector<int>& glyphs, const GlyphTransform& t,
+           BatchResult* result, std::atomic<int>* progress, const std::atomic<bool>* cancel) {
+    FC_TRACE_OPERATION("GlyphBatch::apply");
+    QElapsedTimer timer;
+    timer.start();
+    BatchResult res;
+    auto fail = [&](const QString& why) {
+        res.error = why;
+        if (result) *result = res;
+        return false;
+    };
+
+    const int from = doc.depth();
+    const int to = t.depth ? t.depth : from;
+    const QString why = validate(t, from);
+    if (!why.isEmpty()) return fail(why);
+
+    const int n = doc.glyphCount();
+    QVector<char> selected(n, glyphs.isEmpty() ? 1 : 0);
+    for (int i : glyphs) {
+        if (i < 0 || i >= n) return fail(QString("нет глифа с номером %1").arg(i));
+        selected[i] = 1;
+    }
+    GlyphTransform convertOnly;
+    convertOnly.depth = to;
+    const Kernel kernels[2] = { Kernel(convertOnly, from, to), Kernel(t, from, to) };
+
+    // 1) План: у глифов с одним участком, размером и отметкой «в списке» — один новый участок,
+    //    его пишет первый из них (owner). Участок, общий со списком и вне его, так разделяется.
+    const QVector<GlyphEntry> old = doc.entries();
+    QVector<GlyphEntry> entries = old;
+    QVector<int> owner(n);
+    QHash<quint64, int> first[2];
+    quint64 total = 0;
+    for (int i = 0; i < n; ++i) {
+        const GlyphEntry& e = old[i];
+        const int sel = selected[i];
+        res.glyphs += sel;
+        const quint64 key = (quint64(e.offset) << 32) | (quint64(e.rows) << 16) | e.cols;
+        const auto it = first[sel].constFind(key);
+        if (it != first[sel].cend()) {
+            owner[i] = it.value();
+            entries[i].rows   = entries[owner[i]].rows;
+            entries[i].cols   = entries[owner[i]].cols;
+            entries[i].offset = entries[owner[i]].offset;
+            continue;
+        }
+        first[sel].insert(key, i);
+        owner[i] = i;
+        GlyphEntry& d = entries[i];
+        d.rows   = quint16(std::max(1, kernels[sel].outRows(e.rows)));
+        d.cols   = quint16(std::max(to, kernels[sel].outCols(e.cols)));
+        d.offset = quint32(total);
+        total += quint64(d.byteSize());
+        if (total > 0xFFFFFFFFu) return fail("арена шрифта больше 4 ГБ");
+    }
+
+    // 2) Новая арена: каждый участок пишет ровно один поток, исходная арена только читается.
+    QByteArray arena;
+    arena.resize(qsizetype(total));
+    quint8* out = reinterpret_cast<quint8*>(arena.data());
+    const quint8* in = reinterpret_cast<const quint8*>(doc.arena().constData());
+    WorkStealingPool::global().parallelFor(0, n, kChunk, [&](int i0, int i1) {
+        if (cancel && cancel->load()) return;
+        FC_TRACE_SCOPE("GlyphBatch::chunk");
+        QVarLengthArray<quint8, 512> scratch;
+        for (int i = i0; i < i1; ++i) {
+            if (owner[i] != i) continue;
+            const GlyphEntry& s = old[i];
+            const GlyphEntry& d = entries[i];
+            const Kernel& k = kernels[selected[i]];
+            scratch.resize(k.scratchBytes(s.cols));
+            k.run({ in + s.offset, s.bytesPerRow(), s.rows, s.cols },
+                  { out + d.offset, d.bytesPerRow(), d.rows, d.cols }, scratch.data());
+        }
+        if (progress) progress->fetch_add(i1 - i0);
+    });
+    if (cancel && cancel->load()) return fail("отменено");
+
+    // 3) Общие участки отмечаются для assign(), затем склеиваются совпавшие после преобразования.
+    QHash<quint32, int> refs;
+    for (const GlyphEntry& e : entries)
+        ++refs[e.offset];
+    for (GlyphEntry& e : entries)
+        e.flags = refs.value(e.offset) > 1 ? GlyphEntry::kSharedSlot : quint16(0);
+    if (!doc.assign(arena, entries, {}, to))
+        return fail("не удалось собрать шрифт");
+    res.shared = doc.deduplicate();
+    res.arenaBytes = doc.arenaBytes();
+    res.elapsedNs = timer.nsecsElapsed();
+    if (result) *result = res;
+    return true;
+}
+
+} // namespace GlyphBatch
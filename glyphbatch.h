@@ -0,0 +1,85 @@
+// glyphbatch.h
+#pragma once
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+#include <atomic>
+#include "bitplane.h"
+
+class FontDocument;
+
+/**
+ * \brief Преобразование глифа для пакетной обработки.
+ * \details Шаги выполняются за один проход по строкам в таком порядке:
+ *          порог → смена глубины → инверсия → сдвиг → новый размер (верхний левый угол
+ *          сохраняется, как у PixelGridWidget::resizeGridPreserve()). Вдвигаемые сдвигом
+ *          и добавленные размером пиксели — фон. clear даёт пустой глиф итогового размера.
+ */
+struct GlyphTransform {
+    bool invert = false;
+    bool clear  = false;
+    int  shiftX = 0;     ///< px, > 0 — вправо
+    int  shiftY = 0;     ///< строк, > 0 — вниз
+    int  rows   = 0;     ///< новая высота; 0 — прежняя
+    int  cols   = 0;     ///< новая ширина в пикселях; 0 — прежняя
+    int  threshold = 0;  ///< уровень-порог серых глифов: не ниже — полная заливка, ниже — фон; 0 — нет
+    int  depth  = 0;     ///< новая глубина пикселя (GrayDepth); 0 — прежняя
+
+    /** \brief Ничего не меняет ни в одном глифе глубины depth. */
+    bool isIdentity(int depth) const;
+};
+
+/** \brief Итог пакетной обработки шрифта. */
+struct BatchResult {
+    int       glyphs = 0;     ///< глифов преобразовано
+    int       shared = 0;     ///< глифов склеено после преобразования
+    qsizetype arenaBytes = 0; ///< размер новой арены
+    qint64    elapsedNs = 0;
+    QString   error;
+};
+
+/**
+ * \brief Пакетные преобразования многих глифов сразу (сдвиг, инверсия, очистка, размер,
+ *        порог и перепаковка в другую глубину).
+ * \details Ядро работает с сырыми строками MSB-first: строка источника один раз копируется
+ *          в буфер потока (порог, глубина и инверсия — таблицей на байт или на уровень),
+ *          затем переписывается в строку результата со сдвигом в битах. Глифы раздаются
+ *          WorkStealingPool::global() порциями; результат пишется в новый буфер и подменяет
+ *          исходный только в конце, поэтому отмена оставляет глифы нетронутыми.
+ */
+namespace GlyphBatch {
+
+/**
+ * \brief Проверить преобразование для глифов глубины depth.
+ * \return Пустая строка или описание ошибки.
+ */
+QString validate(const GlyphTransform& t, int depth);
+
+/** \brief Преобразовать один глиф глубины depth (в глубину t.depth, если задана); t — после validate(). */
+BitPlane apply(const BitPlane& bits, int depth, const GlyphTransform& t);
+
+/**
+ * \brief Преобразовать список глифов глубины depth параллельно.
+ * \param progress Счётчик обработанных глифов (может быть nullptr).
+ * \param cancel   Флаг отмены (может быть nullptr); при отмене glyphs не меняются.
+ * \return false при отмене или неверном преобразовании (validate()).
+ */
+bool apply(QVector<BitPlane>& glyphs, int depth, const GlyphTransform& t,
+           std::atomic<int>* progress = nullptr, const std::atomic<bool>* cancel = nullptr);
+
+/**
+ * \brief Преобразовать глифы шрифта.
+ * \details Глифы из списка glyphs (пустой — все) преобразуются, остальные копируются; при
+ *          смене глубины (она общая для шрифта) остальные глифы тоже переводятся в неё.
+ *          Участок, общий с глифом вне списка, разделяется, общий только внутри списка —
+ *          преобразуется один раз. Арена собирается заново без мусора, после чего
+ *          одинаковые глифы склеиваются (FontDocument::deduplicate()).
+ * \param progress Счётчик пройденных глифов документа, из glyphCount() (может быть nullptr).
+ * \param cancel   Флаг отмены (может быть nullptr); при отмене документ не меняется.
+ * \return false при ошибке или отмене (причина — в result->error).
+ */
+bool apply(FontDocument& doc, const QVector<int>& glyphs, const GlyphTransform& t,
+           BatchResult* result = nullptr, std::atomic<int>* progress = nullptr,
+           const std::atomic<bool>* cancel = nullptr);
+
+} // namespace GlyphBatch
@@ -0,0 +1,118 @@
+// glyphbatchdialog.cpp
+#include "glyphbatchdialog.h"
+#include "fontrasterizer.h"
+#include "graydepth.h"
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QSpinBox>
+#include <QVBoxLayout>
+
+GlyphBatchDialog::GlyphBatchDialog(int depth, QWidget* parent)
+    : QDialog(parent), m_depth(depth)
+{
+    setWindowTitle("Пакетная обработка глифов");
+    auto *vl = new QVBoxLayout(this);
+    auto *form = new QFormLayout;
+
+    m_leRanges = new QLineEdit(this);
+    m_leRanges->setPlaceholderText("пусто — все глифы");
+    m_leRanges->setToolTip("Диапазоны через запятую: 0x20-0x7E, 0x400-0x4FF, U+2116");
+    form->addRow("Диапазоны кодов:", m_leRanges);
+
+    auto *shiftRow = new QHBoxLayout;
+    m_sbShiftX = new QSpinBox(this);
+    m_sbShiftX->setRange(-4096, 4096);
+    m_sbShiftX->setPrefix("x: ");
+    m_sbShiftX->setToolTip("> 0 — вправо");
+    m_sbShiftY = new QSpinBox(this);
+    m_sbShiftY->setRange(-4096, 4096);
+    m_sbShiftY->setPrefix("y: ");
+    m_sbShiftY->setToolTip("> 0 — вниз (сдвиг базовой линии)");
+    shiftRow->addWidget(m_sbShiftX);
+    shiftRow->addWidget(m_sbShiftY);
+    form->addRow("Сдвиг, px:", shiftRow);
+
+    auto *sizeRow = new QHBoxLayout;
+    m_sbCols = new QSpinBox(this);
+    m_sbCols->setRange(0, 0xFFFF / depth);
+    m_sbCols->setSpecialValueText("ширина прежняя");
+    m_sbRows = new QSpinBox(this);
+    m_sbRows->setRange(0, 0xFFFF);
+    m_sbRows->setSpecialValueText("высота прежняя");
+    sizeRow->addWidget(m_sbCols);
+    sizeRow->addWidget(m_sbRows);
+    form->addRow("Новый размер:", sizeRow);
+
+    m_chkInvert = new QCheckBox("Инвертировать", this);
+    m_chkClear = new QCheckBox("Очистить", this);
+    form->addRow(QString(), m_chkInvert);
+    form->addRow(QString(), m_chkClear);
+
+    // Порог имеет смысл только для уровней серого: 1 бит уже «закрашен/пуст».
+    m_sbThreshold = new QSpinBox(this);
+    m_sbThreshold->setRange(0, GrayDepth::levels(depth) - 1);
+    m_sbThreshold->setSpecialValueText("нет");
+    m_sbThreshold->setToolTip("Уровень не ниже порога — полная заливка, ниже — фон");
+    m_sbThreshold->setEnabled(depth > 1);
+    form->addRow("Порог уровня:", m_sbThreshold);
+
+    m_cbDepth = new QComboBox(this);
+    m_cbDepth->addItem("без изменений", 0);
+    m_cbDepth->addItem("1 бит", 1);
+    m_cbDepth->addItem("2 бита (4 уровня серого)", 2);
+    m_cbDepth->addItem("4 бита (16 уровней серого)", 4);
+    m_cbDepth->setToolTip("Глубина общая для шрифта: переводятся все глифы, не только из диапазонов");
+    form->addRow("Перепаковать в глубину:", m_cbDepth);
+    vl->addLayout(form);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    vl->addWidget(buttons);
+
+    connect(m_chkClear, &QCheckBox::toggled, this, [this](bool on) {
+        m_chkInvert->setEnabled(!on);
+        m_sbThreshold->setEnabled(!on && m_depth > 1);
+    });
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(buttons, &QDialogButtonBox::accepted, this, [this] {
+        GlyphTransform t;
+        QVector<QPair<quint32, quint32>> ranges;
+        QString why;
+        if (!options(t, ranges, &why)) {
+            QMessageBox::warning(this, "Пакетная обработка", why);
+            return;
+        }
+        accept();
+    });
+}
+
+bool GlyphBatchDialog::options(GlyphTransform& t, QVector<QPair<quint32, quint32>>& ranges, QString* why) const {
+    ranges.clear();
+    if (!m_leRanges->text().trimmed().isEmpty()) {
+        bool ok = false;
+        ranges = FontRasterizer::parseRanges(m_leRanges->text(), &ok);
+        if (!ok) {
+            if (why) *why = "Неверный список диапазонов кодов.";
+            return false;
+        }
+    }
+    t = GlyphTransform();
+    t.shiftX    = m_sbShiftX->value();
+    t.shiftY    = m_sbShiftY->value();
+    t.cols      = m_sbCols->value();
+    t.rows      = m_sbRows->value();
+    t.clear     = m_chkClear->isChecked();
+    t.invert    = !t.clear && m_chkInvert->isChecked();
+    t.threshold = t.clear ? 0 : m_sbThreshold->value();
+    t.depth     = m_cbDepth->currentData().toInt();
+    const QString err = GlyphBatch::validate(t, m_depth);
+    if (!err.isEmpty()) {
+        if (why) *why = err;
+        return false;
+    }
+    return true;
+}
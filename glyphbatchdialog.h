@@ -0,0 +1,40 @@
+// glyphbatchdialog.h
+#pragma once
+#include <QDialog>
+#include <QPair>
+#include <QVector>
+#include "glyphbatch.h"
+
+class QCheckBox;
+class QComboBox;
+class QLineEdit;
+class QSpinBox;
+
+/**
+ * \brief Диалог пакетной обработки глифов шрифта: диапазоны кодов, сдвиг, новый размер,
+ *        инверсия, очистка, порог уровней и новая глубина пикселя.
+ */
+class GlyphBatchDialog : public QDialog {
+    Q_OBJECT
+public:
+    /** \param depth Текущая глубина пикселя шрифта (от неё — допустимые пороги). */
+    explicit GlyphBatchDialog(int depth, QWidget* parent = nullptr);
+
+    /**
+     * \brief Собрать параметры; false и сообщение в why при ошибке ввода.
+     * \param ranges Диапазоны кодов [first, last]; пустой список — все глифы.
+     */
+    bool options(GlyphTransform& t, QVector<QPair<quint32, quint32>>& ranges, QString* why = nullptr) const;
+
+private:
+    int        m_depth;
+    QLineEdit* m_leRanges    = nullptr;
+    QSpinBox*  m_sbShiftX    = nullptr;
+    QSpinBox*  m_sbShiftY    = nullptr;
+    QSpinBox*  m_sbRows      = nullptr;
+    QSpinBox*  m_sbCols      = nullptr;
+    QCheckBox* m_chkInvert   = nullptr;
+    QCheckBox* m_chkClear    = nullptr;
+    QSpinBox*  m_sbThreshold = nullptr;
+    QComboBox* m_cbDepth     = nullptr;
+};
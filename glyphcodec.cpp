@@ -0,0 +1,193 @@
+// glyphcodec.cpp
+#include "glyphcodec.h"
+#include "decoders/glyph_decode.h"
+#include <QFile>
+#include <algorithm>
+
+/// \brief Ресурсы статической библиотеки регистрируются явно (вне пространств имён).
+static void initDecoderResources() {
+    Q_INIT_RESOURCE(decoders);
+}
+
+namespace GlyphCodec {
+
+namespace {
+
+// --- RLE (PackBits) ---------------------------------------------------------
+
+QByteArray encodeRle(const quint8* d, int n) {
+    QByteArray out;
+    out.reserve(n + n / 128 + 1);
+    int i = 0;
+    while (i < n) {
+        int run = 1;
+        while (i + run < n && run < 129 && d[i + run] == d[i]) ++run;
+        if (run >= 2) {
+            out.append(char(run + 126));
+            out.append(char(d[i]));
+            i += run;
+            continue;
+        }
+        // Литералы до начала следующей серии из 2+ одинаковых байтов.
+        int lit = 1;
+        while (i + lit < n && lit < 128 && !(i + lit + 1 < n && d[i + lit] == d[i + lit + 1])) ++lit;
+        out.append(char(lit - 1));
+        out.append(reinterpret_cast<const char*>(d + i), lit);
+        i += lit;
+    }
+    return out;
+}
+
+// --- Битовый RLE -----------------------------------------------------------
+
+void putVarint(QByteArray& out, quint64 v) {
+    while (v >= 0x80) {
+        out.append(char(0x80 | (v & 0x7F)));
+        v >>= 7;
+    }
+    out.append(char(v));
+}
+
+QByteArray encodeBitRle(const quint8* d, int n) {
+    QByteArray out;
+    const qint64 total = qint64(n) * 8;
+    qint64 pos = 0;
+    bool ones = false;
+    while (pos < total) {
+        qint64 run = 0;
+        // Полные байты 0x00/0xFF пропускаются целиком.
+        while (pos + run < total) {
+            const qint64 p = pos + run;
+            const quint8 full = ones ? 0xFF : 0x00;
+            if ((p & 7) == 0 && p + 8 <= total && d[p >> 3] == full) { run += 8; continue; }
+            if (bool((d[p >> 3] >> (7 - (p & 7))) & 1) != ones) break;
+            ++run;
+        }
+        pos += run;
+        if (!ones && pos >= total) break; // хвостовые нули не храним
+        putVarint(out, quint64(run));
+        ones = !ones;
+    }
+    return out;
+}
+
+// --- LZ77, окно 255 ----------------------------------------------------------
+
+constexpr int kLzWindow = 255;
+constexpr int kLzMinMatch = 3;
+
+void putLength(QByteArray& out, int v) {
+    while (v >= 255) { out.append(char(255)); v -= 255; }
+    out.append(char(v));
+}
+
+void putSequence(QByteArray& out, const quint8* lit, int litLen, int offset, int matchLen) {
+    const int l = std::min(litLen, 15);
+    const int m = matchLen ? std::min(matchLen - kLzMinMatch, 15) : 0;
+    out.append(char((l << 4) | m));
+    if (l == 15) putLength(out, litLen - 15);
+    out.append(reinterpret_cast<const char*>(lit), litLen);
+    if (matchLen) {
+        out.append(char(offset));
+        if (m == 15) putLength(out, matchLen - kLzMinMatch - 15);
+    }
+}
+
+QByteArray encodeLz(const quint8* d, int n) {
+    QByteArray out;
+    out.reserve(n / 2 + 16);
+    int litStart = 0;
+    int i = 0;
+    while (i < n) {
+        int bestLen = 0, bestOff = 0;
+        for (int j = std::max(0, i - kLzWindow); j < i; ++j) {
+            int len = 0;
+            while (i + len < n && d[j + len] == d[i + len]) ++len;
+            if (len > bestLen) { bestLen = len; bestOff = i - j; }
+        }
+        if (bestLen >= kLzMinMatch) {
+            putSequence(out, d + litStart, i - litStart, bestOff, bestLen);
+            i += bestLen;
+            litStart = i;
+        } else {
+            ++i;
+        }
+    }
+    if (litStart < n)
+        putSequence(out, d + litStart, n - litStart, 0, 0);
+    return out;
+}
+
+} // namespace
+
+QString name(GlyphCodecKind kind) {
+    switch (kind) {
+    case GlyphCodecKind::Raw:    return "raw";
+    case GlyphCodecKind::Rle:    return "rle";
+    case GlyphCodecKind::BitRle: return "bitrle";
+    case GlyphCodecKind::Lz:     return "lz";
+    }
+    return {};
+}
+
+GlyphCodecKind fromName(const QString& n, bool* ok) {
+    const QString s = n.trimmed().toLower();
+    if (ok) *ok = true;
+    if (s == "rle")    return GlyphCodecKind::Rle;
+    if (s == "bitrle") return GlyphCodecKind::BitRle;
+    if (s == "lz")     return GlyphCodecKind::Lz;
+    if (ok) *ok = (s == "raw");
+    return GlyphCodecKind::Raw;
+}
+
+QStringList names() {
+    return { "raw", "rle", "bitrle", "lz" };
+}
+
+QByteArray encode(GlyphCodecKind kind, const quint8* data, int n) {
+    switch (kind) {
+    case GlyphCodecKind::Raw:    return QByteArray(reinterpret_cast<const char*>(data), n);
+    case GlyphCodecKind::Rle:    return encodeRle(data, n);
+    case GlyphCodecKind::BitRle: return encodeBitRle(data, n);
+    case GlyphCodecKind::Lz:     return encodeLz(data, n);
+    }
+    return {};
+}
+
+bool decode(GlyphCodecKind kind, const quint8* src, int srcLen, quint8* dst, int dstLen) {
+    size_t got = 0;
+    switch (kind) {
+    case GlyphCodecKind::Raw:
+        if (srcLen < dstLen) return false;
+        std::copy(src, src + dstLen, dst);
+        return true;
+    case GlyphCodecKind::Rle:    got = gd_rle_decode(src, size_t(srcLen), dst, size_t(dstLen)); break;
+    case GlyphCodecKind::BitRle: got = gd_bitrle_decode(src, size_t(srcLen), dst, size_t(dstLen)); break;
+    case GlyphCodecKind::Lz:     got = gd_lz_decode(src, size_t(srcLen), dst, size_t(dstLen)); break;
+    }
+    return got == size_t(dstLen);
+}
+
+QString decoderFunction(GlyphCodecKind kind) {
+    return kind == GlyphCodecKind::Raw ? QString() : QString("gd_%1_decode").arg(name(kind));
+}
+
+namespace {
+QString resourceSource(const QString& stem) {
+    initDecoderResources();
+    QFile f(QString(":/decoders/gd_%1.c").arg(stem));
+    if (!f.open(QIODevice::ReadOnly)) return {};
+    return QString::fromUtf8(f.readAll());
+}
+} // namespace
+
+QString decoderSource(GlyphCodecKind kind) {
+    if (kind == GlyphCodecKind::Raw) return {};
+    return resourceSource(name(kind));
+}
+
+QString bitstreamSource() {
+    return resourceSource(QStringLiteral("bitstream"));
+}
+
+} // namespace GlyphCodec
@@ -0,0 +1,47 @@
+// glyphcodec.h
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+
+/** \brief Схема сжатия данных глифа. */
+enum class GlyphCodecKind {
+    Raw,    ///< без сжатия
+    Rle,    ///< байтовый RLE (PackBits)
+    BitRle, ///< серии одинаковых битов, длины — varint
+    Lz      ///< LZ77 с окном 255 байт
+};
+
+/**
+ * \brief Кодеры сжатых глифов и соответствующие им C-декодеры.
+ * \details Каждый глиф сжимается отдельно (произвольный доступ при отрисовке).
+ *          Декодеры — переносимый C из decoders/: хост собирает и вызывает те же файлы,
+ *          что вставляются в экспорт (они же лежат в ресурсах :/decoders), так что
+ *          проверка "сжать → распаковать" идёт ровно тем кодом, что попадёт на МК.
+ */
+namespace GlyphCodec {
+
+/// \name Имена схем
+/// @{
+QString name(GlyphCodecKind kind);           ///< "raw", "rle", "bitrle", "lz"
+GlyphCodecKind fromName(const QString& name, bool* ok = nullptr);
+QStringList names();
+/// @}
+
+/** \brief Сжать n байт глифа. */
+QByteArray encode(GlyphCodecKind kind, const quint8* data, int n);
+
+/** \brief Распаковать ровно dstLen байт; false, если поток повреждён или короче. */
+bool decode(GlyphCodecKind kind, const quint8* src, int srcLen, quint8* dst, int dstLen);
+
+/** \brief Имя функции-декодера в C ("gd_rle_decode"); пусто для Raw. */
+QString decoderFunction(GlyphCodecKind kind);
+
+/** \brief Исходник C-декодера схемы (из ресурсов); пусто для Raw. */
+QString decoderSource(GlyphCodecKind kind);
+
+/** \brief Исходник C-читателя плотного потока бит (gd_bitstream.c, см. BitStream). */
+QString bitstreamSource();
+
+} // namespace GlyphCodec
@@ -0,0 +1,58 @@
+// glyphdedup.cpp
+#include "glyphdedup.h"
+#include <cstring>
+
+namespace {
+
+constexpr quint64 kMul1 = 0x9E3779B97F4A7C15ull;
+constexpr quint64 kMul2 = 0xC2B2AE3D27D4EB4Full;
+
+inline quint64 rotl(quint64 x, int r) { return (x << r) | (x >> (64 - r)); }
+
+/// \brief Финальное перемешивание (splitmix64): каждый бит входа влияет на все биты хэша.
+inline quint64 avalanche(quint64 h) {
+    h ^= h >> 30; h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 27; h *= 0x94D049BB133111EBull;
+    return h ^ (h >> 31);
+}
+
+} // namespace
+
+DedupIndex::DedupIndex(int expected) {
+    if (expected > 0) {
+        m_head.reserve(expected);
+        m_slots.reserve(expected);
+    }
+}
+
+/** \brief Хэш по 8-байтовым словам; хвост дополняется нулями, длина входит в затравку. */
+quint64 DedupIndex::hash(const quint8* data, qsizetype size) {
+    quint64 h = kMul1 ^ quint64(size);
+    qsizetype i = 0;
+    for (; i + 8 <= size; i += 8) {
+        quint64 v;
+        std::memcpy(&v, data + i, 8);
+        h = rotl(h ^ (v * kMul2), 31) * kMul1;
+    }
+    if (i < size) {
+        quint64 v = 0;
+        std::memcpy(&v, data + i, size_t(size - i));
+        h = rotl(h ^ (v * kMul2), 31) * kMul1;
+    }
+    return avalanche(h);
+}
+
+int DedupIndex::findOrInsert(const quint8* data, qsizetype size, int id) {
+    const quint64 h = hash(data, size);
+    auto it = m_head.find(h);
+    const int head = it != m_head.end() ? it.value() : -1;
+    for (int s = head; s >= 0; s = m_slots[s].next) {
+        const Slot& slot = m_slots[s];
+        if (slot.size == size && std::memcmp(slot.data, data, size_t(size)) == 0)
+            return slot.id;
+    }
+    m_slots.append({ data, size, id, head });
+    if (it != m_head.end()) it.value() = int(m_slots.size()) - 1;
+    else m_head.insert(h, int(m_slots.size()) - 1);
+    return id;
+}
@@ -0,0 +1,41 @@
+// glyphdedup.h
+#pragma once
+#include <QHash>
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * \brief Хэш-индекс одинаковых блоков байтов (битмапов глифов).
+ * \details Ключ — 64-битный хэш содержимого (по словам, с перемешиванием в конце); при
+ *          совпадении хэша блоки сравниваются memcmp, поэтому коллизии не склеивают разные
+ *          глифы. Поиск и вставка — O(1) в среднем плюс O(размер блока) на хэш и сравнение.
+ *
+ *          Индекс хранит только указатели: данные должны жить, пока индекс используется.
+ */
+class DedupIndex {
+public:
+    explicit DedupIndex(int expected = 0);
+
+    /**
+     * \brief Найти блок, равный [data, data + size), или запомнить его под номером id.
+     * \return id первого такого блока (равен id, если блок новый).
+     */
+    int findOrInsert(const quint8* data, qsizetype size, int id);
+
+    /** \brief Число различных блоков. */
+    int uniqueCount() const { return int(m_slots.size()); }
+
+    /** \brief Хэш содержимого блока. */
+    static quint64 hash(const quint8* data, qsizetype size);
+
+private:
+    struct Slot {
+        const quint8* data;
+        qsizetype     size;
+        int           id;
+        int           next; ///< следующий слот с тем же хэшем или -1
+    };
+
+    QHash<quint64, int> m_head; ///< хэш → первый слот цепочки
+    QVector<Slot>       m_slots;
+};
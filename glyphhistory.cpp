@@ -0,0 +1,220 @@
+// glyphhistory.cpp
+#include "glyphhistory.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+/// Коды операций дельты: (count << 2) | op.
+enum : quint32 { OpSkip = 0, OpLiteral = 1, OpRepeat = 2 };
+
+void putVarint(QByteArray& out, quint32 v) {
+    while (v >= 0x80) {
+        out.append(char((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.append(char(v));
+}
+
+quint32 getVarint(const uchar*& p) {
+    quint32 v = 0;
+    int shift = 0;
+    for (;;) {
+        const uchar b = *p++;
+        v |= quint32(b & 0x7F) << shift;
+        if (!(b & 0x80)) return v;
+        shift += 7;
+    }
+}
+
+/// \brief Строка дельты: серии (нулевых слов, литеральных слов) до конца строки.
+void putRow(QByteArray& out, const quint64* x, int wpr) {
+    int w = 0;
+    while (w < wpr) {
+        int z = 0;
+        while (w + z < wpr && x[w + z] == 0) ++z;
+        int l = 0;
+        while (w + z + l < wpr && x[w + z + l] != 0) ++l;
+        putVarint(out, quint32(z));
+        putVarint(out, quint32(l));
+        out.append(reinterpret_cast<const char*>(x + w + z), l * int(sizeof(quint64)));
+        w += z + l;
+    }
+}
+
+/// \brief XOR закодированной строки в row; возвращает указатель за концом записи.
+const uchar* xorRow(const uchar* p, quint64* row, int wpr) {
+    int w = 0;
+    while (w < wpr) {
+        w += int(getVarint(p));
+        const int l = int(getVarint(p));
+        for (int i = 0; i < l; ++i, ++w, p += sizeof(quint64)) {
+            quint64 v;
+            std::memcpy(&v, p, sizeof v);
+            row[w] ^= v;
+        }
+    }
+    return p;
+}
+
+} // namespace
+
+GlyphHistory::GlyphHistory(qsizetype budgetBytes) : m_budget(budgetBytes) {}
+
+void GlyphHistory::setBudget(qsizetype bytes) {
+    m_budget = std::max<qsizetype>(0, bytes);
+    trim();
+}
+
+void GlyphHistory::clear() {
+    m_undo.clear();
+    m_redo.clear();
+    m_used = 0;
+    m_depth = 0;
+    m_before = BitPlane();
+}
+
+/** \brief Построчное RLE-кодирование a XOR b (b == nullptr — кодируется сама a). */
+QByteArray GlyphHistory::encode(const BitPlane& a, const BitPlane* b) {
+    QByteArray out;
+    const int wpr = a.wordsPerRow();
+    std::vector<quint64> cur(static_cast<size_t>(wpr));
+    std::vector<quint64> last;
+    quint32 skip = 0, repeat = 0;
+
+    auto flush = [&] {
+        if (skip)   { putVarint(out, (skip << 2) | OpSkip);     skip = 0; }
+        if (repeat) { putVarint(out, (repeat << 2) | OpRepeat); repeat = 0; }
+    };
+
+    for (int r = 0; r < a.rows(); ++r) {
+        const quint64* ra = a.rowWords(r);
+        const quint64* rb = b ? b->rowWords(r) : nullptr;
+        bool any = false;
+        for (int w = 0; w < wpr; ++w) {
+            cur[size_t(w)] = rb ? (ra[w] ^ rb[w]) : ra[w];
+            any |= cur[size_t(w)] != 0;
+        }
+        if (!any) {
+            if (repeat) flush();
+            ++skip;
+            continue;
+        }
+        if (!last.empty() && last == cur) {
+            if (skip) flush();
+            ++repeat;
+            continue;
+        }
+        flush();
+        putVarint(out, (1u << 2) | OpLiteral);
+        putRow(out, cur.data(), wpr);
+        last = cur;
+    }
+    // Хвостовой пропуск строк не пишем: декодер остановится на конце данных.
+    skip = 0;
+    flush();
+    out.squeeze();
+    return out;
+}
+
+void GlyphHistory::apply(const QByteArray& delta, BitPlane& bits) {
+    const uchar* p   = reinterpret_cast<const uchar*>(delta.constData());
+    const uchar* end = p + delta.size();
+    const uchar* lastRow = nullptr;
+    const int wpr = bits.wordsPerRow();
+    int r = 0;
+
+    while (p < end && r < bits.rows()) {
+        const quint32 tag = getVarint(p);
+        const quint32 count = tag >> 2;
+        switch (tag & 3) {
+        case OpSkip:
+            r += int(count);
+            break;
+        case OpLiteral:
+            lastRow = p;
+            p = xorRow(p, bits.rowWords(r++), wpr);
+            break;
+        case OpRepeat:
+            for (quint32 i = 0; i < count && r < bits.rows() && lastRow; ++i)
+                xorRow(lastRow, bits.rowWords(r++), wpr);
+            break;
+        default:
+            return; // повреждённые данные
+        }
+    }
+}
+
+void GlyphHistory::begin(const BitPlane& before) {
+    if (m_depth++ == 0)
+        m_before = before; // разделяемая копия, данные копируются только при записи в сетку
+}
+
+bool GlyphHistory::commit(const BitPlane& after) {
+    if (m_depth == 0 || --m_depth > 0)
+        return false;
+
+    const BitPlane before = m_before;
+    m_before = BitPlane();
+    if (before == after)
+        return false;
+
+    Step s;
+    s.rowsBefore = before.rows(); s.colsBefore = before.cols();
+    s.rowsAfter  = after.rows();  s.colsAfter  = after.cols();
+    if (s.resizes()) {
+        s.delta = encode(before, nullptr);
+        s.after = encode(after, nullptr);
+    } else {
+        s.delta = encode(after, &before);
+    }
+    push(std::move(s));
+    return true;
+}
+
+void GlyphHistory::push(Step&& s) {
+    for (const Step& r : m_redo)
+        m_used -= r.bytes();
+    m_redo.clear();
+
+    m_used += s.bytes();
+    m_undo.append(std::move(s));
+    trim();
+}
+
+/** \brief Удалить самые старые шаги, пока история не влезет в бюджет (последний шаг держим всегда). */
+void GlyphHistory::trim() {
+    int drop = 0;
+    while (m_used > m_budget && drop < m_undo.size() - 1)
+        m_used -= m_undo[drop++].bytes();
+    if (drop)
+        m_undo.remove(0, drop);
+    while (m_used > m_budget && !m_redo.isEmpty()) {
+        m_used -= m_redo.first().bytes();
+        m_redo.removeFirst();
+    }
+}
+
+bool GlyphHistory::undo(BitPlane& bits) {
+    if (m_undo.isEmpty() || isOpen()) return false;
+    Step s = m_undo.takeLast();
+    if (s.resizes())
+        bits.reset(s.rowsBefore, s.colsBefore); // "до" закодировано как XOR с пустой плоскостью
+    apply(s.delta, bits);
+    m_redo.append(std::move(s));
+    return true;
+}
+
+bool GlyphHistory::redo(BitPlane& bits) {
+    if (m_redo.isEmpty() || isOpen()) return false;
+    Step s = m_redo.takeLast();
+    if (s.resizes()) {
+        bits.reset(s.rowsAfter, s.colsAfter);
+        apply(s.after, bits);
+    } else {
+        apply(s.delta, bits);
+    }
+    m_undo.append(std::move(s));
+    return true;
+}
@@ -0,0 +1,87 @@
+// glyphhistory.h
+#pragma once
+#include <QByteArray>
+#include <QVector>
+#include <QtGlobal>
+#include "bitplane.h"
+
+/**
+ * \brief История правок глифа (undo/redo) на сжатых XOR-дельтах.
+ * \details Шаг истории — XOR состояний "до" и "после", закодированный построчно:
+ *          неизменённые строки пропускаются счётчиком, одинаковые подряд строки
+ *          дельты хранятся один раз с числом повторов, а внутри строки слова
+ *          кодируются как серии нулей/литералов. Инверсия 1024×1024 занимает
+ *          одну строку дельты, штрих мышью — несколько слов.
+ *
+ *          Если размер сетки изменился, шаг хранит оба состояния, закодированных
+ *          тем же способом (как XOR с пустой плоскостью).
+ *
+ *          begin()/commit() вкладываются: шаг фиксируется при закрытии внешней пары,
+ *          поэтому весь штрих мышью или импорт с изменением размера — одна запись.
+ *          При превышении бюджета памяти удаляются самые старые шаги.
+ */
+class GlyphHistory {
+public:
+    explicit GlyphHistory(qsizetype budgetBytes = 4 * 1024 * 1024);
+
+    /// \name Бюджет памяти
+    /// @{
+    void setBudget(qsizetype bytes);
+    qsizetype budget() const { return m_budget; }
+    /** \brief Память, занятая закодированными шагами, байты. */
+    qsizetype memoryUsed() const { return m_used; }
+    /// @}
+
+    /// \name Запись шагов
+    /// @{
+    /** \brief Открыть правку (или вложиться в уже открытую). */
+    void begin(const BitPlane& before);
+    /**
+     * \brief Закрыть правку; на внешнем уровне кодирует дельту.
+     * \return true, если в историю добавлен новый шаг.
+     */
+    bool commit(const BitPlane& after);
+    bool isOpen() const { return m_depth > 0; }
+    /// @}
+
+    /// \name Отмена/повтор
+    /// @{
+    bool canUndo() const { return !m_undo.isEmpty(); }
+    bool canRedo() const { return !m_redo.isEmpty(); }
+    int  undoCount() const { return int(m_undo.size()); }
+    int  redoCount() const { return int(m_redo.size()); }
+    /** \brief Откатить последний шаг в bits. */
+    bool undo(BitPlane& bits);
+    /** \brief Повторить отменённый шаг в bits. */
+    bool redo(BitPlane& bits);
+    /// @}
+
+    void clear();
+
+private:
+    struct Step {
+        int rowsBefore = 0, colsBefore = 0;
+        int rowsAfter  = 0, colsAfter  = 0;
+        QByteArray delta;   ///< XOR-дельта (размер не менялся) или состояние "до"
+        QByteArray after;   ///< состояние "после" (только при смене размера)
+
+        bool resizes() const { return rowsBefore != rowsAfter || colsBefore != colsAfter; }
+        qsizetype bytes() const { return delta.size() + after.size() + qsizetype(sizeof(Step)); }
+    };
+
+    /// \brief Закодировать a XOR b (b может быть пустой — тогда кодируется a).
+    static QByteArray encode(const BitPlane& a, const BitPlane* b);
+    /// \brief Применить закодированную дельту к bits (XOR на месте).
+    static void apply(const QByteArray& delta, BitPlane& bits);
+
+    void push(Step&& s);
+    void trim();
+
+    qsizetype     m_budget;
+    qsizetype     m_used = 0;
+    QVector<Step> m_undo;
+    QVector<Step> m_redo;
+
+    int      m_depth = 0;
+    BitPlane m_before;
+};
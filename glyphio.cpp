@@ -0,0 +1,423 @@
+// glyphio.cpp
+#include "glyphio.h"
+#include "bytelexer.h"
+#include "graydepth.h"
+#include "hexwriter.h"
+#include "trace.h"
+#include "workstealingpool.h"
+#include <QFile>
+#include <algorithm>
+#include <cstring>
+
+#ifdef FONTCREATOR_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace GlyphIO {
+
+QVector<quint8> parseBytes(const QString& text) {
+    FC_TRACE_OPERATION("GlyphIO::parseBytes");
+    return ByteLexer::parse(text);
+}
+
+QVector<quint8> parseBytesUtf8(const QByteArray& utf8) {
+    FC_TRACE_OPERATION("GlyphIO::parseBytesUtf8");
+    return ByteLexer::parseUtf8(utf8);
+}
+
+bool parseFile(const QString& path, QVector<quint8>& out,
+               std::atomic<int>* progressKb, const std::atomic<bool>* cancel) {
+    constexpr qint64 kChunk = 1 << 20;
+    out.clear();
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return false;
+
+    ByteLexer lx;
+    lx.reserve(f.size() / 6);
+    auto step = [&](const char* p, qint64 n) {
+        lx.feed(p, n);
+        if (progressKb) progressKb->fetch_add(int(n >> 10));
+        return !(cancel && cancel->load());
+    };
+
+    bool done = true;
+    const qint64 size = f.size();
+    if (const uchar* map = size > 0 ? f.map(0, size) : nullptr) {
+        const char* p = reinterpret_cast<const char*>(map);
+        for (qint64 off = 0; off < size && done; off += kChunk)
+            done = step(p + off, std::min(kChunk, size - off));
+        f.unmap(const_cast<uchar*>(map));
+    } else {
+        QByteArray chunk(int(kChunk), Qt::Uninitialized);
+        qint64 n = 0;
+        while (done && (n = f.read(chunk.data(), kChunk)) > 0)
+            done = step(chunk.constData(), n);
+    }
+    if (!done) return false;
+
+    lx.finish();
+    out = lx.takeBytes();
+    return true;
+}
+
+QVector<quint8> exportBytes(const BitPlane& bits, const PackFormat& f) {
+    return BitPacker::pack(bits, f);
+}
+
+QVector<quint8> exportLevels(const BitPlane& bits, int depth, bool msbFirst) {
+    // Строки плоскости уже упакованы по depth бит на пиксель: остаётся порядок пикселей.
+    QVector<quint8> out = BitPacker::pack(bits, { PackLayout::RowMajor, true });
+    if (!msbFirst)
+        GrayDepth::reversePixels(out.data(), out.size(), depth);
+    return out;
+}
+
+QString formatHexList(const QVector<quint8>& bytes) {
+    HexWriter w;
+    w.reserve(HexWriter::hexListSize(bytes.size()));
+    w.putHexList(bytes.constData(), bytes.size());
+    return w.takeText();
+}
+
+QString formatPyList(const QVector<quint8>& bytes) {
+    HexWriter w;
+    w.reserve(HexWriter::hexListSize(bytes.size()) + 2);
+    w.put('[');
+    w.putHexList(bytes.constData(), bytes.size());
+    w.put(']');
+    return w.takeText();
+}
+
+QString bytesToEscapedHex(const QByteArray& bytes) {
+    static const char digits[] = "0123456789ABCDEF";
+    QString out(bytes.size() * 4, Qt::Uninitialized);
+    QChar* p = out.data();
+    for (unsigned char b : bytes) {
+        p[0] = QLatin1Char('\\');   // \x остаётся нижним, цифры — верхние
+        p[1] = QLatin1Char('x');
+        p[2] = QLatin1Char(digits[b >> 4]);
+        p[3] = QLatin1Char(digits[b & 15]);
+        p += 4;
+    }
+    return out;
+}
+
+namespace {
+
+inline int hexDigit(char16_t c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+} // namespace
+
+/**
+ * \details Однопроходный разбор без регулярных выражений. Результат тот же, что у
+ *          глобального поиска \\x([0-9A-F]{2})|0x([0-9A-F]{2})|([0-9A-F]{2}) без учёта
+ *          регистра: в каждой позиции альтернативы пробуются по порядку, после совпадения
+ *          поиск продолжается за ним.
+ */
+QByteArray parseHexString(const QString& s) {
+    QByteArray res;
+    res.reserve(s.size() / 2);
+    const QChar* p = s.constData();
+    const qsizetype n = s.size();
+    auto pair = [p, n](qsizetype i) {
+        if (i + 1 >= n) return -1;
+        const int hi = hexDigit(p[i].unicode()), lo = hexDigit(p[i + 1].unicode());
+        return hi < 0 || lo < 0 ? -1 : hi << 4 | lo;
+    };
+    for (qsizetype i = 0; i < n;) {
+        const char16_t c = p[i].unicode();
+        if ((c == '\\' || c == '0') && i + 1 < n && (p[i + 1] == QLatin1Char('x') || p[i + 1] == QLatin1Char('X'))) {
+            const int v = pair(i + 2);
+            if (v >= 0) {
+                res.append(char(v));
+                i += 4;
+                continue;
+            }
+        }
+        const int v = pair(i);
+        if (v >= 0) {
+            res.append(char(v));
+            i += 2;
+        } else {
+            ++i;
+        }
+    }
+    return res;
+}
+
+QString exportCWithAscii(const BitPlane& bits, const PackFormat& f) {
+    HexWriter w;
+    w.reserve(HexWriter::cGlyphSize(bits.rows(), bits.cols(), f));
+    w.putCGlyph(bits, f);
+    return w.takeText();
+}
+
+QString exportCWithAscii(const BitPlane& bits, int depth, const PackFormat& f) {
+    if (depth <= 1) return exportCWithAscii(bits, f);
+    HexWriter w;
+    w.reserve(HexWriter::cRowsSize(bits.rows(), bits.cols()));
+    w.putCLevels(bits, depth, f.msbFirst);
+    return w.takeText();
+}
+
+QImage toImage(const BitPlane& bits) {
+    if (bits.isEmpty()) return {};
+    // Строки BitPlane — MSB-first байты с шагом, кратным 8: ровно раскладка Format_Mono.
+    // Изображение держит свою ссылку на общий буфер; запись в QImage его отсоединит.
+    auto* keep = new QVector<quint64>(bits.words());
+    QImage img(reinterpret_cast<const uchar*>(keep->constData()), bits.cols(), bits.rows(),
+               bits.strideBytes(), QImage::Format_Mono,
+               [](void* p) { delete static_cast<QVector<quint64>*>(p); }, keep);
+    img.setColorTable({ qRgb(255, 255, 255), qRgb(0, 0, 0) });
+    return img;
+}
+
+QImage renderNearest(const BitPlane& bits, int cell, int shrink, const QRect& target) {
+    if (target.isEmpty() || cell <= 0 || shrink <= 0) return {};
+    QImage img(target.size(), QImage::Format_Mono);
+    img.setColorTable({ qRgb(255, 255, 255), qRgb(0, 0, 0) });
+    img.fill(0);
+
+    // Столбец источника для каждого столбца результата (-1 — за плоскостью).
+    const int w = target.width();
+    QVector<int> srcCol(w);
+    for (int x = 0; x < w; ++x) {
+        const qint64 c = qint64(target.left() + x) * shrink / cell;
+        srcCol[x] = c < bits.cols() ? int(c) : -1;
+    }
+
+    qint64 prevRow = -1;
+    for (int y = 0; y < target.height(); ++y) {
+        uchar* out = img.scanLine(y);
+        const qint64 r = qint64(target.top() + y) * shrink / cell;
+        if (r >= bits.rows()) break;
+        if (r == prevRow) {             // при увеличении соседние строки результата совпадают
+            std::memcpy(out, img.constScanLine(y - 1), size_t(img.bytesPerLine()));
+            continue;
+        }
+        prevRow = r;
+        const uchar* src = bits.rowBytes(int(r));
+        for (int x = 0; x < w; ++x) {
+            const int c = srcCol[x];
+            if (c >= 0 && (src[c >> 3] & (0x80u >> (c & 7))))
+                out[x >> 3] |= uchar(0x80u >> (x & 7));
+        }
+    }
+    return img;
+}
+
+QImage toImage(const BitPlane& bits, int depth) {
+    if (depth <= 1) return toImage(bits);
+    const int width = bits.cols() / depth;
+    if (bits.rows() <= 0 || width <= 0) return {};
+    QImage img(width, bits.rows(), QImage::Format_Indexed8);
+    img.setColorTable(GrayDepth::colorTable(depth));
+    for (int r = 0; r < bits.rows(); ++r) {
+        uchar* out = img.scanLine(r);
+        for (int x = 0; x < width; ++x)
+            out[x] = uchar(GrayDepth::level(bits, depth, r, x));
+    }
+    return img;
+}
+
+QImage renderNearest(const BitPlane& bits, int depth, int cell, int shrink, const QRect& target) {
+    if (depth <= 1) return renderNearest(bits, cell, shrink, target);
+    if (target.isEmpty() || cell <= 0 || shrink <= 0) return {};
+    QImage img(target.size(), QImage::Format_Indexed8);
+    img.setColorTable(GrayDepth::colorTable(depth));
+    img.fill(0);
+
+    const int w = target.width(), width = bits.cols() / depth;
+    QVector<int> srcCol(w);
+    for (int x = 0; x < w; ++x) {
+        const qint64 c = qint64(target.left() + x) * shrink / cell;
+        srcCol[x] = c < width ? int(c) : -1;
+    }
+
+    qint64 prevRow = -1;
+    for (int y = 0; y < target.height(); ++y) {
+        uchar* out = img.scanLine(y);
+        const qint64 r = qint64(target.top() + y) * shrink / cell;
+        if (r >= bits.rows()) break;
+        if (r == prevRow) {
+            std::memcpy(out, img.constScanLine(y - 1), size_t(img.bytesPerLine()));
+            continue;
+        }
+        prevRow = r;
+        for (int x = 0; x < w; ++x)
+            if (srcCol[x] >= 0)
+                out[x] = uchar(GrayDepth::level(bits, depth, int(r), srcCol[x]));
+    }
+    return img;
+}
+
+namespace {
+
+/**
+ * \brief Общее ядро упаковки: пиксель чёрный, если gray[x] <= lim[x % 16].
+ * \details SSE2: 16 пикселей за шаг — max/cmpeq дают беззнаковое сравнение,
+ *          movemask собирает биты (LSB — левый пиксель), таблица разворота — в MSB-first.
+ */
+void packRowLimits(const uchar* gray, int width, quint8* dst, const quint8 lim[16], quint8 flip) {
+    int x = 0;
+#ifdef FONTCREATOR_SSE2
+    const quint8* rev = BitPlane::bitReverseTable();
+    const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lim));
+    for (; x + 16 <= width; x += 16) {
+        const __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(gray + x));
+        const __m128i le = _mm_cmpeq_epi8(_mm_max_epu8(v, l), l);
+        const int m = _mm_movemask_epi8(le);
+        *dst++ = rev[m & 0xFF] ^ flip;
+        *dst++ = rev[(m >> 8) & 0xFF] ^ flip;
+    }
+#endif
+    for (; x + 8 <= width; x += 8) {
+        quint8 v = 0;
+        for (int k = 0; k < 8; ++k)
+            v = quint8((v << 1) | (gray[x + k] <= lim[(x + k) & 15] ? 1 : 0));
+        *dst++ = v ^ flip;
+    }
+    if (x < width) {
+        quint8 v = 0;
+        const int n = width - x;
+        for (int k = 0; k < n; ++k)
+            v |= quint8((gray[x + k] <= lim[(x + k) & 15] ? 1 : 0) << (7 - k));
+        *dst = quint8((v ^ flip) & (0xFF << (8 - n)));
+    }
+}
+
+/// \brief Строка без сравнений: все пиксели одного значения (порог 0 или >255).
+void fillRow(int width, quint8* dst, bool on) {
+    const int full = width / 8;
+    std::memset(dst, on ? 0xFF : 0x00, size_t(full));
+    if (width % 8)
+        dst[full] = on ? quint8(0xFF << (8 - width % 8)) : 0;
+}
+
+} // namespace
+
+void packGrayRow(const uchar* gray, int width, quint8* dst, int threshold, bool invert) {
+    if (threshold <= 0 || threshold > 255) {
+        fillRow(width, dst, (threshold > 255) != invert);
+        return;
+    }
+    quint8 lim[16];
+    std::memset(lim, threshold - 1, sizeof(lim));
+    packRowLimits(gray, width, dst, lim, invert ? 0xFF : 0x00);
+}
+
+void packGrayRowPattern(const uchar* gray, int width, quint8* dst, const quint8 thresholds[16], bool invert) {
+    quint8 lim[16];
+    for (int i = 0; i < 16; ++i)
+        lim[i] = quint8(std::max(1, int(thresholds[i])) - 1);
+    packRowLimits(gray, width, dst, lim, invert ? 0xFF : 0x00);
+}
+
+/**
+ * \details Уровень — ⌊((255 − v) · (L − 1) + 127) / 255⌋; деление на 255 без деления:
+ *          ⌊t / 255⌋ = (t + 1 + (t >> 8)) >> 8 при t < 65535. SSE2: 16 пикселей в 16-битных
+ *          полосах, затем уровни сливаются сдвигами по 2 (4 бита) или по 4 (2 бита) в байт.
+ */
+void packGrayRowLevels(const uchar* gray, int width, quint8* dst, int depth, bool invert) {
+    if (depth <= 1) {
+        packGrayRow(gray, width, dst, 128, invert);
+        return;
+    }
+    const int top = GrayDepth::levels(depth) - 1;
+    const int flip = invert ? top : 0;
+    int x = 0;
+#ifdef FONTCREATOR_SSE2
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i ones  = _mm_set1_epi8(char(0xFF));
+    const __m128i scale = _mm_set1_epi16(short(top));
+    const __m128i half  = _mm_set1_epi16(127);
+    const __m128i one   = _mm_set1_epi16(1);
+    const __m128i flipv = _mm_set1_epi8(char(flip));
+    auto quantize = [&](__m128i ink16) {
+        const __m128i t = _mm_add_epi16(_mm_mullo_epi16(ink16, scale), half);
+        return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(t, one), _mm_srli_epi16(t, 8)), 8);
+    };
+    for (; x + 16 <= width; x += 16) {
+        const __m128i ink = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(gray + x)), ones);
+        __m128i lv = _mm_packus_epi16(quantize(_mm_unpacklo_epi8(ink, zero)),
+                                      quantize(_mm_unpackhi_epi8(ink, zero)));
+        lv = _mm_xor_si128(lv, flipv);   // байт i — уровень пикселя x + i
+        if (depth == 4) {
+            const __m128i pair = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(lv, 4), _mm_set1_epi16(0x00F0)),
+                                              _mm_srli_epi16(lv, 8));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(pair, zero));
+            dst += 8;
+        } else {
+            const __m128i pair = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(lv, 2), _mm_set1_epi16(0x000C)),
+                                              _mm_srli_epi16(lv, 8));
+            const __m128i quad = _mm_or_si128(_mm_and_si128(_mm_slli_epi32(pair, 4), _mm_set1_epi32(0xF0)),
+                                              _mm_srli_epi32(pair, 16));
+            const int packed = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(quad, zero), zero));
+            std::memcpy(dst, &packed, 4);
+            dst += 4;
+        }
+    }
+#endif
+    const int per = 8 / depth;
+    for (; x < width; ++x) {
+        const int t = (255 - gray[x]) * top + 127;
+        const int v = ((t + 1 + (t >> 8)) >> 8) ^ flip;
+        const int k = x % per;
+        if (k == 0) *dst = 0;
+        *dst |= quint8(v << (8 - depth * (k + 1)));
+        if (k == per - 1) ++dst;
+    }
+}
+
+void imageToLevels(const QImage& src, BitPlane& dst, int depth, bool invert) {
+    dst.fill(false);
+    if (src.isNull() || depth <= 0) return;
+
+    const QImage g = src.convertToFormat(QImage::Format_Grayscale8);
+    const int useW = std::min(dst.cols() / depth, g.width());
+    const int useH = std::min(dst.rows(), g.height());
+    if (useW <= 0 || useH <= 0) return;
+
+    quint8* base = dst.rowBytes(0);
+    const int stride = dst.strideBytes();
+    auto rows = [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y)
+            packGrayRowLevels(g.constScanLine(y), useW, base + qsizetype(y) * stride, depth, invert);
+    };
+    if (qint64(useW) * useH < kParallelPixels) rows(0, useH);
+    else WorkStealingPool::global().parallelFor(0, useH, 64, rows);
+}
+
+void imageToBits(const QImage& src, BitPlane& dst, int threshold, bool invert) {
+    dst.fill(false);
+    if (src.isNull()) return;
+
+    const QImage g = src.convertToFormat(QImage::Format_Grayscale8);
+    const int useW = std::min(dst.cols(), g.width());
+    const int useH = std::min(dst.rows(), g.height());
+    if (useW <= 0 || useH <= 0) return;
+
+    // Строки независимы: большие изображения — параллельно, полосами по 64 строки.
+    quint8* base = dst.rowBytes(0);
+    const int stride = dst.strideBytes();
+    auto rows = [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y)
+            packGrayRow(g.constScanLine(y), useW, base + qsizetype(y) * stride, threshold, invert);
+    };
+    if (qint64(useW) * useH < kParallelPixels) rows(0, useH);
+    else WorkStealingPool::global().parallelFor(0, useH, 64, rows);
+}
+
+BitPlane fromImage(const QImage& src, int threshold, bool invert) {
+    if (src.isNull()) return {};
+    BitPlane bits(src.height(), ((src.width() + 7) / 8) * 8);
+    imageToBits(src, bits, threshold, invert);
+    return bits;
+}
+
+} // namespace GlyphIO
@@ -0,0 +1,144 @@
+// glyphio.h
+#pragma once
+#include <QImage>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include "bitpacker.h"
+#include "bitplane.h"
+
+/**
+ * \brief Преобразования глифов без GUI: разбор текста, экспорт, изображения.
+ * \details Общее ядро для FontCreator и FontCreator-cli. Функции не имеют состояния
+ *          и безопасны для вызова из разных потоков на разных данных.
+ */
+namespace GlyphIO {
+
+/**
+ * \brief Парсер байтов из текста с поддержкой "0x"/"0X" и десятичного формата.
+ * \details Комментарии // и /* *\/ игнорируются. Десятичные числа до 255.
+ *          Однопроходный разбор через ByteLexer; для файлов — parseFile() порциями.
+ */
+QVector<quint8> parseBytes(const QString& text);
+
+/** \brief То же для сырого UTF-8 (без преобразования в QString). */
+QVector<quint8> parseBytesUtf8(const QByteArray& utf8);
+
+/**
+ * \brief Разобрать текстовый файл, не загружая его целиком.
+ * \details Файл отображается в память (QFile::map) и разбирается на месте порциями по 1 МБ;
+ *          если отображение недоступно — читается теми же порциями.
+ * \param progressKb Счётчик разобранных килобайт (может быть nullptr).
+ * \param cancel     Флаг отмены (может быть nullptr); при отмене out пуст.
+ * \return false, если файл не открылся или разбор отменён.
+ */
+bool parseFile(const QString& path, QVector<quint8>& out,
+               std::atomic<int>* progressKb = nullptr, const std::atomic<bool>* cancel = nullptr);
+
+/** \brief Байты плоскости в раскладке f (BitPacker::packedSize() байт). */
+QVector<quint8> exportBytes(const BitPlane& bits, const PackFormat& f);
+
+/**
+ * \brief Байты серого глифа глубины depth (GrayDepth): строки по ⌈ширина · depth / 8⌉ байт.
+ * \details msbFirst — левый пиксель в старших битах байта, иначе в младших (биты уровня
+ *          не переставляются). Для depth = 1 совпадает с exportBytes() в построчной раскладке.
+ */
+QVector<quint8> exportLevels(const BitPlane& bits, int depth, bool msbFirst);
+
+/**
+ * \brief Список "0xFE, 0x07, ..." (0x — нижний регистр, цифры — верхний).
+ * \details Для больших объёмов и записи прямо в файл — HexWriter.
+ */
+QString formatHexList(const QVector<quint8>& bytes);
+
+/** \brief Python-список "[0xFE, 0x07, ...]". */
+QString formatPyList(const QVector<quint8>& bytes);
+
+/** \brief Строка вида \xNN\xNN… (\x — нижний регистр, цифры — верхний). */
+QString bytesToEscapedHex(const QByteArray& bytes);
+
+/** \brief Спарсить строку с \xNN / 0xNN / NN (регистронезависимо для \x/0x). */
+QByteArray parseHexString(const QString& s);
+
+/**
+ * \brief Экспорт в “C + ASCII” (список 0xNN и справа рисунок из '#').
+ * \details Префикс всегда `0x` (нижний регистр), гекс-цифры — верхний регистр.
+ *          Рисунок — только для RowMajor; вертикальные раскладки — строка на страницу/столбец.
+ */
+QString exportCWithAscii(const BitPlane& bits, const PackFormat& f);
+
+/**
+ * \brief “C + ASCII” для серого глифа: байты exportLevels(), рисунок — символ на пиксель
+ *        по яркости уровня (HexWriter::putCLevels). Для depth = 1 — обычный exportCWithAscii().
+ */
+QString exportCWithAscii(const BitPlane& bits, int depth, const PackFormat& f);
+
+/**
+ * \brief Плоскость как 1-битное QImage (Format_Mono, 0 — белый, 1 — чёрный).
+ * \details Без копии: изображение ссылается на буфер плоскости (implicit sharing),
+ *          изменение плоскости после вызова на изображение не влияет.
+ */
+QImage toImage(const BitPlane& bits);
+
+/**
+ * \brief Участок плоскости в масштабе cell/shrink экранных пикселей на пиксель глифа
+ *        (ближайший сосед), как Format_Mono того же вида, что toImage().
+ * \param target Прямоугольник в экранных пикселях всего масштабированного изображения;
+ *               пиксель (x, y) берётся из (y * shrink / cell, x * shrink / cell).
+ * \details Для уменьшенного обзора и плиток крупной сетки: строится только видимая
+ *          часть, без промежуточного полноразмерного изображения. За плоскостью — фон.
+ */
+QImage renderNearest(const BitPlane& bits, int cell, int shrink, const QRect& target);
+
+/**
+ * \brief Серый глиф глубины depth как Format_Indexed8 шириной в пикселях
+ *        (палитра GrayDepth::colorTable(): индекс — уровень). Для depth = 1 — toImage(bits).
+ */
+QImage toImage(const BitPlane& bits, int depth);
+
+/** \brief renderNearest() для серого глифа: Format_Indexed8 с палитрой уровней. */
+QImage renderNearest(const BitPlane& bits, int depth, int cell, int shrink, const QRect& target);
+
+/// \brief С какого числа пикселей imageToBits и Binarizer обрабатывают строки параллельно.
+constexpr qint64 kParallelPixels = 256 * 1024;
+
+/**
+ * \brief Бинаризовать строку Grayscale8 в горизонтальные байты (MSB слева).
+ * \details Пиксель x попадает в бит (7 - x%8) байта x/8; dst — не меньше ceil(width/8) байт,
+ *          лишние биты последнего байта обнуляются. На x86 — SSE2, 16 пикселей за шаг.
+ */
+void packGrayRow(const uchar* gray, int width, quint8* dst, int threshold, bool invert);
+
+/**
+ * \brief То же с порогом по позиции: пиксель x чёрный, если gray[x] < thresholds[x % 16].
+ * \details Для упорядоченного дизеринга (матрица Байера повторяется с периодом 8).
+ *          Пороги — 1..255 (0 трактуется как 1).
+ */
+void packGrayRowPattern(const uchar* gray, int width, quint8* dst, const quint8 thresholds[16], bool invert);
+
+/**
+ * \brief Квантовать строку Grayscale8 в уровни глубины depth (GrayDepth), упакованные MSB-first.
+ * \details Уровень — (255 − яркость) · (L − 1) / 255 с округлением, L = 2^depth; invert
+ *          инвертирует уровень после квантования. dst — не меньше ⌈width · depth / 8⌉ байт,
+ *          лишние биты последнего байта обнуляются. На x86 — SSE2, 16 пикселей за шаг.
+ *          Для depth = 1 совпадает с packGrayRow() при пороге 128.
+ */
+void packGrayRowLevels(const uchar* gray, int width, quint8* dst, int depth, bool invert);
+
+/**
+ * \brief Бинаризовать изображение в существующую плоскость (общая область, остальное — 0).
+ * \param threshold Порог (0..255): <threshold → чёрный пиксель.
+ * \param invert    Инвертировать после бинаризации.
+ */
+void imageToBits(const QImage& src, BitPlane& dst, int threshold = 128, bool invert = false);
+
+/** \brief Бинаризовать изображение в плоскость его размера (ширина кратна 8). */
+BitPlane fromImage(const QImage& src, int threshold = 128, bool invert = false);
+
+/**
+ * \brief Квантовать изображение в уровни глубины depth в существующую плоскость
+ *        (ширина плоскости — пиксели · depth бит; общая область, остальное — 0).
+ */
+void imageToLevels(const QImage& src, BitPlane& dst, int depth, bool invert = false);
+
+} // namespace GlyphIO
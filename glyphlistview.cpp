@@ -0,0 +1,129 @@
+// glyphlistview.cpp
+#include "glyphlistview.h"
+#include "fontdocument.h"
+#include "glyphio.h"
+#include <QImage>
+#include <QPainter>
+#include <QItemSelectionModel>
+#include <algorithm>
+
+namespace {
+constexpr int kThumb = 40;   ///< сторона миниатюры, px
+constexpr int kLabelH = 14;  ///< высота подписи под миниатюрой
+constexpr int kPad = 4;
+}
+
+// ---------------------------------------------------------------- FontGlyphModel
+
+FontGlyphModel::FontGlyphModel(FontDocument* doc, QObject* parent)
+    : QAbstractListModel(parent), m_doc(doc) {}
+
+int FontGlyphModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid() || !m_doc) return 0;
+    return m_doc->glyphCount();
+}
+
+QVariant FontGlyphModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || !m_doc || index.row() >= m_doc->glyphCount())
+        return {};
+    const GlyphEntry& e = m_doc->entry(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        return QStringLiteral("%1").arg(e.codepoint, 4, 16, QLatin1Char('0')).toUpper();
+    case Qt::ToolTipRole:
+        return QStringLiteral("U+%1 '%2', %3×%4")
+            .arg(QString::number(e.codepoint, 16).rightJustified(4, QLatin1Char('0')).toUpper(),
+                 QString::fromUcs4(reinterpret_cast<const char32_t*>(&e.codepoint), 1))
+            .arg(m_doc->glyphWidth(index.row()))
+            .arg(e.rows);
+    default:
+        return {};
+    }
+}
+
+void FontGlyphModel::glyphChanged(int glyphIndex) {
+    const QModelIndex i = index(glyphIndex);
+    emit dataChanged(i, i);
+}
+
+void FontGlyphModel::reload() {
+    beginResetModel();
+    endResetModel();
+}
+
+// ---------------------------------------------------------------- GlyphThumbDelegate
+
+GlyphThumbDelegate::GlyphThumbDelegate(FontGlyphModel* model, QObject* parent)
+    : QStyledItemDelegate(parent), m_model(model) {}
+
+QSize GlyphThumbDelegate::sizeHint(const QStyleOptionViewItem&, const QModelIndex&) const {
+    return { kThumb + 2 * kPad, kThumb + kLabelH + 2 * kPad };
+}
+
+/**
+ * \brief Миниатюра: байты арены → Format_Mono (без копии) → масштабированный drawImage.
+ * \details Серый глиф (depth() > 1) распаковывается в Indexed8 с палитрой уровней.
+ */
+void GlyphThumbDelegate::paint(QPainter* p, const QStyleOptionViewItem& opt, const QModelIndex& index) const {
+    const FontDocument* doc = m_model->document();
+    if (!doc || index.row() >= doc->glyphCount()) return;
+
+    p->save();
+    if (opt.state & QStyle::State_Selected)
+        p->fillRect(opt.rect, opt.palette.highlight());
+
+    const GlyphEntry& e = doc->entry(index.row());
+    const int width = doc->glyphWidth(index.row());
+    QImage img;
+    if (doc->depth() > 1) {
+        img = GlyphIO::toImage(doc->glyph(index.row()), doc->depth());
+    } else {
+        img = QImage(doc->glyphData(index.row()), e.cols, e.rows, e.bytesPerRow(), QImage::Format_Mono);
+        img.setColorTable({ qRgb(255, 255, 255), qRgb(0, 0, 0) });
+    }
+
+    const QRect box(opt.rect.x() + kPad, opt.rect.y() + kPad, kThumb, kThumb);
+    const double k = std::min(double(kThumb) / width, double(kThumb) / e.rows);
+    const QSize sz(std::max(1, int(width * k)), std::max(1, int(e.rows * k)));
+    const QRect target(box.x() + (kThumb - sz.width()) / 2, box.y() + (kThumb - sz.height()) / 2,
+                       sz.width(), sz.height());
+    p->drawImage(target, img);
+    p->setPen(QColor(220, 220, 220));
+    p->drawRect(target.adjusted(0, 0, -1, -1));
+
+    p->setPen(opt.state & QStyle::State_Selected ? opt.palette.highlightedText().color()
+                                                 : opt.palette.text().color());
+    const QRect label(opt.rect.x(), box.bottom() + 1, opt.rect.width(), kLabelH);
+    p->drawText(label, Qt::AlignCenter, index.data(Qt::DisplayRole).toString());
+    p->restore();
+}
+
+// ---------------------------------------------------------------- GlyphListView
+
+GlyphListView::GlyphListView(QWidget* parent) : QListView(parent) {
+    setViewMode(QListView::IconMode);
+    setMovement(QListView::Static);
+    setResizeMode(QListView::Adjust);
+    setUniformItemSizes(true);          // без опроса sizeHint каждого элемента
+    setLayoutMode(QListView::Batched);  // раскладка порциями, UI не замирает
+    setBatchSize(512);
+    setSelectionMode(QAbstractItemView::SingleSelection);
+    setSpacing(2);
+}
+
+void GlyphListView::setGlyphModel(FontGlyphModel* model) {
+    setModel(model);
+    setItemDelegate(new GlyphThumbDelegate(model, this));
+    connect(selectionModel(), &QItemSelectionModel::currentChanged, this,
+            [this](const QModelIndex& cur, const QModelIndex&) {
+                if (cur.isValid()) emit glyphSelected(cur.row());
+            });
+}
+
+void GlyphListView::selectGlyph(int glyphIndex) {
+    if (!model()) return;
+    const QModelIndex i = model()->index(glyphIndex, 0);
+    if (!i.isValid()) return;
+    setCurrentIndex(i);
+    scrollTo(i);
+}
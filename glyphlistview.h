@@ -0,0 +1,66 @@
+// glyphlistview.h
+#pragma once
+#include <QAbstractListModel>
+#include <QListView>
+#include <QStyledItemDelegate>
+
+class FontDocument;
+
+/**
+ * \brief Табличная модель поверх FontDocument для списка глифов.
+ * \details Модель не копирует данные: строки — индексы глифов документа.
+ */
+class FontGlyphModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    explicit FontGlyphModel(FontDocument* doc, QObject* parent = nullptr);
+
+    FontDocument* document() const { return m_doc; }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    /** \brief Сообщить представлению, что битмап глифа изменился. */
+    void glyphChanged(int glyphIndex);
+    /** \brief Полный сброс после изменения состава документа. */
+    void reload();
+
+private:
+    FontDocument* m_doc;
+};
+
+/**
+ * \brief Делегат, рисующий миниатюру глифа прямо из байтов арены.
+ * \details Байты глифа оборачиваются в QImage::Format_Mono без копирования,
+ *          рисуются только видимые элементы (QListView вызывает paint лишь для них).
+ */
+class GlyphThumbDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+public:
+    explicit GlyphThumbDelegate(FontGlyphModel* model, QObject* parent = nullptr);
+
+    void paint(QPainter* p, const QStyleOptionViewItem& opt, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& opt, const QModelIndex& index) const override;
+
+private:
+    FontGlyphModel* m_model;
+};
+
+/**
+ * \brief Виртуализированный список глифов (иконки одинакового размера).
+ * \details uniformItemSizes + пакетная раскладка: стоимость отрисовки зависит
+ *          только от числа видимых миниатюр, а не от размера шрифта.
+ */
+class GlyphListView : public QListView {
+    Q_OBJECT
+public:
+    explicit GlyphListView(QWidget* parent = nullptr);
+
+    void setGlyphModel(FontGlyphModel* model);
+    /** \brief Выделить глиф по индексу документа и прокрутить к нему. */
+    void selectGlyph(int glyphIndex);
+
+signals:
+    /** \brief Пользователь выбрал глиф (индекс в FontDocument). */
+    void glyphSelected(int glyphIndex);
+};
@@ -0,0 +1,148 @@
+// glyphtrim.cpp
+#include "glyphtrim.h"
+#include "bitplane.h"
+#include "fontdocument.h"
+#include "workstealingpool.h"
+#include <QVarLengthArray>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace GlyphTrim {
+
+namespace {
+
+/// \brief Глифов в одной порции параллельной обработки.
+constexpr int kChunk = 256;
+/// \brief С какого объёма данных шрифт обрабатывается параллельно.
+constexpr qsizetype kParallelBytes = 256 * 1024;
+
+} // namespace
+
+QRect bounds(const quint8* data, qsizetype stride, int rows, int cols) {
+    const int bpr = (cols + 7) / 8;
+    if (rows <= 0 || bpr <= 0) return {};
+
+    // Аккумулятор столбцов: OR всех строк, в том же порядке байтов, что и строка.
+    const int words = bpr / 8, rest = bpr % 8;
+    QVarLengthArray<quint64, 16> acc(words + 1);
+    std::fill(acc.begin(), acc.end(), 0);
+    int top = -1, bottom = -1;
+    for (int r = 0; r < rows; ++r) {
+        const quint8* row = data + qsizetype(r) * stride;
+        quint64 any = 0;
+        for (int w = 0; w < words; ++w) {
+            quint64 v;
+            std::memcpy(&v, row + 8 * w, 8);
+            acc[w] |= v;
+            any |= v;
+        }
+        if (rest) {
+            quint64 v = 0;
+            std::memcpy(&v, row + 8 * words, size_t(rest));
+            acc[words] |= v;
+            any |= v;
+        }
+        if (any) {
+            if (top < 0) top = r;
+            bottom = r;
+        }
+    }
+    if (top < 0) return {};
+
+    const quint8* col = reinterpret_cast<const quint8*>(acc.constData());
+    int first = 0, last = bpr - 1;
+    while (!col[first]) ++first;
+    while (!col[last]) --last;
+    const int left  = first * 8 + int(qCountLeadingZeroBits(col[first]));
+    const int right = last * 8 + 7 - int(qCountTrailingZeroBits(col[last]));
+    return QRect(left, top, right - left + 1, bottom - top + 1);
+}
+
+QRect bounds(const BitPlane& bits) {
+    return bits.isEmpty() ? QRect() : bounds(bits.rowBytes(0), bits.strideBytes(), bits.rows(), bits.cols());
+}
+
+void crop(const quint8* data, qsizetype stride, const QRect& box, quint8* dst) {
+    const int w = box.width(), bpr = (w + 7) / 8;
+    const int b0 = box.x() / 8, s = box.x() % 8;
+    const quint8 tail = w % 8 ? quint8(0xFF << (8 - w % 8)) : quint8(0xFF);
+    // Байт src[bpr] нужен последнему байту только при сдвиге и только если он ещё внутри box.
+    const bool lastHasNext = s && b0 + bpr <= (box.x() + w - 1) / 8;
+
+    for (int y = 0; y < box.height(); ++y, dst += bpr) {
+        const quint8* src = data + qsizetype(box.y() + y) * stride + b0;
+        if (s == 0) {
+            std::memcpy(dst, src, size_t(bpr));
+        } else {
+            for (int k = 0; k < bpr - 1; ++k)
+                dst[k] = quint8((src[k] << s) | (src[k + 1] >> (8 - s)));
+            dst[bpr - 1] = quint8((src[bpr - 1] << s) | (lastHasNext ? src[bpr] >> (8 - s) : 0));
+        }
+        dst[bpr - 1] &= tail;
+    }
+}
+
+QByteArray trimFont(const FontDocument& doc, const PackFormat& f, QVector<GlyphMetrics>& metrics) {
+    const int n = doc.glyphCount();
+    metrics.resize(n);
+    QVector<QRect> boxes(n);
+    const bool parallel = doc.usedBytes() >= kParallelBytes;
+    auto run = [&](const std::function<void(int, int)>& fn) {
+        if (parallel) WorkStealingPool::global().parallelFor(0, n, kChunk, fn);
+        else fn(0, n);
+    };
+
+    // 1) Границы и метрики. У серого шрифта рамка расширяется до целых пикселей (depth бит).
+    const int depth = doc.depth();
+    run([&](int i0, int i1) {
+        for (int i = i0; i < i1; ++i) {
+            const GlyphEntry& e = doc.entry(i);
+            QRect box = bounds(doc.glyphData(i), e.bytesPerRow(), e.rows, e.cols);
+            if (depth > 1 && !box.isEmpty()) {
+                box.setLeft(box.left() / depth * depth);
+                box.setRight(box.right() / depth * depth + depth - 1);
+            }
+            GlyphMetrics m;
+            if (!box.isEmpty()) {
+                m.width   = quint16(box.width() / depth);
+                m.height  = quint16(box.height());
+                m.xOffset = qint16(box.x() / depth);
+                m.yOffset = qint16(box.y());
+                m.size    = quint32(BitPacker::packedSize(f, box.height(), box.width()));
+            }
+            const int advance = e.advance ? e.advance : box.isEmpty() ? e.cols / depth : m.xOffset + m.width + 1;
+            m.advance = quint16(std::min(advance, 0xFFFF));
+            boxes[i] = box;
+            metrics[i] = m;
+        }
+    });
+
+    // 2) Смещения.
+    qsizetype total = 0;
+    for (GlyphMetrics& m : metrics) {
+        m.offset = quint32(total);
+        total += m.size;
+    }
+
+    // 3) Вырезка и упаковка: каждый глиф пишет только в свой участок.
+    QByteArray out(total, Qt::Uninitialized);
+    quint8* base = reinterpret_cast<quint8*>(out.data());
+    BitPacker::dispatch(f, [&](auto packer) {
+        run([&](int i0, int i1) {
+            QVarLengthArray<quint8, 1024> scratch;
+            for (int i = i0; i < i1; ++i) {
+                const GlyphMetrics& m = metrics[i];
+                if (!m.size) continue;
+                const int cols = boxes[i].width(), bpr = (cols + 7) / 8;
+                scratch.resize(bpr * m.height);
+                crop(doc.glyphData(i), doc.entry(i).bytesPerRow(), boxes[i], scratch.data());
+                packer.pack(BitPacker::Rows{ scratch.data(), bpr, m.height, cols }, base + m.offset);
+            }
+        });
+    });
+    return out;
+}
+
+} // namespace GlyphTrim
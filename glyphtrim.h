@@ -0,0 +1,63 @@
+// glyphtrim.h
+#pragma once
+#include <QByteArray>
+#include <QRect>
+#include <QVector>
+#include <QtGlobal>
+#include "bitpacker.h"
+
+class BitPlane;
+class FontDocument;
+
+/**
+ * \brief Метрики обрезанного глифа.
+ * \details Битмап width × height лежит в клетке глифа со смещением (xOffset, yOffset)
+ *          от левого верхнего угла; advance — шаг до следующего глифа. У пустого глифа
+ *          (пробел) битмапа нет: width = height = size = 0, остаётся только advance.
+ *          Ширина, смещения и advance — в пикселях; строка серого глифа (FontDocument::depth())
+ *          занимает width · depth бит.
+ */
+struct GlyphMetrics {
+    quint32 offset  = 0;   ///< смещение битмапа в общем буфере, байты
+    quint32 size    = 0;   ///< байты битмапа в выбранной раскладке
+    quint16 width   = 0;
+    quint16 height  = 0;
+    qint16  xOffset = 0;
+    qint16  yOffset = 0;
+    quint16 advance = 0;
+};
+
+/**
+ * \brief Обрезка глифов по содержимому (bounding box) для компактного экспорта.
+ * \details Границы ищутся пословно: строки глифа OR-ятся 64-битными словами в аккумулятор
+ *          столбцов, пустая строка — это нулевое OR её слов; затем крайние столбцы
+ *          находятся по первому/последнему ненулевому байту аккумулятора. Каждый байт
+ *          глифа читается один раз.
+ */
+namespace GlyphTrim {
+
+/**
+ * \brief Границы закрашенных пикселей в строках MSB-first (шаг stride байт).
+ * \return Пустой QRect, если пикселей нет. Биты за cols должны быть нулевыми.
+ */
+QRect bounds(const quint8* data, qsizetype stride, int rows, int cols);
+/** \brief То же для плоскости. */
+QRect bounds(const BitPlane& bits);
+
+/**
+ * \brief Вырезать box из строк MSB-first в dst: box.height() строк по ceil(box.width()/8) байт.
+ * \details Лишние биты последнего байта строки обнуляются.
+ */
+void crop(const quint8* data, qsizetype stride, const QRect& box, quint8* dst);
+
+/**
+ * \brief Обрезать все глифы шрифта и упаковать их подряд в раскладке f.
+ * \details Шаг advance берётся из GlyphEntry::advance; если он не задан — пропорционально:
+ *          правый край битмапа + 1 пиксель (у пустых глифов — ширина клетки).
+ *          Большие шрифты обрабатываются параллельно (WorkStealingPool::global()).
+ * \param metrics Метрики по индексу глифа.
+ * \return Битмапы всех глифов; metrics[i].offset — смещение глифа i.
+ */
+QByteArray trimFont(const FontDocument& doc, const PackFormat& f, QVector<GlyphMetrics>& metrics);
+
+} // namespace GlyphTrim
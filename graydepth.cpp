@@ -0,0 +1,90 @@
+// graydepth.cpp
+#include "graydepth.h"
+#include <algorithm>
+
+namespace GrayDepth {
+
+namespace {
+
+/**
+ * \brief Таблицы на байт для глубины 2 и 4 (индекс 0 — 2 бита, 1 — 4 бита).
+ * \details reverse — пиксели байта в обратном порядке; ink — старшие биты пикселей байта,
+ *          прижатые к старшему краю (8 / depth бит).
+ */
+struct Tables {
+    quint8 reverse[2][256] = {};
+    quint8 ink[2][256] = {};
+    constexpr Tables() {
+        for (int t = 0; t < 2; ++t) {
+            const int depth = t ? 4 : 2, per = 8 / depth, mask = (1 << depth) - 1;
+            for (int v = 0; v < 256; ++v) {
+                int rev = 0, msb = 0;
+                for (int k = 0; k < per; ++k) {
+                    const int px = (v >> (8 - depth * (k + 1))) & mask;   // k-й пиксель слева
+                    rev |= px << (depth * k);
+                    msb |= (px >> (depth - 1)) << (7 - k);
+                }
+                reverse[t][v] = quint8(rev);
+                ink[t][v] = quint8(msb);
+            }
+        }
+    }
+};
+constexpr Tables kTables;
+
+} // namespace
+
+QVector<QRgb> colorTable(int depth) {
+    QVector<QRgb> table(levels(depth));
+    for (int v = 0; v < table.size(); ++v) {
+        const int s = shade(v, depth);
+        table[v] = qRgb(s, s, s);
+    }
+    return table;
+}
+
+BitPlane convert(const BitPlane& bits, int from, int to) {
+    if (from == to || bits.isEmpty()) return from == to ? bits : BitPlane();
+    const int width = bits.cols() / from;
+    BitPlane out(bits.rows(), width * to);
+    // Округление к ближайшему: v · (L' − 1) / (L − 1).
+    const int num = levels(to) - 1, den = levels(from) - 1;
+    int map[16];
+    for (int v = 0; v <= den; ++v)
+        map[v] = (2 * v * num + den) / (2 * den);
+    for (int r = 0; r < bits.rows(); ++r)
+        for (int x = 0; x < width; ++x)
+            if (const int v = map[level(bits, from, r, x)])
+                setLevel(out, to, r, x, v);
+    return out;
+}
+
+void inkRow(const quint8* src, int pixels, int depth, quint8* dst) {
+    const int bytes = (pixels + 7) / 8;
+    if (depth == 1) {
+        std::copy(src, src + bytes, dst);
+    } else {
+        // 8 / depth пикселей на байт источника: 2 или 4 байта источника на байт маски.
+        const quint8* ink = kTables.ink[depth == 4];
+        const int per = 8 / depth, group = depth;
+        const int srcBytes = (pixels * depth + 7) / 8;
+        for (int b = 0; b < bytes; ++b) {
+            int acc = 0;
+            for (int k = 0; k < group; ++k) {
+                const int i = b * group + k;
+                acc = (acc << per) | (i < srcBytes ? ink[src[i]] >> (8 - per) : 0);
+            }
+            dst[b] = quint8(acc);
+        }
+    }
+    if (pixels & 7)
+        dst[bytes - 1] &= quint8(0xFF << (8 - (pixels & 7)));
+}
+
+void reversePixels(quint8* data, qsizetype n, int depth) {
+    const quint8* table = depth == 1 ? BitPlane::bitReverseTable() : kTables.reverse[depth == 4];
+    for (qsizetype i = 0; i < n; ++i)
+        data[i] = table[data[i]];
+}
+
+} // namespace GrayDepth
@@ -0,0 +1,70 @@
+// graydepth.h
+#pragma once
+#include <QImage>
+#include <QVector>
+#include <QtGlobal>
+#include "bitplane.h"
+
+/**
+ * \brief Глифы в оттенках серого (2 и 4 бита на пиксель) поверх BitPlane.
+ * \details Глиф шириной w пикселей глубины depth хранится в плоскости шириной w · depth бит:
+ *          пиксель x занимает биты [x · depth, x · depth + depth) строки, старший бит уровня
+ *          слева. Строка плоскости — это уже упакованная строка экспорта: 4 пикселя на байт
+ *          при 2 битах, 2 — при 4 битах, левый пиксель в старших битах. Уровень 0 — фон,
+ *          levels() − 1 — полная заливка; глубина 1 — обычный одноцветный глиф.
+ *
+ *          Поэтому история правок (XOR-дельты), сдвиги по вертикали, арена документа,
+ *          склейка одинаковых глифов, файл проекта и плотный поток бит работают с серыми
+ *          глифами без изменений, а инверсия всех бит переводит уровень v в levels() − 1 − v.
+ *          Память и объём экспорта растут линейно с глубиной.
+ */
+namespace GrayDepth {
+
+/** \brief Поддерживаемая глубина: 1, 2 или 4 бита на пиксель (пиксель не пересекает байт). */
+inline bool isValid(int depth) { return depth == 1 || depth == 2 || depth == 4; }
+/** \brief Число уровней: 2, 4 или 16. */
+inline int levels(int depth) { return 1 << depth; }
+
+/** \brief Уровень пикселя (r, x). */
+inline int level(const BitPlane& bits, int depth, int r, int x) {
+    const int b = x * depth;
+    return (bits.rowBytes(r)[b >> 3] >> (8 - depth - (b & 7))) & (levels(depth) - 1);
+}
+
+/** \brief Записать уровень пикселя (r, x) (лишние старшие биты v отбрасываются). */
+inline void setLevel(BitPlane& bits, int depth, int r, int x, int v) {
+    const int b = x * depth;
+    const int shift = 8 - depth - (b & 7);
+    const int mask = levels(depth) - 1;
+    uchar& byte = bits.rowBytes(r)[b >> 3];
+    byte = uchar((byte & ~(mask << shift)) | ((v & mask) << shift));
+}
+
+/** \brief Яркость уровня на экране: 255 — фон, 0 — полная заливка. */
+inline int shade(int level, int depth) { return 255 - level * 255 / (levels(depth) - 1); }
+
+/** \brief Палитра Indexed8-изображений глубины depth: индекс — уровень, от белого к чёрному. */
+QVector<QRgb> colorTable(int depth);
+
+/**
+ * \brief Перевести рисунок глубины from в глубину to.
+ * \details Уровни масштабируются с округлением (при переходе в 1 бит — пиксель закрашен,
+ *          если уровень не меньше половины), ширина в пикселях сохраняется.
+ */
+BitPlane convert(const BitPlane& bits, int from, int to);
+
+/**
+ * \brief Одноцветная маска строки: пиксель закрашен, если уровень не меньше половины
+ *        (старший бит уровня).
+ * \param src    Строка глифа: pixels · depth бит.
+ * \param dst    ⌈pixels / 8⌉ байт MSB-first; лишние биты последнего байта обнуляются.
+ */
+void inkRow(const quint8* src, int pixels, int depth, quint8* dst);
+
+/**
+ * \brief Обратный порядок пикселей в каждом байте (порядок «младшие биты первыми»).
+ * \details Биты внутри уровня не переставляются; для глубины 1 — обычный разворот бит.
+ */
+void reversePixels(quint8* data, qsizetype n, int depth);
+
+} // namespace GrayDepth
@@ -0,0 +1,98 @@
+// gridminimap.cpp
+#include "gridminimap.h"
+#include "glyphio.h"
+#include "pixelgridwidget.h"
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollArea>
+#include <QScrollBar>
+#include <algorithm>
+
+namespace {
+/// \brief Наибольшее увеличение маленькой сетки в обзоре, px на пиксель.
+constexpr int kMaxScale = 8;
+}
+
+GridMinimap::GridMinimap(PixelGridWidget* grid, QScrollArea* area, QWidget* parent)
+    : QWidget(parent), m_grid(grid), m_area(area) {
+    setMinimumSize(64, 64);
+    setCursor(Qt::PointingHandCursor);
+    connect(grid, &PixelGridWidget::changed, this, &GridMinimap::refresh);
+    for (QScrollBar* bar : { area->horizontalScrollBar(), area->verticalScrollBar() }) {
+        connect(bar, &QScrollBar::valueChanged, this, qOverload<>(&QWidget::update));
+        connect(bar, &QScrollBar::rangeChanged, this, qOverload<>(&QWidget::update));
+    }
+}
+
+void GridMinimap::refresh() {
+    m_dirty = true;
+    update();
+}
+
+void GridMinimap::resizeEvent(QResizeEvent*) {
+    m_dirty = true;
+}
+
+/** \brief Масштаб «вписать»: cell/shrink = ширина/столбцы или высота/строки, что меньше. */
+void GridMinimap::rebuild() {
+    m_dirty = false;
+    m_image = QImage();
+    m_imageRect = QRect();
+    if (!m_grid) return;
+    const BitPlane& bits = m_grid->bits();
+    const QRect avail = rect().adjusted(2, 2, -2, -2);
+    if (bits.isEmpty() || avail.isEmpty()) return;
+
+    const int cols = m_grid->cols();   // в пикселях (у серого глифа бит в строке больше)
+    int cell = avail.width(), shrink = cols;
+    if (qint64(bits.rows()) * avail.width() > qint64(cols) * avail.height()) {
+        cell = avail.height();
+        shrink = bits.rows();
+    }
+    if (cell > kMaxScale * shrink) {
+        cell = kMaxScale;
+        shrink = 1;
+    }
+    const QSize size(std::max(1, int(qint64(cols) * cell / shrink)),
+                     std::max(1, int(qint64(bits.rows()) * cell / shrink)));
+    m_image = GlyphIO::renderNearest(bits, m_grid->depth(), cell, shrink, QRect(QPoint(), size));
+    m_imageRect = QRect(QPoint(avail.left() + (avail.width() - size.width()) / 2,
+                               avail.top() + (avail.height() - size.height()) / 2), size);
+}
+
+void GridMinimap::paintEvent(QPaintEvent*) {
+    if (m_dirty) rebuild();
+    QPainter p(this);
+    p.fillRect(rect(), palette().window());
+    if (m_image.isNull() || !m_grid || !m_area) return;
+    p.drawImage(m_imageRect.topLeft(), m_image);
+
+    // Видимая часть сетки: смещение полос прокрутки и размер окна области в пикселях сетки.
+    const QSize content = m_grid->contentSize();
+    const QRectF visible = QRectF(m_area->horizontalScrollBar()->value(), m_area->verticalScrollBar()->value(),
+                                  m_area->viewport()->width(), m_area->viewport()->height())
+                           & QRectF(QPointF(), QSizeF(content));
+    const double kx = double(m_imageRect.width()) / std::max(1, content.width());
+    const double ky = double(m_imageRect.height()) / std::max(1, content.height());
+    const QRectF frame(m_imageRect.left() + visible.left() * kx, m_imageRect.top() + visible.top() * ky,
+                       visible.width() * kx, visible.height() * ky);
+    p.setPen(QPen(QColor(220, 40, 40), 1));
+    p.drawRect(frame.adjusted(0, 0, -1, -1));
+}
+
+void GridMinimap::centerOn(const QPoint& pos) {
+    if (!m_grid || !m_area || m_imageRect.isEmpty()) return;
+    const QSize content = m_grid->contentSize();
+    const double fx = double(pos.x() - m_imageRect.left()) / m_imageRect.width();
+    const double fy = double(pos.y() - m_imageRect.top()) / m_imageRect.height();
+    m_area->horizontalScrollBar()->setValue(int(fx * content.width() - m_area->viewport()->width() / 2.0));
+    m_area->verticalScrollBar()->setValue(int(fy * content.height() - m_area->viewport()->height() / 2.0));
+}
+
+void GridMinimap::mousePressEvent(QMouseEvent* e) {
+    if (e->button() == Qt::LeftButton) centerOn(e->pos());
+}
+
+void GridMinimap::mouseMoveEvent(QMouseEvent* e) {
+    if (e->buttons() & Qt::LeftButton) centerOn(e->pos());
+}
@@ -0,0 +1,44 @@
+// gridminimap.h
+#pragma once
+#include <QImage>
+#include <QPointer>
+#include <QWidget>
+
+class PixelGridWidget;
+class QScrollArea;
+
+/**
+ * \brief Обзор всей сетки с рамкой видимой области; щелчок и перетаскивание прокручивают сетку.
+ * \details Картинка строится GlyphIO::renderNearest под размер виджета (ближайший сосед)
+ *          и перестраивается лениво — при следующей перерисовке после PixelGridWidget::changed
+ *          или изменения размера. Рамка берётся из полос прокрутки области сетки.
+ */
+class GridMinimap : public QWidget {
+    Q_OBJECT
+public:
+    GridMinimap(PixelGridWidget* grid, QScrollArea* area, QWidget* parent = nullptr);
+
+    QSize sizeHint() const override { return { 220, 220 }; }
+
+public slots:
+    /** \brief Рисунок сетки изменился: перестроить картинку при следующей перерисовке. */
+    void refresh();
+
+protected:
+    void paintEvent(QPaintEvent*) override;
+    void resizeEvent(QResizeEvent*) override;
+    void mousePressEvent(QMouseEvent*) override;
+    void mouseMoveEvent(QMouseEvent*) override;
+
+private:
+    /// \brief Картинка сетки под текущий размер виджета и её место в нём.
+    void rebuild();
+    /// \brief Прокрутить сетку так, чтобы точка обзора pos оказалась в центре.
+    void centerOn(const QPoint& pos);
+
+    QPointer<PixelGridWidget> m_grid;
+    QPointer<QScrollArea>     m_area;
+    QImage                    m_image;
+    QRect                     m_imageRect;   ///< место картинки в виджете
+    bool                      m_dirty = true;
+};
@@ -0,0 +1,102 @@
+// hexconverter.cpp
+#include "hexconverter.h"
+#include "glyphio.h"
+#include "trace.h"
+#include <QTextCursor>
+#include <QTextDocument>
+#include <algorithm>
+
+namespace {
+
+/// \brief Число совпадающих элементов в начале и (не пересекаясь с ним) в конце двух списков.
+template <typename A, typename B, typename Eq>
+void commonEnds(const A& a, qsizetype na, const B& b, qsizetype nb, Eq eq, qsizetype& prefix, qsizetype& suffix) {
+    const qsizetype n = std::min(na, nb);
+    prefix = 0;
+    while (prefix < n && eq(a[prefix], b[prefix])) ++prefix;
+    suffix = 0;
+    while (suffix < n - prefix && eq(a[na - 1 - suffix], b[nb - 1 - suffix])) ++suffix;
+}
+
+} // namespace
+
+void HexConverter::clear() {
+    m_lines.clear();
+    m_hex.clear();
+    m_bytes.clear();
+    m_converted = 0;
+}
+
+QString HexConverter::convert(const QString& text) {
+    FC_TRACE_OPERATION("HexConverter::convert");
+    const QStringList lines = text.split(QLatin1Char('\n'));
+    qsizetype prefix, suffix;
+    commonEnds(m_lines, m_lines.size(), lines, lines.size(),
+               [](const QString& x, const QString& y) { return x == y; }, prefix, suffix);
+
+    // Кэш: общее начало, заново — изменённый участок, общий конец.
+    const qsizetype oldMid = m_lines.size() - prefix - suffix;
+    const qsizetype newMid = lines.size() - prefix - suffix;
+    m_converted = int(newMid);
+    if (m_dir == Direction::TextToHex) {
+        QVector<QString> mid(newMid);
+        for (qsizetype i = 0; i < newMid; ++i)
+            mid[i] = GlyphIO::bytesToEscapedHex(lines[prefix + i].toLocal8Bit());
+        m_hex.erase(m_hex.begin() + prefix, m_hex.begin() + prefix + oldMid);
+        m_hex.insert(m_hex.begin() + prefix, mid.begin(), mid.end());
+    } else {
+        QVector<QByteArray> mid(newMid);
+        for (qsizetype i = 0; i < newMid; ++i)
+            mid[i] = GlyphIO::parseHexString(lines[prefix + i]);
+        m_bytes.erase(m_bytes.begin() + prefix, m_bytes.begin() + prefix + oldMid);
+        m_bytes.insert(m_bytes.begin() + prefix, mid.begin(), mid.end());
+    }
+    m_lines = lines;
+
+    if (m_dir == Direction::TextToHex) {
+        // Перевод строки — байт 0x0A между строками, как у toLocal8Bit() всего текста.
+        static const QString newline = QStringLiteral("\\x0A");
+        qsizetype size = newline.size() * (m_hex.size() - 1);
+        for (const QString& h : m_hex) size += h.size();
+        QString out;
+        out.reserve(size);
+        for (qsizetype i = 0; i < m_hex.size(); ++i) {
+            if (i) out += newline;
+            out += m_hex[i];
+        }
+        return out;
+    }
+
+    // Многобайтовый символ может начинаться в одной строке \xNN и заканчиваться в другой,
+    // поэтому декодируется склеенный массив байтов.
+    qsizetype size = 0;
+    for (const QByteArray& b : m_bytes) size += b.size();
+    QByteArray all;
+    all.reserve(size);
+    for (const QByteArray& b : m_bytes) all += b;
+    return QString::fromLocal8Bit(all);
+}
+
+namespace TextDiff {
+
+int apply(QTextDocument* doc, const QString& text) {
+    FC_TRACE_SCOPE("TextDiff::apply");
+    const QString old = doc->toPlainText();
+    if (old == text) return 0;
+
+    qsizetype prefix, suffix;
+    commonEnds(old.constData(), old.size(), text.constData(), text.size(),
+               [](QChar x, QChar y) { return x == y; }, prefix, suffix);
+
+    QTextCursor cur(doc);
+    cur.beginEditBlock();
+    cur.setPosition(int(prefix));
+    cur.setPosition(int(old.size() - suffix), QTextCursor::KeepAnchor);
+    const QString inserted = text.mid(prefix, text.size() - prefix - suffix);
+    if (inserted.isEmpty()) cur.removeSelectedText();
+    else cur.insertText(inserted);
+    cur.endEditBlock();
+    return int(inserted.size());
+}
+
+} // namespace TextDiff
@@ -0,0 +1,62 @@
+// hexconverter.h
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QTextDocument;
+
+/**
+ * \brief Инкрементальное преобразование текст ↔ строка \xNN (вкладка конвертора).
+ * \details Вход режется на строки. Строки, совпавшие с прошлым вызовом (общее начало и
+ *          общий конец списка), берутся из кэша; заново преобразуется только изменённый
+ *          участок между ними. Разбиение на строки не меняет результат: токены \xNN/0xNN/NN
+ *          не переходят через перевод строки, а строки текста кодируются независимо.
+ *
+ *          Объект не потокобезопасен: convert() вызывается не более чем из одного потока
+ *          одновременно (например, из задачи пула, по одной за раз).
+ */
+class HexConverter {
+public:
+    enum class Direction {
+        TextToHex, ///< текст → локальная 8-битная кодировка → \xNN
+        HexToText  ///< \xNN / 0xNN / NN → байты → текст из локальной кодировки
+    };
+
+    explicit HexConverter(Direction dir) : m_dir(dir) {}
+
+    Direction direction() const { return m_dir; }
+
+    /** \brief Преобразовать text целиком, используя кэш строк прошлого вызова. */
+    QString convert(const QString& text);
+
+    /** \brief Сколько строк было преобразовано заново при последнем convert(). */
+    int lastConverted() const { return m_converted; }
+
+    /** \brief Сбросить кэш. */
+    void clear();
+
+private:
+    Direction          m_dir;
+    QStringList        m_lines;  ///< строки входа прошлого вызова
+    QVector<QString>   m_hex;    ///< TextToHex: \xNN строки (без перевода строки)
+    QVector<QByteArray> m_bytes; ///< HexToText: байты строки
+    int                m_converted = 0;
+};
+
+/**
+ * \brief Обновление документа редактора правкой, а не заменой всего текста.
+ */
+namespace TextDiff {
+
+/**
+ * \brief Привести doc к тексту text одной правкой QTextCursor.
+ * \details Находятся общие начало и конец старого и нового текста, заменяется только
+ *          участок между ними (одним шагом отмены). Позиция прокрутки и курсоры вне
+ *          участка сохраняются, раскладка пересчитывается лишь для затронутых блоков.
+ * \return Число вставленных символов (0 — текст не изменился).
+ */
+int apply(QTextDocument* doc, const QString& text);
+
+} // namespace TextDiff
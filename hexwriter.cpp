@@ -0,0 +1,215 @@
+// hexwriter.cpp
+#include "hexwriter.h"
+#include "bitpacker.h"
+#include "bitplane.h"
+#include "graydepth.h"
+#include <QIODevice>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+/// \brief Гекс-пары "00".."FF" (верхний регистр) и 8-символьный рисунок байта (MSB слева).
+struct Tables {
+    char hex[256][2] = {};
+    char art[256][8] = {};
+    constexpr Tables() {
+        const char digits[] = "0123456789ABCDEF";
+        for (int v = 0; v < 256; ++v) {
+            hex[v][0] = digits[v >> 4];
+            hex[v][1] = digits[v & 15];
+            for (int k = 0; k < 8; ++k)
+                art[v][k] = (v >> (7 - k)) & 1 ? '#' : ' ';
+        }
+    }
+};
+constexpr Tables kTables;
+
+} // namespace
+
+HexWriter::HexWriter(QIODevice* dev, qsizetype flushBytes)
+    : m_dev(dev), m_flushBytes(std::max<qsizetype>(64, flushBytes))
+{
+    m_buf.resize(m_flushBytes);
+}
+
+HexWriter::~HexWriter() {
+    if (m_dev) flush();
+}
+
+void HexWriter::reserve(qsizetype n) {
+    if (!m_dev && m_len + n > m_buf.size())
+        m_buf.resize(m_len + n);
+}
+
+void HexWriter::grow(qsizetype n) {
+    if (m_dev) {
+        flush();
+        if (n <= m_buf.size()) return;
+    }
+    m_buf.resize(std::max(m_len + n, m_buf.size() * 2 + 256));
+}
+
+bool HexWriter::flush() {
+    if (!m_dev) return true;
+    if (m_len > 0 && m_dev->write(m_buf.constData(), m_len) != m_len)
+        m_ok = false;
+    m_len = 0;
+    return m_ok;
+}
+
+QByteArray HexWriter::takeBuffer() {
+    QByteArray out;
+    m_buf.truncate(m_len);
+    out.swap(m_buf);
+    m_len = 0;
+    return out;
+}
+
+void HexWriter::put(const char* s, qsizetype n) {
+    ensure(n);
+    std::memcpy(m_buf.data() + m_len, s, size_t(n));
+    m_len += n;
+}
+
+void HexWriter::put(const char* s) {
+    put(s, qsizetype(std::strlen(s)));
+}
+
+void HexWriter::put(const QString& s) {
+    const QByteArray u = s.toUtf8();
+    put(u.constData(), u.size());
+}
+
+void HexWriter::putDecimal(qint64 v) {
+    char tmp[24];
+    int i = sizeof(tmp);
+    const bool neg = v < 0;
+    quint64 u = neg ? quint64(-(v + 1)) + 1 : quint64(v);
+    do { tmp[--i] = char('0' + u % 10); u /= 10; } while (u);
+    if (neg) tmp[--i] = '-';
+    put(tmp + i, qsizetype(sizeof(tmp)) - i);
+}
+
+void HexWriter::putHex(quint8 v) {
+    ensure(4);
+    char* d = m_buf.data() + m_len;
+    d[0] = '0'; d[1] = 'x';
+    d[2] = kTables.hex[v][0]; d[3] = kTables.hex[v][1];
+    m_len += 4;
+}
+
+void HexWriter::putHexList(const quint8* bytes, qsizetype n) {
+    // Порциями, чтобы в режиме устройства буфер не рос сверх m_flushBytes.
+    constexpr qsizetype kStep = 4096;
+    for (qsizetype i0 = 0; i0 < n; i0 += kStep) {
+        const qsizetype i1 = std::min(n, i0 + kStep);
+        ensure((i1 - i0) * 6);
+        char* d = m_buf.data() + m_len;
+        for (qsizetype i = i0; i < i1; ++i) {
+            if (i) { *d++ = ','; *d++ = ' '; }
+            *d++ = '0'; *d++ = 'x';
+            *d++ = kTables.hex[bytes[i]][0];
+            *d++ = kTables.hex[bytes[i]][1];
+        }
+        m_len = d - m_buf.constData();
+    }
+}
+
+qsizetype HexWriter::cRowsSize(int rows, int cols) {
+    const qsizetype bpr = (cols + 7) / 8;
+    // "    " + список + ",  // " + рисунок + "\n"
+    return qsizetype(rows) * (4 + hexListSize(bpr) + 6 + cols + 1);
+}
+
+qsizetype HexWriter::cGlyphSize(int rows, int cols, const PackFormat& f) {
+    if (f.layout == PackLayout::RowMajor)
+        return cRowsSize(rows, cols);
+    const qsizetype pages = (rows + 7) / 8;
+    const qsizetype lines = f.layout == PackLayout::Page ? pages : cols;
+    const qsizetype perLine = f.layout == PackLayout::Page ? cols : pages;
+    // "    " + список + ",  // page " + номер + "\n"
+    return lines * (4 + hexListSize(perLine) + 11 + 6 + 1);
+}
+
+void HexWriter::putCRows(const BitPlane& bits, bool msbFirst) {
+    const int cols = bits.cols();
+    const int bpr = (cols + 7) / 8;
+    const qsizetype rowLen = cRowsSize(1, cols);
+    // Гекс — из упакованных байтов (порядок бит выбран один раз), рисунок — из строк плоскости.
+    const QVector<quint8> packed = BitPacker::pack(bits, { PackLayout::RowMajor, msbFirst });
+
+    for (int r = 0; r < bits.rows(); ++r) {
+        const uchar* src = bits.rowBytes(r);
+        const quint8* hex = packed.constData() + qsizetype(r) * bpr;
+        ensure(rowLen);
+        char* d = m_buf.data() + m_len;
+        *d++ = ' '; *d++ = ' '; *d++ = ' '; *d++ = ' ';
+        for (int b = 0; b < bpr; ++b) {
+            if (b) { *d++ = ','; *d++ = ' '; }
+            *d++ = '0'; *d++ = 'x';
+            *d++ = kTables.hex[hex[b]][0];
+            *d++ = kTables.hex[hex[b]][1];
+        }
+        std::memcpy(d, ",  // ", 6);
+        d += 6;
+        for (int b = 0; b < bpr; ++b) {
+            const int n = std::min(8, cols - b * 8);
+            std::memcpy(d, kTables.art[src[b]], size_t(n));
+            d += n;
+        }
+        *d++ = '\n';
+        m_len = d - m_buf.constData();
+    }
+}
+
+void HexWriter::putCLevels(const BitPlane& bits, int depth, bool msbFirst) {
+    static const char kRamp2[] = " .+#";
+    static const char kRamp4[] = " .,:;-~=+*oxO%@#";
+    const char* ramp = depth == 4 ? kRamp4 : kRamp2;
+    const int width = bits.cols() / depth;
+    const int bpr = (bits.cols() + 7) / 8;
+    const qsizetype rowLen = cRowsSize(1, bits.cols());
+    // Байты — как в GlyphIO::exportLevels(): строки плоскости и порядок пикселей в байте.
+    QVector<quint8> packed = BitPacker::pack(bits, { PackLayout::RowMajor, true });
+    if (!msbFirst)
+        GrayDepth::reversePixels(packed.data(), packed.size(), depth);
+
+    for (int r = 0; r < bits.rows(); ++r) {
+        const quint8* hex = packed.constData() + qsizetype(r) * bpr;
+        ensure(rowLen);
+        char* d = m_buf.data() + m_len;
+        *d++ = ' '; *d++ = ' '; *d++ = ' '; *d++ = ' ';
+        for (int b = 0; b < bpr; ++b) {
+            if (b) { *d++ = ','; *d++ = ' '; }
+            *d++ = '0'; *d++ = 'x';
+            *d++ = kTables.hex[hex[b]][0];
+            *d++ = kTables.hex[hex[b]][1];
+        }
+        std::memcpy(d, ",  // ", 6);
+        d += 6;
+        for (int x = 0; x < width; ++x)
+            *d++ = ramp[GrayDepth::level(bits, depth, r, x)];
+        *d++ = '\n';
+        m_len = d - m_buf.constData();
+    }
+}
+
+void HexWriter::putCGlyph(const BitPlane& bits, const PackFormat& f) {
+    if (f.layout == PackLayout::RowMajor) {
+        putCRows(bits, f.msbFirst);
+        return;
+    }
+    const QVector<quint8> bytes = BitPacker::pack(bits, f);
+    const bool byPage = f.layout == PackLayout::Page;
+    const int pages = (bits.rows() + 7) / 8;
+    const int lines = byPage ? pages : bits.cols();
+    const int perLine = byPage ? bits.cols() : pages;
+    for (int i = 0; i < lines; ++i) {
+        put("    ", 4);
+        putHexList(bytes.constData() + qsizetype(i) * perLine, perLine);
+        put(byPage ? ",  // page " : ",  // col ");
+        putDecimal(i);
+        put('\n');
+    }
+}
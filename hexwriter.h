@@ -0,0 +1,91 @@
+// hexwriter.h
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+class BitPlane;
+class QIODevice;
+struct PackFormat;
+
+/**
+ * \brief Буферизованный писатель текстовых форматов экспорта (ASCII).
+ * \details Пишет в один заранее выделенный буфер; гекс-пары и ASCII-рисунок берутся из
+ *          таблиц, без QString на каждый байт. Если задан QIODevice, буфер сбрасывается
+ *          в него при заполнении, так что объём вывода на память не влияет.
+ *
+ *          Форматы совпадают с GlyphIO: префикс `0x` — нижний регистр, цифры — верхний.
+ */
+class HexWriter {
+public:
+    /// \brief Размер буфера по умолчанию при записи в устройство.
+    static constexpr qsizetype kFlushBytes = 1 << 20;
+
+    /** \brief Писать в память (результат — buffer()/takeText()). */
+    HexWriter() = default;
+    /** \brief Писать в устройство порциями по flushBytes. */
+    explicit HexWriter(QIODevice* dev, qsizetype flushBytes = kFlushBytes);
+    ~HexWriter();
+
+    HexWriter(const HexWriter&) = delete;
+    HexWriter& operator=(const HexWriter&) = delete;
+
+    /** \brief Зарезервировать место под n символов (в режиме памяти). */
+    void reserve(qsizetype n);
+
+    /// \name Примитивы
+    /// @{
+    void put(char c) { ensure(1); m_buf.data()[m_len++] = c; }
+    void put(const char* s, qsizetype n);
+    void put(const char* s);
+    void put(const QString& s);
+    void putDecimal(qint64 v);
+    /** \brief "0xAB". */
+    void putHex(quint8 v);
+    /// @}
+
+    /// \name Форматы экспорта
+    /// @{
+    /** \brief "0xFE, 0x07, ..." без завершающего перевода строки. */
+    void putHexList(const quint8* bytes, qsizetype n);
+    /** \brief Строки "    0xNN, 0xNN,  // ##  #" для всей плоскости. */
+    void putCRows(const BitPlane& bits, bool msbFirst);
+    /**
+     * \brief Глиф в раскладке f: RowMajor — как putCRows, вертикальные раскладки —
+     *        строка на страницу ("// page N") или на столбец ("// col N").
+     */
+    void putCGlyph(const BitPlane& bits, const PackFormat& f);
+    /**
+     * \brief Серый глиф глубины depth (GrayDepth): байты как у GlyphIO::exportLevels()
+     *        и рисунок — символ на пиксель по уровню (" .+#" для 2 бит, 16 оттенков для 4).
+     */
+    void putCLevels(const BitPlane& bits, int depth, bool msbFirst);
+    /// @}
+
+    /** \brief Сбросить буфер в устройство. \return false при ошибке записи. */
+    bool flush();
+    /** \brief Не было ошибок записи в устройство. */
+    bool ok() const { return m_ok; }
+
+    /** \brief Накопленный текст (режим памяти). */
+    QByteArray takeBuffer();
+    QString    takeText() { return QString::fromLatin1(takeBuffer()); }
+
+    /** \brief Длина "0xNN, ..." для n байт. */
+    static qsizetype hexListSize(qsizetype n) { return n > 0 ? n * 6 - 2 : 0; }
+    /** \brief Длина вывода putCRows. */
+    static qsizetype cRowsSize(int rows, int cols);
+    /** \brief Оценка сверху длины вывода putCGlyph. */
+    static qsizetype cGlyphSize(int rows, int cols, const PackFormat& f);
+
+private:
+    /// \brief Обеспечить место под n символов: сбросить в устройство или расширить буфер.
+    void ensure(qsizetype n) { if (m_len + n > m_buf.size()) grow(n); }
+    void grow(qsizetype n);
+
+    QIODevice* m_dev = nullptr;
+    QByteArray m_buf;
+    qsizetype  m_len = 0;
+    qsizetype  m_flushBytes = kFlushBytes;
+    bool       m_ok = true;
+};
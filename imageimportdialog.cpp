@@ -0,0 +1,101 @@
+// imageimportdialog.cpp
+#include "imageimportdialog.h"
+#include "glyphio.h"
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QElapsedTimer>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPixmap>
+#include <QSlider>
+#include <QSpinBox>
+#include <QVBoxLayout>
+
+ImageImportDialog::ImageImportDialog(const QImage& image, QWidget* parent)
+    : QDialog(parent)
+{
+    setWindowTitle(QString("Импорт изображения %1x%2").arg(image.width()).arg(image.height()));
+
+    m_preview = image.convertToFormat(QImage::Format_Grayscale8);
+    if (m_preview.width() > kPreviewSize || m_preview.height() > kPreviewSize)
+        m_preview = m_preview.scaled(kPreviewSize, kPreviewSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    auto *vl = new QVBoxLayout(this);
+    auto *form = new QFormLayout;
+
+    m_cbMode = new QComboBox(this);
+    m_cbMode->addItem("Порог", int(BinarizeMode::Threshold));
+    m_cbMode->addItem("Оцу (авто)", int(BinarizeMode::Otsu));
+    m_cbMode->addItem("Флойд–Стейнберг", int(BinarizeMode::FloydSteinberg));
+    m_cbMode->addItem("Упорядоченный (Байер 8×8)", int(BinarizeMode::Ordered));
+    form->addRow("Режим:", m_cbMode);
+
+    auto *thrRow = new QHBoxLayout;
+    m_slThreshold = new QSlider(Qt::Horizontal, this);
+    m_slThreshold->setRange(0, 256);
+    m_slThreshold->setValue(128);
+    m_sbThreshold = new QSpinBox(this);
+    m_sbThreshold->setRange(0, 256);
+    m_sbThreshold->setValue(128);
+    thrRow->addWidget(m_slThreshold, 1);
+    thrRow->addWidget(m_sbThreshold);
+    form->addRow("Порог:", thrRow);
+
+    m_chkInvert = new QCheckBox("Инвертировать", this);
+    form->addRow(QString(), m_chkInvert);
+    vl->addLayout(form);
+
+    m_lblPreview = new QLabel(this);
+    m_lblPreview->setAlignment(Qt::AlignCenter);
+    m_lblPreview->setMinimumSize(256, 256);
+    vl->addWidget(m_lblPreview, 1);
+    m_lblInfo = new QLabel(this);
+    vl->addWidget(m_lblInfo);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    vl->addWidget(buttons);
+
+    connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(m_slThreshold, &QSlider::valueChanged, m_sbThreshold, &QSpinBox::setValue);
+    connect(m_sbThreshold, qOverload<int>(&QSpinBox::valueChanged), m_slThreshold, &QSlider::setValue);
+    connect(m_slThreshold, &QSlider::valueChanged, this, &ImageImportDialog::updatePreview);
+    connect(m_chkInvert, &QCheckBox::toggled, this, &ImageImportDialog::updatePreview);
+    connect(m_cbMode, qOverload<int>(&QComboBox::currentIndexChanged), this, &ImageImportDialog::updatePreview);
+
+    updatePreview();
+}
+
+BinarizeOptions ImageImportDialog::options() const {
+    BinarizeOptions opt;
+    opt.mode = BinarizeMode(m_cbMode->currentData().toInt());
+    opt.threshold = m_sbThreshold->value();
+    opt.invert = m_chkInvert->isChecked();
+    return opt;
+}
+
+/** \brief Перебинаризовать уменьшенную копию и показать результат. */
+void ImageImportDialog::updatePreview() {
+    const BinarizeOptions opt = options();
+    m_slThreshold->setEnabled(opt.mode != BinarizeMode::Otsu);
+    m_sbThreshold->setEnabled(opt.mode != BinarizeMode::Otsu);
+
+    QElapsedTimer t;
+    t.start();
+    int used = opt.threshold;
+    const BitPlane bits = Binarizer::binarized(m_preview, opt, &used);
+    const double ms = t.nsecsElapsed() / 1e6;
+
+    const QImage img = GlyphIO::toImage(bits).copy(0, 0, m_preview.width(), m_preview.height());
+    const QSize box = m_lblPreview->size().expandedTo(m_preview.size());
+    m_lblPreview->setPixmap(QPixmap::fromImage(
+        img.scaled(box.boundedTo(QSize(kPreviewSize, kPreviewSize)), Qt::KeepAspectRatio, Qt::FastTransformation)));
+
+    QString info = QString("Предпросмотр %1x%2: %3 мс").arg(m_preview.width()).arg(m_preview.height())
+                       .arg(ms, 0, 'f', 2);
+    if (opt.mode == BinarizeMode::Otsu)
+        info += QString(", порог Оцу: %1").arg(used);
+    m_lblInfo->setText(info);
+}
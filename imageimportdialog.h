@@ -0,0 +1,39 @@
+// imageimportdialog.h
+#pragma once
+#include <QDialog>
+#include <QImage>
+#include "binarizer.h"
+
+class QCheckBox;
+class QComboBox;
+class QLabel;
+class QSlider;
+class QSpinBox;
+
+/**
+ * \brief Диалог импорта изображения: режим бинаризации, порог, инверсия
+ *        и живой предпросмотр результата.
+ * \details Предпросмотр считается по уменьшенной копии (не больше kPreviewSize по
+ *          большей стороне), так что обновляется на каждое движение ползунка.
+ */
+class ImageImportDialog : public QDialog {
+    Q_OBJECT
+public:
+    explicit ImageImportDialog(const QImage& image, QWidget* parent = nullptr);
+
+    BinarizeOptions options() const;
+
+private slots:
+    void updatePreview();
+
+private:
+    static constexpr int kPreviewSize = 512;
+
+    QImage     m_preview;  ///< уменьшенная Grayscale8-копия исходника
+    QComboBox* m_cbMode = nullptr;
+    QSlider*   m_slThreshold = nullptr;
+    QSpinBox*  m_sbThreshold = nullptr;
+    QCheckBox* m_chkInvert = nullptr;
+    QLabel*    m_lblPreview = nullptr;
+    QLabel*    m_lblInfo = nullptr;
+};
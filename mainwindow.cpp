@@ -1,9 +1,27 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "pixelgridwidget.h"
+#include "glyphlistview.h"
+#include "gridminimap.h"
+#include "textpreviewwidget.h"
+#include "glyphio.h"
+#include "graydepth.h"
+#include "fontrasterizer.h"
+#include "fontexport.h"
+#include "fontimportdialog.h"
+#include "glyphbatchdialog.h"
+#include "imageimportdialog.h"
+#include "sheetimportdialog.h"
+#include "sheetslicer.h"
+#include "backgroundtask.h"
+#include "projectfile.h"
+#include "trace.h"
+#include "hexconverter.h"
+#include "workstealingpool.h"
 
 #include <QFileDialog>
 #include <QFile>
+#include <QFileInfo>
 #include <QTextStream>
 #include <QMessageBox>
 #include <QStatusBar>
@@ -12,8 +30,46 @@
 #include <QClipboard>
 #include <QApplication>
 #include <QScrollArea>
+#include <QScrollBar>
 #include <QImage>
 #include <QSizePolicy>
+#include <QDockWidget>
+#include <QFormLayout>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QComboBox>
+#include <QPlainTextEdit>
+#include <QVBoxLayout>
+#include <QMenuBar>
+#include <QAction>
+#include <QActionGroup>
+#include <QToolBar>
+#include <QPixmap>
+#include <QIcon>
+#include <QInputDialog>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QTimer>
+
+namespace {
+/// \brief Пауза в наборе, после которой конвертор пересчитывает другой редактор, мс.
+constexpr int kConvertDelayMs = 150;
+
+/// \brief Шаги ползунка масштаба 1…9 — обзор (1/16 … 5 px на пиксель), дальше клетка v − 4 px.
+constexpr int kZoomOutSteps = 9;
+
+void zoomForSlider(int v, int& cell, int& shrink) {
+    static const int cells[kZoomOutSteps]   = { 1, 1, 1, 1, 1, 2, 3, 4, 5 };
+    static const int shrinks[kZoomOutSteps] = { 16, 8, 4, 2, 1, 1, 1, 1, 1 };
+    if (v >= 1 && v <= kZoomOutSteps) {
+        cell = cells[v - 1];
+        shrink = shrinks[v - 1];
+    } else {
+        cell = v - (kZoomOutSteps - PixelGridWidget::kDetailCell + 1);
+        shrink = 1;
+    }
+}
+}
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent), ui(new Ui::MainWindow)
@@ -24,12 +80,19 @@ MainWindow::MainWindow(QWidget* parent)
     auto *lbl = new QLabel(this);
     statusBar()->addPermanentWidget(lbl);
     lbl->setObjectName("lblStatus");
+    auto *lblTrace = new QLabel(this);
+    statusBar()->addPermanentWidget(lblTrace);
+    lblTrace->setObjectName("lblTrace");
+    auto *lblFrame = new QLabel(this);
+    statusBar()->addPermanentWidget(lblFrame);
+    lblFrame->setObjectName("lblFrame");
 
     // дефолты
-    ui->sbBytesPerRow->setValue(2);
+    ui->sbCols->setValue(16);
     ui->sbRows->setValue(26);
     ui->cbMsbFirst->setChecked(true);
-    ui->slCell->setValue(18);
+    ui->cbLayout->setCurrentIndex(int(PackLayout::RowMajor));
+    ui->slCell->setValue(22);   // клетка 18 px
 
     // --- Делаем pixelGrid прямым widget() у saGrid ---
     ui->saGrid->setWidgetResizable(false);
@@ -45,10 +108,10 @@ MainWindow::MainWindow(QWidget* parent)
     // --- конец блока скролла ---
 
     // первичная настройка сетки
-    ui->pixelGrid->setGridSize(ui->sbRows->value(), ui->sbBytesPerRow->value());
+    ui->pixelGrid->setGridSize(ui->sbRows->value(), ui->sbCols->value());
     ui->pixelGrid->setMsbFirst(ui->cbMsbFirst->isChecked());
-    ui->pixelGrid->setCellSize(ui->slCell->value());
-    resizeGridWidgetToHint();
+    ui->pixelGrid->setPackLayout(packFormat().layout);
+    applyZoom();
 
     // связи: редактор глифа
     connect(ui->btnApply,   &QPushButton::clicked, this, &MainWindow::applyGridFromControls);
@@ -60,14 +123,20 @@ MainWindow::MainWindow(QWidget* parent)
     connect(ui->btnShiftD,  &QPushButton::clicked, ui->pixelGrid, &PixelGridWidget::shiftDown);
 
     connect(ui->cbMsbFirst, &QCheckBox::toggled,   ui->pixelGrid, &PixelGridWidget::setMsbFirst);
+    connect(ui->cbLayout, qOverload<int>(&QComboBox::currentIndexChanged), this, [this](int){
+        const PackLayout layout = packFormat().layout;
+        ui->pixelGrid->setPackLayout(layout);
+        ui->cbMsbFirst->setText(layout == PackLayout::RowMajor ? "MSB слева" : "MSB сверху");
+        updateStatus();
+    });
     connect(ui->slCell, &QSlider::valueChanged, this, [this](int){
-        ui->pixelGrid->setCellSize(ui->slCell->value());
-        resizeGridWidgetToHint();
+        applyZoom();
         updateStatus();
     });
 
     connect(ui->btnImportText, &QPushButton::clicked, this, &MainWindow::importFromText);
     connect(ui->btnOpen,       &QPushButton::clicked, this, &MainWindow::openFileDialog);
+    connect(ui->btnImportFile, &QPushButton::clicked, this, &MainWindow::importFile);
     if (ui->btnPaste) {
         connect(ui->btnPaste, &QPushButton::clicked, this, [this]{
             ui->teInput->setPlainText(QApplication::clipboard()->text());
@@ -88,13 +157,32 @@ MainWindow::MainWindow(QWidget* parent)
     if (ui->btnExportBmp)
         connect(ui->btnExportBmp, &QPushButton::clicked, this, &MainWindow::exportBmp);
 
-    // конвертор текста (вкладка)
+    // конвертор текста (вкладка): преобразование после паузы в наборе, в пуле потоков
+    m_convTimer = new QTimer(this);
+    m_convTimer->setSingleShot(true);
+    m_convTimer->setInterval(kConvertDelayMs);
+    connect(m_convTimer, &QTimer::timeout, this, [this] { startConversion(m_convDir); });
     if (ui->plainTextEdit)
         connect(ui->plainTextEdit,   &QPlainTextEdit::textChanged, this, &MainWindow::onTextToHexChanged);
     if (ui->plainTextEdit_2)
         connect(ui->plainTextEdit_2, &QPlainTextEdit::textChanged, this, &MainWindow::onHexToTextChanged);
 
+    setupFontDock();
+    setupPreviewDock();
+    setupOverviewDock();
+    setupPaletteToolBar();
+    setupEditMenu();
+    setupFontMenu();
+#ifdef FONTCREATOR_TRACE
+    setupTraceMenu();
+#endif
+
     connect(ui->pixelGrid, &PixelGridWidget::changed, this, &MainWindow::updateStatus);
+    connect(ui->pixelGrid, &PixelGridWidget::frameStats, lblFrame, [lblFrame](double ms, double fps) {
+        lblFrame->setText(QString("кадр: %1 мс, %2 fps").arg(ms, 0, 'f', 2).arg(fps, 0, 'f', 0));
+    });
+    connect(ui->pixelGrid, &PixelGridWidget::changed, this, &MainWindow::storeCurrentGlyph);
+    setFontModified(false);
     updateStatus();
 }
 
@@ -103,6 +191,25 @@ MainWindow::~MainWindow() {
     delete ui;
 }
 
+/** \brief Масштаб сетки по ползунку; точка в центре видимой области остаётся на месте. */
+void MainWindow::applyZoom() {
+    QScrollBar* hbar = ui->saGrid->horizontalScrollBar();
+    QScrollBar* vbar = ui->saGrid->verticalScrollBar();
+    const QSize view = ui->saGrid->viewport()->size();
+    const QSize before = ui->pixelGrid->contentSize();
+    const double fx = (hbar->value() + view.width() / 2.0) / std::max(1, before.width());
+    const double fy = (vbar->value() + view.height() / 2.0) / std::max(1, before.height());
+
+    int cell, shrink;
+    zoomForSlider(ui->slCell->value(), cell, shrink);
+    ui->pixelGrid->setZoom(cell, shrink);
+    resizeGridWidgetToHint();
+
+    const QSize after = ui->pixelGrid->contentSize();
+    hbar->setValue(int(fx * after.width() - view.width() / 2.0));
+    vbar->setValue(int(fy * after.height() - view.height() / 2.0));
+}
+
 void MainWindow::resizeGridWidgetToHint() {
     const QSize s = ui->pixelGrid->sizeHint();
     ui->pixelGrid->setMinimumSize(s);
@@ -111,60 +218,695 @@ void MainWindow::resizeGridWidgetToHint() {
 }
 
 
+/** \brief Док-панель шрифта: создание диапазона кодов и список глифов. */
+void MainWindow::setupFontDock() {
+    auto *dock = new QDockWidget("Шрифт", this);
+    dock->setObjectName("dockFont");
+    auto *host = new QWidget(dock);
+    auto *vl = new QVBoxLayout(host);
+
+    auto *form = new QFormLayout;
+    m_sbFirstCode = new QSpinBox(host);
+    m_sbFirstCode->setRange(0, 0x10FFFF);
+    m_sbFirstCode->setDisplayIntegerBase(16);
+    m_sbFirstCode->setPrefix("0x");
+    m_sbFirstCode->setValue(0x20);
+    m_sbGlyphCount = new QSpinBox(host);
+    m_sbGlyphCount->setRange(1, 0x10000);
+    m_sbGlyphCount->setValue(95);
+    m_cbDepth = new QComboBox(host);
+    m_cbDepth->addItem("1 бит", 1);
+    m_cbDepth->addItem("2 бита (4 уровня)", 2);
+    m_cbDepth->addItem("4 бита (16 уровней)", 4);
+    m_cbDepth->setToolTip("Бит на пиксель: глифы шрифта и сетка переводятся в новую глубину");
+    form->addRow("Первый код:", m_sbFirstCode);
+    form->addRow("Количество:", m_sbGlyphCount);
+    form->addRow("Глубина пикселя:", m_cbDepth);
+    vl->addLayout(form);
+
+    auto *btnCreate = new QPushButton("Создать глифы", host);
+    vl->addWidget(btnCreate);
+
+    m_glyphModel = new FontGlyphModel(&m_font, this);
+    m_glyphList = new GlyphListView(host);
+    m_glyphList->setGlyphModel(m_glyphModel);
+    vl->addWidget(m_glyphList, 1);
+
+    dock->setWidget(host);
+    addDockWidget(Qt::RightDockWidgetArea, dock);
+
+    connect(btnCreate, &QPushButton::clicked, this, &MainWindow::createGlyphRange);
+    connect(m_cbDepth, qOverload<int>(&QComboBox::activated), this, [this](int i) {
+        setFontDepth(m_cbDepth->itemData(i).toInt());
+    });
+    connect(m_glyphList, &GlyphListView::glyphSelected, this, &MainWindow::onGlyphSelected);
+}
+
+/** \brief Док-панель предпросмотра: редактируемый текст, набранный текущим шрифтом. */
+void MainWindow::setupPreviewDock() {
+    auto *dock = new QDockWidget("Предпросмотр текста", this);
+    dock->setObjectName("dockPreview");
+    auto *host = new QWidget(dock);
+    auto *vl = new QVBoxLayout(host);
+
+    auto *edText = new QPlainTextEdit(host);
+    edText->setPlainText("The quick brown fox jumps over the lazy dog 0123456789\n"
+                         "Съешь же ещё этих мягких французских булок, да выпей чаю");
+    edText->setMaximumHeight(72);
+    vl->addWidget(edText);
+
+    auto *form = new QFormLayout;
+    auto *sbScale = new QSpinBox(host);
+    sbScale->setRange(1, 16);
+    sbScale->setSuffix("×");
+    sbScale->setValue(2);
+    auto *cbDevice = new QComboBox(host);
+    cbDevice->addItems({ "Бумага (чёрный на белом)", "OLED (белый на чёрном)", "OLED голубой", "ЖКИ (STN, зелёный)" });
+    form->addRow("Масштаб:", sbScale);
+    form->addRow("Экран:", cbDevice);
+    vl->addLayout(form);
+
+    m_preview = new TextPreviewWidget(host);
+    m_preview->setGlyphModel(m_glyphModel);
+    m_preview->setText(edText->toPlainText());
+    m_preview->setScale(sbScale->value());
+    vl->addWidget(m_preview, 1);
+    auto *lblRender = new QLabel(host);
+    vl->addWidget(lblRender);
+
+    dock->setWidget(host);
+    addDockWidget(Qt::BottomDockWidgetArea, dock);
+
+    connect(edText, &QPlainTextEdit::textChanged, m_preview, [this, edText] {
+        m_preview->setText(edText->toPlainText());
+    });
+    connect(sbScale, qOverload<int>(&QSpinBox::valueChanged), m_preview, &TextPreviewWidget::setScale);
+    connect(cbDevice, qOverload<int>(&QComboBox::currentIndexChanged), m_preview, [this](int i) {
+        static const QRgb colors[][2] = {
+            { qRgb(255, 255, 255), qRgb(0, 0, 0) },
+            { qRgb(0, 0, 0),       qRgb(235, 235, 235) },
+            { qRgb(0, 0, 0),       qRgb(80, 200, 255) },
+            { qRgb(150, 180, 90),  qRgb(30, 45, 30) },
+        };
+        i = qBound(0, i, 3);
+        m_preview->setDeviceColors(QColor(colors[i][0]), QColor(colors[i][1]));
+    });
+    connect(m_preview, &TextPreviewWidget::rendered, lblRender, [lblRender](double ms, int glyphs) {
+        lblRender->setText(QString("глифов: %1, кадр: %2 мс").arg(glyphs).arg(ms, 0, 'f', 3));
+    });
+}
+
+/** \brief Панель "Палитра": уровень серого, которым рисует левая кнопка (видна при depth > 1). */
+void MainWindow::setupPaletteToolBar() {
+    m_paletteBar = addToolBar("Палитра");
+    m_paletteBar->setObjectName("tbPalette");
+    m_paletteGroup = new QActionGroup(m_paletteBar);
+    m_paletteGroup->setExclusive(true);
+    syncDepthControls();
+}
+
+/**
+ * \brief Сменить глубину пикселя шрифта: документ переводит все глифы, сетка — текущий.
+ * \details Текущий глиф сначала сохраняется, чтобы перевод не потерял несохранённую правку.
+ */
+void MainWindow::setFontDepth(int depth) {
+    if (!GrayDepth::isValid(depth) || depth == m_font.depth()) return;
+    storeCurrentGlyph();
+    m_font.setDepth(depth);
+    m_loadingGlyph = true;   // сетка переводится так же, как документ: сохранять нечего
+    ui->pixelGrid->setDepth(depth);
+    m_loadingGlyph = false;
+    m_glyphModel->reload();
+    if (m_currentGlyph >= 0) m_glyphList->selectGlyph(m_currentGlyph);
+    if (!m_font.isEmpty()) setFontModified(true);
+    syncDepthControls();
+    updateStatus();
+}
+
+void MainWindow::syncDepthControls() {
+    const int depth = m_font.depth();
+    if (m_cbDepth) m_cbDepth->setCurrentIndex(m_cbDepth->findData(depth));
+    // Строка глифа в документе — до 0xFFFF бит (GlyphEntry::cols), а сетка — в пикселях.
+    ui->sbCols->setMaximum(0xFFFF / depth);
+    if (!m_paletteBar) return;
+
+    // Образцы уровней 1…L − 1 (0 — фон, им стирает правая кнопка).
+    qDeleteAll(m_paletteGroup->actions());   // действие само уходит из группы и панели
+    const int levels = GrayDepth::levels(depth);
+    for (int v = 1; v < levels; ++v) {
+        QPixmap swatch(16, 16);
+        const int shade = GrayDepth::shade(v, depth);
+        swatch.fill(QColor(shade, shade, shade));
+        QAction* act = m_paletteBar->addAction(QIcon(swatch), QString("Уровень %1").arg(v));
+        act->setCheckable(true);
+        act->setChecked(v == ui->pixelGrid->paintLevel());
+        m_paletteGroup->addAction(act);
+        connect(act, &QAction::triggered, ui->pixelGrid, [this, v] { ui->pixelGrid->setPaintLevel(v); });
+    }
+    m_paletteBar->setVisible(depth > 1);
+}
+
+/** \brief Меню "Правка": отмена/повтор и бюджет памяти истории. */
+void MainWindow::setupEditMenu() {
+    QMenu* menu = menuBar()->addMenu("Правка");
+    QAction* actUndo = menu->addAction("Отменить", ui->pixelGrid, &PixelGridWidget::undo);
+    actUndo->setShortcut(QKeySequence::Undo);
+    QAction* actRedo = menu->addAction("Повторить", ui->pixelGrid, &PixelGridWidget::redo);
+    actRedo->setShortcut(QKeySequence::Redo);
+    menu->addSeparator();
+    menu->addAction("Память истории…", this, [this] {
+        bool ok = false;
+        const int mb = QInputDialog::getInt(this, "История правок", "Бюджет памяти, МБ:",
+                                            int(ui->pixelGrid->history().budget() >> 20), 1, 1024, 1, &ok);
+        if (ok) ui->pixelGrid->setHistoryBudget(qsizetype(mb) << 20);
+    });
+
+    auto sync = [this, actUndo, actRedo] {
+        const GlyphHistory& h = ui->pixelGrid->history();
+        actUndo->setEnabled(h.canUndo());
+        actRedo->setEnabled(h.canRedo());
+        const QString tip = QString("Шагов: %1/%2, память: %3 КБ")
+                                .arg(h.undoCount()).arg(h.redoCount()).arg(h.memoryUsed() / 1024);
+        actUndo->setStatusTip(tip);
+        actRedo->setStatusTip(tip);
+    };
+    connect(ui->pixelGrid, &PixelGridWidget::historyChanged, this, sync);
+    sync();
+}
+
+/** \brief Меню "Шрифт": проект, импорт TTF/OTF и экспорт всего набора глифов. */
+void MainWindow::setupFontMenu() {
+    QMenu* menu = menuBar()->addMenu("Шрифт");
+    menu->addAction("Открыть проект…", this, &MainWindow::openProject)->setShortcut(QKeySequence::Open);
+    menu->addAction("Сохранить проект", this, &MainWindow::saveProject)->setShortcut(QKeySequence::Save);
+    menu->addAction("Сохранить проект как…", this, &MainWindow::saveProjectAs)->setShortcut(QKeySequence::SaveAs);
+    menu->addSeparator();
+    menu->addAction("Импорт TTF/OTF…", this, &MainWindow::importFontFile);
+    menu->addAction("Импорт листа глифов…", this, &MainWindow::importGlyphSheet);
+    menu->addAction("Пакетная обработка глифов…", this, &MainWindow::batchTransformGlyphs);
+    menu->addAction("Экспорт шрифта в C", this, &MainWindow::exportFontC);
+    menu->addAction("Экспорт шрифта в C-файл…", this, &MainWindow::exportFontCFile);
+    menu->addAction("Экспорт атласа (PNG/BMP)…", this, &MainWindow::exportFontAtlas);
+
+    QMenu* codecMenu = menu->addMenu("Сжатие при экспорте в C");
+    auto *codecGroup = new QActionGroup(codecMenu);
+    const QStringList codecTitles = { "Без сжатия", "RLE (байты)", "RLE (биты)", "LZ (окно 255)" };
+    const QStringList codecNames = GlyphCodec::names();
+    for (int i = 0; i < codecNames.size(); ++i) {
+        const GlyphCodecKind kind = GlyphCodec::fromName(codecNames[i]);
+        QAction* act = codecMenu->addAction(codecTitles.value(i, codecNames[i]));
+        act->setCheckable(true);
+        act->setChecked(kind == m_fontCodec);
+        codecGroup->addAction(act);
+        connect(act, &QAction::triggered, this, [this, kind] { m_fontCodec = kind; });
+    }
+
+    QAction* actTrim = menu->addAction("Обрезать глифы по содержимому (метрики)");
+    actTrim->setCheckable(true);
+    actTrim->setChecked(m_fontTrim);
+    actTrim->setStatusTip("Экспортировать только bounding box глифа + смещения и advance");
+    connect(actTrim, &QAction::toggled, this, [this](bool on) { m_fontTrim = on; });
+
+    QAction* actBitstream = menu->addAction("Плотный поток бит (без выравнивания строк)");
+    actBitstream->setCheckable(true);
+    actBitstream->setChecked(m_fontBitstream);
+    actBitstream->setStatusTip("Строки глифов подряд по ширине в битах; смещения в битах, сжатие не применяется");
+    connect(actBitstream, &QAction::toggled, this, [this, codecMenu](bool on) {
+        m_fontBitstream = on;
+        codecMenu->setEnabled(!on);
+    });
+    codecMenu->setEnabled(!m_fontBitstream);
+}
+
+FontExportOptions MainWindow::fontExportOptions() const {
+    FontExportOptions opt;
+    opt.format = packFormat();
+    opt.codec  = m_fontCodec;
+    opt.trim   = m_fontTrim;
+    opt.bitstream = m_fontBitstream;
+    return opt;
+}
+
+/** \brief Итог экспорта шрифта: сколько байт битмапов сэкономили обрезка, сжатие и склейка. */
+void MainWindow::showFontExportStats(const FontExportStats& stats) {
+    const double saved = stats.fullBytes > 0 ? 100.0 * (stats.fullBytes - stats.bitmapBytes) / stats.fullBytes : 0.0;
+    statusBar()->showMessage(QString("Экспорт шрифта: %1 глифов (общих %2), битмапы %3 → %4 байт (−%5%)")
+                                 .arg(m_font.glyphCount())
+                                 .arg(stats.sharedGlyphs)
+                                 .arg(stats.fullBytes)
+                                 .arg(stats.bitmapBytes)
+                                 .arg(saved, 0, 'f', 1), 4000);
+}
+
+/** \brief Растеризовать TTF/OTF в новый документ (в фоне, с прогрессом и отменой). */
+void MainWindow::importFontFile() {
+    FontImportDialog dlg(this);
+    RasterizeOptions opt;
+    if (dlg.exec() != QDialog::Accepted || !dlg.options(opt))
+        return;
+
+    FontDocument doc;
+    RasterizeResult res;
+    const bool finished = BackgroundTask::run(this, "Растеризация шрифта…", FontRasterizer::codeCount(opt.ranges),
+        [&](std::atomic<int>& done, const std::atomic<bool>& cancel) {
+            FontRasterizer::rasterize(opt, doc, &res, &done, &cancel);
+        });
+    if (!finished) {
+        statusBar()->showMessage("Импорт шрифта отменён", 2000);
+        return;
+    }
+    if (!res.error.isEmpty()) {
+        QMessageBox::warning(this, "Импорт TTF/OTF", "Ошибка: " + res.error);
+        return;
+    }
+
+    const int shared = replaceFont(std::move(doc));
+    statusBar()->showMessage(QString("Растеризовано %1 глифов %2x%3 за %4 мс (нет в шрифте: %5, одинаковых: %6)")
+                                 .arg(res.rendered).arg(res.cols).arg(res.rows)
+                                 .arg(res.elapsedNs / 1000000).arg(res.missing).arg(shared), 4000);
+}
+
+/** \brief Нарезать лист глифов (sprite sheet) в новый документ. */
+void MainWindow::importGlyphSheet() {
+    const QString fn = QFileDialog::getOpenFileName(this, "Импорт листа глифов", QString(),
+                                                    "Images (*.bmp *.png *.jpg *.jpeg *.gif);;All files (*.*)");
+    if (fn.isEmpty()) return;
+    const QImage sheet(fn);
+    if (sheet.isNull()) {
+        QMessageBox::warning(this, "Импорт", "Не удалось открыть изображение.");
+        return;
+    }
+
+    SheetImportDialog dlg(sheet, this);
+    if (dlg.exec() != QDialog::Accepted) return;
+
+    FontDocument doc;
+    SheetResult res;
+    if (!SheetSlicer::slice(sheet, dlg.options(), doc, &res) || doc.isEmpty()) {
+        QMessageBox::warning(this, "Импорт", "В листе не найдено ни одного глифа.");
+        return;
+    }
+    const int shared = replaceFont(std::move(doc));
+    statusBar()->showMessage(QString("Лист %1×%2: глифов %3, пустых %4, одинаковых %5, %6 мс")
+                                 .arg(res.columns).arg(res.rows).arg(res.imported).arg(res.blank).arg(shared)
+                                 .arg(res.elapsedNs / 1e6, 0, 'f', 1), 4000);
+}
+
+/**
+ * \brief Применить сдвиг, инверсию, очистку, размер, порог или глубину сразу ко многим глифам
+ *        (в фоне, с прогрессом и отменой).
+ * \details Задача работает с копией документа (арена общая, пока копия её не заменит),
+ *          поэтому отмена ничего не меняет, а шрифт подменяется целиком в GUI-потоке.
+ */
+void MainWindow::batchTransformGlyphs() {
+    if (m_font.isEmpty()) {
+        statusBar()->showMessage("Шрифт пуст", 1500);
+        return;
+    }
+    GlyphBatchDialog dlg(m_font.depth(), this);
+    GlyphTransform t;
+    QVector<QPair<quint32, quint32>> ranges;
+    if (dlg.exec() != QDialog::Accepted || !dlg.options(t, ranges))
+        return;
+    if (t.isIdentity(m_font.depth())) {
+        statusBar()->showMessage("Глифы не изменятся", 1500);
+        return;
+    }
+    storeCurrentGlyph();
+
+    QVector<int> glyphs;
+    for (int i = 0; i < m_font.glyphCount() && !ranges.isEmpty(); ++i) {
+        const quint32 cp = m_font.entry(i).codepoint;
+        for (const auto& r : ranges) {
+            if (cp >= r.first && cp <= r.second) {
+                glyphs.append(i);
+                break;
+            }
+        }
+    }
+    if (!ranges.isEmpty() && glyphs.isEmpty()) {
+        statusBar()->showMessage("В диапазонах нет глифов шрифта", 2000);
+        return;
+    }
+
+    FontDocument doc = m_font;
+    BatchResult res;
+    const bool finished = BackgroundTask::run(this, "Пакетная обработка глифов…", doc.glyphCount(),
+        [&](std::atomic<int>& done, const std::atomic<bool>& cancel) {
+            GlyphBatch::apply(doc, glyphs, t, &res, &done, &cancel);
+        });
+    if (!finished) {
+        statusBar()->showMessage("Пакетная обработка отменена", 2000);
+        return;
+    }
+    if (!res.error.isEmpty()) {
+        QMessageBox::warning(this, "Пакетная обработка", "Ошибка: " + res.error);
+        return;
+    }
+
+    const int current = m_currentGlyph;
+    m_font = std::move(doc);
+    m_currentGlyph = -1;
+    m_loadingGlyph = true;   // глиф сетки сейчас перезагрузится из документа
+    ui->pixelGrid->setDepth(m_font.depth());
+    m_loadingGlyph = false;
+    syncDepthControls();
+    m_glyphModel->reload();
+    onGlyphSelected(qBound(0, current, m_font.glyphCount() - 1));
+    m_glyphList->selectGlyph(m_currentGlyph);
+    setFontModified(true);
+    statusBar()->showMessage(QString("Обработано %1 глифов за %2 мс, одинаковых: %3, арена: %4 байт")
+                                 .arg(res.glyphs).arg(res.elapsedNs / 1e6, 0, 'f', 1)
+                                 .arg(res.shared).arg(res.arenaBytes), 4000);
+}
+
+/** \brief Док-панель обзора всей сетки: рамка видимой области, щелчок — переход. */
+void MainWindow::setupOverviewDock() {
+    auto *dock = new QDockWidget("Обзор", this);
+    dock->setObjectName("dockOverview");
+    dock->setWidget(new GridMinimap(ui->pixelGrid, ui->saGrid, dock));
+    addDockWidget(Qt::RightDockWidgetArea, dock);
+}
+
+/**
+ * \brief Меню "Трассировка": запись интервалов горячих путей и выгрузка для chrome://tracing.
+ * \details Пока запись включена, рядом с lblStatus показывается длительность последней операции.
+ */
+void MainWindow::setupTraceMenu() {
+    Trace::setThreadName("GUI");
+    m_traceTimer = new QTimer(this);
+    m_traceTimer->setInterval(250);
+    connect(m_traceTimer, &QTimer::timeout, this, &MainWindow::updateTraceStatus);
+
+    QMenu* menu = menuBar()->addMenu("Трассировка");
+    QAction* actRecord = menu->addAction("Запись");
+    actRecord->setCheckable(true);
+    auto apply = [this](bool on) {
+        Trace::setEnabled(on);
+        if (on) m_traceTimer->start();
+        else m_traceTimer->stop();
+        if (auto *lbl = statusBar()->findChild<QLabel*>("lblTrace"))
+            lbl->setVisible(on);
+    };
+    connect(actRecord, &QAction::toggled, this, apply);
+    actRecord->setChecked(Trace::isEnabled());
+    apply(Trace::isEnabled());
+
+    menu->addAction("Сохранить (Chrome trace JSON)…", this, [this] {
+        const QString fn = QFileDialog::getSaveFileName(this, "Сохранить трассировку", "trace.json",
+                                                        "Chrome trace (*.json);;All files (*.*)");
+        if (fn.isEmpty()) return;
+        QString error;
+        if (!Trace::writeChromeJson(fn, &error)) {
+            QMessageBox::warning(this, "Трассировка", QString("Не удалось записать %1: %2").arg(fn, error));
+            return;
+        }
+        statusBar()->showMessage(QString("Трассировка сохранена: %1").arg(fn), 2000);
+    });
+    menu->addAction("Очистить", this, [] { Trace::clear(); });
+}
+
+/** \brief Длительность последней операции (только при изменении). */
+void MainWindow::updateTraceStatus() {
+    const Trace::Operation op = Trace::lastOperation();
+    if (op.serial == m_traceSerial || !op.name) return;
+    m_traceSerial = op.serial;
+    if (auto *lbl = statusBar()->findChild<QLabel*>("lblTrace"))
+        lbl->setText(QString("%1: %2 мс").arg(QString::fromLatin1(op.name)).arg(op.durationNs / 1e6, 0, 'f', 3));
+}
+
+/**
+ * \brief Заменить документ шрифта целиком и открыть первый глиф.
+ * \param dedup Склеить одинаковые глифы (FontDocument::deduplicate()); проект из файла
+ *              уже склеен, и проход по всем глифам лишь подгрузил бы их страницы.
+ * \return Число склеенных глифов.
+ */
+int MainWindow::replaceFont(FontDocument&& doc, bool dedup) {
+    m_font = std::move(doc);
+    const int shared = dedup ? m_font.deduplicate() : 0;
+    m_currentGlyph = -1;
+    ui->pixelGrid->setDepth(m_font.depth());
+    syncDepthControls();
+    m_glyphModel->reload();
+    m_glyphList->selectGlyph(0);
+    setFontModified(true);
+    return shared;
+}
+
+void MainWindow::setFontModified(bool modified) {
+    m_fontModified = modified;
+    const QString name = m_projectPath.isEmpty() ? QString("без имени") : QFileInfo(m_projectPath).fileName();
+    setWindowTitle(QString("%1[*] — FontCreator").arg(name));
+    setWindowModified(modified);
+}
+
+/** \brief Открыть проект: файл отображается в память, глифы подгружаются по обращению. */
+void MainWindow::openProject() {
+    const QString fn = QFileDialog::getOpenFileName(this, "Открыть проект", QString(),
+                                                    QString("Проект FontCreator (*.%1);;All files (*.*)")
+                                                        .arg(ProjectFile::suffix()));
+    if (fn.isEmpty()) return;
+
+    FontDocument doc;
+    ProjectResult res;
+    if (!ProjectFile::load(fn, doc, &res)) {
+        QMessageBox::warning(this, "Проект", res.error);
+        return;
+    }
+    m_projectPath = fn;
+    replaceFont(std::move(doc), false);
+    setFontModified(false);
+    statusBar()->showMessage(QString("Проект: %1 глифов, %2 КБ, %3 мс%4")
+                                 .arg(m_font.glyphCount()).arg(res.fileBytes / 1024)
+                                 .arg(res.elapsedNs / 1e6, 0, 'f', 2)
+                                 .arg(res.mapped ? ", отображён в память" : ""), 4000);
+}
+
+/** \brief Сохранить в текущий файл проекта; без изменений файл не переписывается. */
+bool MainWindow::saveProject() {
+    if (m_projectPath.isEmpty())
+        return saveProjectAs();
+    storeCurrentGlyph();
+    if (!m_fontModified) {
+        statusBar()->showMessage("Проект не изменён", 1500);
+        return true;
+    }
+    return writeProject(m_projectPath);
+}
+
+bool MainWindow::saveProjectAs() {
+    const QString fn = QFileDialog::getSaveFileName(this, "Сохранить проект",
+                                                    m_projectPath.isEmpty() ? QString("font.%1").arg(ProjectFile::suffix())
+                                                                            : m_projectPath,
+                                                    QString("Проект FontCreator (*.%1)").arg(ProjectFile::suffix()));
+    if (fn.isEmpty()) return false;
+    storeCurrentGlyph();
+    return writeProject(fn);
+}
+
+bool MainWindow::writeProject(const QString& path) {
+    // Файл, из которого отображена арена, нельзя заменить, пока отображение живо (Windows).
+    m_font.detachArena();
+    ProjectResult res;
+    if (!ProjectFile::save(path, m_font, &res)) {
+        QMessageBox::warning(this, "Проект", res.error);
+        return false;
+    }
+    m_projectPath = path;
+    setFontModified(false);
+    statusBar()->showMessage(QString("Сохранено: %1 (%2 КБ, %3 мс)")
+                                 .arg(path).arg(res.fileBytes / 1024).arg(res.elapsedNs / 1e6, 0, 'f', 1), 2500);
+    return true;
+}
+
+/** \brief Экспорт всего документа одной C-таблицей в teOutput. */
+void MainWindow::exportFontC() {
+    if (m_font.isEmpty()) {
+        statusBar()->showMessage("Шрифт пуст", 1500);
+        return;
+    }
+    storeCurrentGlyph();
+    FontExportStats stats;
+    ui->teOutput->setPlainText(FontExport::toC(m_font, "font", fontExportOptions(), &stats));
+    showFontExportStats(stats);
+}
+
+/** \brief Экспорт всего документа в C-файл потоково, минуя teOutput. */
+void MainWindow::exportFontCFile() {
+    if (m_font.isEmpty()) {
+        statusBar()->showMessage("Шрифт пуст", 1500);
+        return;
+    }
+    const QString fn = QFileDialog::getSaveFileName(this, "Экспорт шрифта", "font.h",
+                                                    "C/C++ (*.h *.c);;All files (*.*)");
+    if (fn.isEmpty()) return;
+    storeCurrentGlyph();
+
+    QFile f(fn);
+    FontExportStats stats;
+    const QString name = QFileInfo(fn).completeBaseName().replace(QRegularExpression("[^A-Za-z0-9_]"), "_");
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)
+        || !FontExport::writeC(&f, m_font, name, fontExportOptions(), &stats)) {
+        QMessageBox::warning(this, "Ошибка", "Не удалось записать файл.");
+        return;
+    }
+    showFontExportStats(stats);
+}
+
+/** \brief Атлас всех глифов в 1-битный PNG/BMP (серый шрифт — 8-битный с палитрой). */
+void MainWindow::exportFontAtlas() {
+    if (m_font.isEmpty()) {
+        statusBar()->showMessage("Шрифт пуст", 1500);
+        return;
+    }
+    const QString fn = QFileDialog::getSaveFileName(this, "Экспорт атласа", "atlas.png",
+                                                    "PNG image (*.png);;BMP image (*.bmp)");
+    if (fn.isEmpty()) return;
+    storeCurrentGlyph();
+
+    const QImage atlas = FontExport::toAtlas(m_font);
+    if (atlas.isNull() || !atlas.save(fn)) {
+        QMessageBox::warning(this, "Экспорт", "Не удалось сохранить атлас.");
+        return;
+    }
+    statusBar()->showMessage(QString("Атлас %1x%2 сохранён: %3").arg(atlas.width()).arg(atlas.height()).arg(fn), 2000);
+}
+
+/** \brief Добавить диапазон пустых глифов текущего размера сетки. */
+void MainWindow::createGlyphRange() {
+    const int before = m_font.glyphCount();
+    m_font.addRange(quint32(m_sbFirstCode->value()), m_sbGlyphCount->value(),
+                    ui->pixelGrid->rows(), ui->pixelGrid->cols() * m_font.depth());
+    m_glyphModel->reload();
+    setFontModified(true);
+    if (m_currentGlyph < 0 && m_font.glyphCount() > 0)
+        m_glyphList->selectGlyph(0);
+    statusBar()->showMessage(QString("Глифов: %1 (+%2), арена: %3 байт")
+                                 .arg(m_font.glyphCount())
+                                 .arg(m_font.glyphCount() - before)
+                                 .arg(m_font.arenaBytes()), 2500);
+}
+
+/** \brief Загрузить выбранный глиф в редактор (O(размер глифа)). */
+void MainWindow::onGlyphSelected(int glyphIndex) {
+    if (glyphIndex < 0 || glyphIndex >= m_font.glyphCount() || glyphIndex == m_currentGlyph)
+        return;
+    m_currentGlyph = glyphIndex;
+
+    m_loadingGlyph = true;
+    ui->pixelGrid->setBits(m_font.glyph(glyphIndex), m_font.depth());
+    m_loadingGlyph = false;
+
+    ui->sbRows->setValue(ui->pixelGrid->rows());
+    ui->sbCols->setValue(ui->pixelGrid->cols());
+    resizeGridWidgetToHint();
+    updateStatus();
+}
+
+/** \brief Сохранить содержимое редактора в текущий глиф документа. */
+void MainWindow::storeCurrentGlyph() {
+    if (m_loadingGlyph || m_currentGlyph < 0 || m_currentGlyph >= m_font.glyphCount())
+        return;
+    if (!m_font.setGlyph(m_currentGlyph, ui->pixelGrid->bits())) {
+        statusBar()->showMessage("Глиф больше 65535 строк или бит в строке — не сохранён", 2500);
+        return;
+    }
+    m_glyphModel->glyphChanged(m_currentGlyph);
+    if (!m_fontModified) setFontModified(true);
+}
 
 void MainWindow::applyGridFromControls() {
-    int bpr  = ui->sbBytesPerRow->value();
+    int cols = ui->sbCols->value();
     int rows = ui->sbRows->value();
-    ui->pixelGrid->resizeGridPreserve(rows, bpr);
+    ui->pixelGrid->resizeGridPreserve(rows, cols);
     ui->pixelGrid->setMsbFirst(ui->cbMsbFirst->isChecked());
+    ui->pixelGrid->setPackLayout(packFormat().layout);
     resizeGridWidgetToHint();
     updateStatus();
 }
 
-/** \brief Парсер байтов из текста с поддержкой "0x"/"0X" и десятичного формата.
- *  \details Регистронезависимый матчинг префикса 0x/0X. Десятичные числа до 255.
- */
-QVector<quint8> MainWindow::parseBytes(const QString& text) {
-    QString s = text;
-    s.replace(QRegularExpression(R"(//[^\n\r]*)"), " "); // убрать // комменты
-    QRegularExpression rx(
-        R"(0x([0-9A-Fa-f]{1,2})|\b(\d{1,3})\b)",
-        QRegularExpression::CaseInsensitiveOption  // <<< важно: 0x/0X
-        );
-    QVector<quint8> out;
-    auto it = rx.globalMatch(s);
-    while (it.hasNext()) {
-        auto m = it.next();
-        bool ok=false; int v=0;
-        if (m.captured(1).size()) v = m.captured(1).toInt(&ok,16);
-        else                       v = m.captured(2).toInt(&ok,10);
-        if (ok && v>=0 && v<=255) out.push_back(static_cast<quint8>(v));
-    }
-    return out;
+PackFormat MainWindow::packFormat() const {
+    return { PackLayout(qBound(0, ui->cbLayout->currentIndex(), 2)), ui->cbMsbFirst->isChecked() };
 }
 
 void MainWindow::importFromText() {
-    const int bpr  = ui->sbBytesPerRow->value();
-    const bool msb = ui->cbMsbFirst->isChecked();
-    QVector<quint8> bytes = parseBytes(ui->teInput->toPlainText());
+    applyImportedBytes(GlyphIO::parseBytes(ui->teInput->toPlainText()));
+}
+
+bool MainWindow::applyImportedBytes(const QVector<quint8>& bytes) {
+    const int cols = ui->sbCols->value();
+    const PackFormat fmt = packFormat();
     if (bytes.isEmpty()) {
         QMessageBox::warning(this, "Импорт", "Не найдено байтов в тексте.");
-        return;
+        return false;
     }
-    if (bytes.size() % bpr != 0) {
+    // Серые уровни всегда построчно: строка — ⌈cols · depth / 8⌉ байт.
+    const int depth = ui->pixelGrid->depth();
+    const bool rowMajor = depth > 1 || fmt.layout == PackLayout::RowMajor;
+    const int rows = depth > 1 ? BitPacker::rowsFor({ PackLayout::RowMajor, true }, bytes.size(), cols * depth)
+                               : BitPacker::rowsFor(fmt, bytes.size(), cols);
+    if (rows <= 0) {
         QMessageBox::warning(this, "Импорт",
-                             QString("Число байтов (%1) не кратно байтам на строку (%2).")
-                                 .arg(bytes.size()).arg(bpr));
-        return;
+                             rowMajor
+                                 ? QString("Число байтов (%1) не кратно байтам на строку (%2 = ⌈%3 / 8⌉).")
+                                       .arg(bytes.size()).arg((cols * depth + 7) / 8).arg(cols * depth)
+                                 : QString("Число байтов (%1) не кратно ширине в столбцах (%2).")
+                                       .arg(bytes.size()).arg(cols));
+        return false;
     }
-    int rows = bytes.size() / bpr;
     ui->sbRows->setValue(rows);
-    if (!ui->pixelGrid->importBytes(bytes, bpr, msb)) {
+    if (!ui->pixelGrid->importBytes(bytes, cols, fmt)) {
         QMessageBox::warning(this, "Импорт", "Не удалось импортировать.");
-        return;
+        return false;
     }
     resizeGridWidgetToHint();
     updateStatus();
+    return true;
+}
+
+/**
+ * \brief Импорт файла напрямую: QFile::map + разбор в фоне, минуя QPlainTextEdit.
+ * \details В teInput попадает только начало файла (предпросмотр).
+ */
+void MainWindow::importFile() {
+    const QString fn = QFileDialog::getOpenFileName(this, "Импорт файла", QString(),
+                                                    "Text/Headers (*.txt *.h *.hpp *.c *.cpp *.inc);;All files (*.*)");
+    if (fn.isEmpty()) return;
+    const QFileInfo fi(fn);
+
+    QVector<quint8> bytes;
+    bool opened = true;
+    const bool finished = BackgroundTask::run(this, "Разбор " + fi.fileName() + "…", int(fi.size() >> 10),
+        [&](std::atomic<int>& done, const std::atomic<bool>& cancel) {
+            opened = GlyphIO::parseFile(fn, bytes, &done, &cancel) || cancel.load();
+        });
+    if (!finished) {
+        statusBar()->showMessage("Импорт файла отменён", 2000);
+        return;
+    }
+    if (!opened) {
+        QMessageBox::warning(this, "Ошибка", "Не удалось открыть файл.");
+        return;
+    }
+
+    showFilePreview(fn);
+    if (applyImportedBytes(bytes))
+        statusBar()->showMessage(QString("Импортировано: %1 байт из %2 КБ текста")
+                                     .arg(bytes.size()).arg(fi.size() >> 10), 2500);
+}
+
+void MainWindow::showFilePreview(const QString& fileName) {
+    constexpr qint64 kPreviewBytes = 64 * 1024;
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly)) return;
+    QByteArray head = f.read(kPreviewBytes);
+    if (f.size() > head.size()) {
+        const int nl = head.lastIndexOf('\n');
+        if (nl > 0) head.truncate(nl + 1);
+        head += QString("// … предпросмотр: %1 КБ из %2 КБ\n")
+                    .arg(head.size() >> 10).arg(f.size() >> 10).toUtf8();
+    }
+    ui->teInput->setPlainText(QString::fromUtf8(head));
 }
 
 void MainWindow::openFileDialog() {
@@ -188,39 +930,28 @@ void MainWindow::exportC() {
 }
 /** \brief Экспорт только байтов в стиле "0xFE, 0x07, ..." (0x — нижний регистр). */
 void MainWindow::exportBytes() {
-    auto bytes = ui->pixelGrid->exportBytes();
-    QStringList xs;
-    xs.reserve(bytes.size());
-    for (auto b : bytes) {
-        const QString hex = QString::number(b, 16).rightJustified(2, QLatin1Char('0')).toUpper();
-        xs << QString("0x%1").arg(hex);  // "0x" остаётся нижним, цифры — верхние
-    }
-    ui->teOutput->setPlainText(xs.join(", "));
+    ui->teOutput->setPlainText(GlyphIO::formatHexList(ui->pixelGrid->exportBytes()));
     statusBar()->showMessage("Экспорт: только байты", 1500);
 }
 
-/** \brief Экспорт Python-списка байтов в стиле ["0xFE", ...] с 0x в нижнем регистре. */
+/** \brief Экспорт Python-списка байтов в стиле [0xFE, ...] с 0x в нижнем регистре. */
 void MainWindow::exportPy() {
-    auto bytes = ui->pixelGrid->exportBytes();
-    QStringList xs;
-    xs.reserve(bytes.size());
-    for (auto b : bytes) {
-        const QString hex = QString::number(b, 16).rightJustified(2, QLatin1Char('0')).toUpper();
-        xs << QString("0x%1").arg(hex);
-    }
-    ui->teOutput->setPlainText("[" + xs.join(", ") + "]");
+    ui->teOutput->setPlainText(GlyphIO::formatPyList(ui->pixelGrid->exportBytes()));
     statusBar()->showMessage("Экспорт: Python list", 1500);
 }
 
 void MainWindow::updateStatus() {
     auto *lbl = statusBar()->findChild<QLabel*>("lblStatus");
     if (!lbl) return;
-    lbl->setText(QString("%1×%2 бит, %3 байт/строка, MSB слева: %4, клетка: %5")
+    lbl->setText(QString("%1×%2 пикс. по %3 бит, %4 байт/строка, раскладка: %5, MSB первым: %6, клетка: %7")
                      .arg(ui->pixelGrid->cols())
                      .arg(ui->pixelGrid->rows())
+                     .arg(ui->pixelGrid->depth())
                      .arg(ui->pixelGrid->bytesPerRow())
+                     .arg(BitPacker::name(ui->pixelGrid->depth() > 1 ? PackLayout::RowMajor : ui->pixelGrid->packLayout()))
                      .arg(ui->pixelGrid->msbFirst() ? "да" : "нет")
-                     .arg(ui->pixelGrid->cellSize()));
+                     .arg(ui->pixelGrid->zoomShrink() > 1 ? QString("1:%1").arg(ui->pixelGrid->zoomShrink())
+                                                          : QString("%1 px").arg(ui->pixelGrid->cellSize())));
 }
 
 void MainWindow::importBmp() {
@@ -235,7 +966,10 @@ void MainWindow::importBmp() {
         return;
     }
 
-    if (!ui->pixelGrid->importFromImage(img, /*autoResize=*/true, /*threshold=*/128, /*invert=*/false)) {
+    ImageImportDialog dlg(img, this);
+    if (dlg.exec() != QDialog::Accepted) return;
+
+    if (!ui->pixelGrid->importFromImage(img, /*autoResize=*/true, dlg.options())) {
         QMessageBox::warning(this, "Импорт", "Не удалось импортировать картинку.");
         return;
     }
@@ -245,68 +979,90 @@ void MainWindow::importBmp() {
 
 void MainWindow::exportBmp() {
     const QString fn = QFileDialog::getSaveFileName(
-        this, "Экспорт BMP", "glyph.bmp", "BMP image (*.bmp)");
+        this, "Экспорт BMP", "glyph.bmp", "BMP image (*.bmp);;PNG image (*.png)");
     if (fn.isEmpty()) return;
 
-    QImage img = ui->pixelGrid->toQImage();
+    // 1-битное изображение → 1-битный BMP/PNG; серый глиф — 8-битный с палитрой уровней
+    const QImage img = ui->pixelGrid->toQImage();
     if (!img.save(fn)) {
-        QMessageBox::warning(this, "Экспорт", "Не удалось сохранить BMP.");
+        QMessageBox::warning(this, "Экспорт", "Не удалось сохранить изображение.");
         return;
     }
     statusBar()->showMessage(QString("Сохранено: %1").arg(fn), 1500);
 }
 
-/** \brief Преобразовать байты в строку вида "\xNN\xAB..." (префикс \x — нижний регистр). */
-QString MainWindow::bytesToEscapedHex(const QByteArray& bytes) const {
-    QString out;
-    out.reserve(bytes.size() * 4);
-    for (unsigned char b : bytes) {
-        const QString hex = QString::number(int(b), 16).rightJustified(2, QLatin1Char('0')).toUpper();
-        out += "\\x" + hex;  // \x остаётся нижним, цифры — верхние
-    }
-    return out;
-}
-
-/** \brief Спарсить строку с \xNN / 0xNN / NN (регистронезависимо для \x/0x). */
-QByteArray MainWindow::parseHexString(const QString& s) const {
-    QByteArray res;
-    QRegularExpression rx(
-        R"(\\x([0-9A-Fa-f]{2})|0x([0-9A-Fa-f]{2})|([0-9A-Fa-f]{2}))",
-        QRegularExpression::CaseInsensitiveOption   // <<< важно: \x/0x и \X/0X
-        );
-    auto it = rx.globalMatch(s);
-    while (it.hasNext()) {
-        auto m = it.next();
-        QString hh = !m.captured(1).isEmpty() ? m.captured(1)
-                     : !m.captured(2).isEmpty() ? m.captured(2)
-                                                : m.captured(3);
-        bool ok = false;
-        int v = hh.toInt(&ok, 16);
-        if (ok) res.append(char(v));
-    }
-    return res;
-}
-
 void MainWindow::onTextToHexChanged() {
+    FC_TRACE_SCOPE("MainWindow::onTextToHexChanged");
     if (m_convBusy) return;
-    if (!ui->plainTextEdit || !ui->plainTextEdit_2) return;
-    m_convBusy = true;
-    const QByteArray bytes = ui->plainTextEdit->toPlainText().toLocal8Bit(); // CP1251 на русской Windows
-    const QString hex = bytesToEscapedHex(bytes);
-    ui->plainTextEdit_2->blockSignals(true);
-    ui->plainTextEdit_2->setPlainText(hex);
-    ui->plainTextEdit_2->blockSignals(false);
-    m_convBusy = false;
+    scheduleConversion(HexConverter::Direction::TextToHex);
 }
 
 void MainWindow::onHexToTextChanged() {
+    FC_TRACE_SCOPE("MainWindow::onHexToTextChanged");
     if (m_convBusy) return;
+    scheduleConversion(HexConverter::Direction::HexToText);
+}
+
+/**
+ * \brief Отложить преобразование: таймер перезапускается на каждое нажатие.
+ * \details Правка другого редактора до срабатывания таймера сначала запускает ждущее
+ *          преобразование прежнего направления — иначе первая правка не попала бы никуда.
+ */
+void MainWindow::scheduleConversion(HexConverter::Direction dir) {
     if (!ui->plainTextEdit || !ui->plainTextEdit_2) return;
-    m_convBusy = true;
-    const QByteArray bytes = parseHexString(ui->plainTextEdit_2->toPlainText());
-    const QString txt = QString::fromLocal8Bit(bytes); // обратно из CP1251 (или локальной ANSI) в Unicode
-    ui->plainTextEdit->blockSignals(true);
-    ui->plainTextEdit->setPlainText(txt);
-    ui->plainTextEdit->blockSignals(false);
-    m_convBusy = false;
+    if (dir != m_convDir && m_convTimer->isActive()) {
+        m_convTimer->stop();
+        startConversion(m_convDir);
+    }
+    m_convDir = dir;
+    ++m_convGen[int(dir)];
+    m_convTimer->start();
+}
+
+/**
+ * \brief Снять текст источника и преобразовать его в пуле (одна задача за раз).
+ * \details Если задача ещё идёт, направление встаёт в очередь и запускается после неё,
+ *          в порядке правок.
+ */
+void MainWindow::startConversion(HexConverter::Direction dir) {
+    FC_TRACE_SCOPE("MainWindow::startConversion");
+    if (m_convRunning) {
+        if (!m_convQueue.contains(dir)) m_convQueue.append(dir);
+        return;
+    }
+    const bool toHex = dir == HexConverter::Direction::TextToHex;
+    const QString text = (toHex ? ui->plainTextEdit : ui->plainTextEdit_2)->toPlainText();
+    const std::shared_ptr<HexConverter> conv = toHex ? m_textToHex : m_hexToText;
+    const quint64 gen = m_convGen[int(dir)];
+    m_convRunning = true;
+
+    QPointer<MainWindow> self(this);
+    WorkStealingPool::global().submit([self, conv, text, gen, dir] {
+        QElapsedTimer t;
+        t.start();
+        const QString out = conv->convert(text);
+        const int lines = conv->lastConverted();
+        const double ms = t.nsecsElapsed() / 1e6;
+        QMetaObject::invokeMethod(qApp, [self, out, gen, dir, lines, ms] {
+            if (self) self->finishConversion(out, gen, dir, lines, ms);
+        }, Qt::QueuedConnection);
+    });
+}
+
+/** \brief Результат задачи: правка другого редактора по разнице (если текст не менялся). */
+void MainWindow::finishConversion(const QString& out, quint64 gen, HexConverter::Direction dir, int lines, double ms) {
+    FC_TRACE_SCOPE("MainWindow::finishConversion");
+    m_convRunning = false;
+    if (gen == m_convGen[int(dir)]) {
+        QPlainTextEdit* dst = dir == HexConverter::Direction::TextToHex ? ui->plainTextEdit_2 : ui->plainTextEdit;
+        m_convBusy = true;
+        dst->blockSignals(true);
+        const int inserted = TextDiff::apply(dst->document(), out);
+        dst->blockSignals(false);
+        m_convBusy = false;
+        statusBar()->showMessage(QString("Конвертор: строк заново %1, %2 мс, вставлено %3 симв.")
+                                     .arg(lines).arg(ms, 0, 'f', 2).arg(inserted), 1500);
+    }
+    if (!m_convQueue.isEmpty())
+        startConversion(m_convQueue.takeFirst());
 }
@@ -1,12 +1,26 @@
 #pragma once
 #include <QMainWindow>
 #include <QVector>
+#include <memory>
+#include "bitpacker.h"
+#include "fontdocument.h"
+#include "fontexport.h"
+#include "glyphcodec.h"
+#include "hexconverter.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
 
 class PixelGridWidget;
+class FontGlyphModel;
+class GlyphListView;
+class TextPreviewWidget;
+class QActionGroup;
+class QComboBox;
+class QSpinBox;
+class QTimer;
+class QToolBar;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -19,6 +33,7 @@ private slots:
     void applyGridFromControls();
     void importFromText();
     void openFileDialog();
+    void importFile();
     void exportC();
     void exportBytes();
     void exportPy();
@@ -26,20 +41,89 @@ private slots:
     void exportBmp();
     void updateStatus();
     void resizeGridWidgetToHint();
+    void applyZoom();
+
+    // Шрифт (набор глифов)
+    void createGlyphRange();
+    void onGlyphSelected(int glyphIndex);
+    void storeCurrentGlyph();
+    void importFontFile();
+    void importGlyphSheet();
+    void batchTransformGlyphs();
+    void exportFontC();
+    void exportFontCFile();
+    void exportFontAtlas();
+    void openProject();
+    bool saveProject();
+    bool saveProjectAs();
 
     // Конвертор текста (вкладка)
     void onTextToHexChanged();   // plainTextEdit  -> plainTextEdit_2
     void onHexToTextChanged();   // plainTextEdit_2 -> plainTextEdit
+    void startConversion(HexConverter::Direction dir);
+    void updateTraceStatus();
 
 private:
     Ui::MainWindow* ui;
 
-    // Вспомогательное: парс/формат \xNN
-    QString    bytesToEscapedHex(const QByteArray& bytes) const;
-    QByteArray parseHexString(const QString& s) const;
+    // Применить разобранные байты к сетке (общая часть импорта из текста и файла)
+    bool applyImportedBytes(const QVector<quint8>& bytes);
+    // Усечённый предпросмотр файла в teInput
+    void showFilePreview(const QString& fileName);
+
+    // Шрифт: документ, список глифов и текущий редактируемый глиф
+    void setupFontDock();
+    void setupPreviewDock();
+    void setupOverviewDock();
+    void setupEditMenu();
+    void setupFontMenu();
+    void setupTraceMenu();
+    void setupPaletteToolBar();
+    /// \brief Глубина пикселя шрифта и сетки (GrayDepth): глифы переводятся в новую глубину.
+    void setFontDepth(int depth);
+    /// \brief Выбор глубины и палитра уровней по глубине текущего шрифта.
+    void syncDepthControls();
+    int  replaceFont(FontDocument&& doc, bool dedup = true);
+    /// \brief Отметить изменение шрифта (для сохранения проекта и заголовка окна).
+    void setFontModified(bool modified);
+    bool writeProject(const QString& path);
+    /// \brief Раскладка и порядок бит из элементов управления глифа.
+    PackFormat packFormat() const;
+    /// \brief Параметры экспорта шрифта в C из меню "Шрифт" и элементов управления.
+    FontExportOptions fontExportOptions() const;
+    void showFontExportStats(const FontExportStats& stats);
+    FontDocument    m_font;
+    FontGlyphModel* m_glyphModel = nullptr;
+    GlyphListView*  m_glyphList  = nullptr;
+    TextPreviewWidget* m_preview = nullptr;
+    QSpinBox*       m_sbFirstCode = nullptr;
+    QSpinBox*       m_sbGlyphCount = nullptr;
+    QComboBox*      m_cbDepth = nullptr;      ///< глубина пикселя шрифта: 1, 2 или 4 бита
+    QToolBar*       m_paletteBar = nullptr;   ///< уровни серого для рисования (depth > 1)
+    QActionGroup*   m_paletteGroup = nullptr;
+    int             m_currentGlyph = -1;
+    bool            m_loadingGlyph = false;
+    GlyphCodecKind  m_fontCodec = GlyphCodecKind::Raw; ///< сжатие при экспорте шрифта в C
+    bool            m_fontTrim  = false;               ///< обрезка глифов по содержимому при экспорте
+    bool            m_fontBitstream = false;           ///< экспорт шрифта плотным потоком бит (BitStream)
+    QString         m_projectPath;                     ///< файл проекта (*.fcp) или пусто
+    bool            m_fontModified = false;            ///< есть несохранённые изменения шрифта
+
+    // Конвертор текста: отложенное преобразование в пуле, правка другого редактора по разнице
+    void scheduleConversion(HexConverter::Direction dir);
+    void finishConversion(const QString& out, quint64 gen, HexConverter::Direction dir, int lines, double ms);
+    std::shared_ptr<HexConverter> m_textToHex = std::make_shared<HexConverter>(HexConverter::Direction::TextToHex);
+    std::shared_ptr<HexConverter> m_hexToText = std::make_shared<HexConverter>(HexConverter::Direction::HexToText);
+    QTimer*                 m_convTimer = nullptr;
+    HexConverter::Direction m_convDir = HexConverter::Direction::TextToHex;
+    quint64                 m_convGen[2] = {};   ///< номер последней правки источника, по направлениям
+    bool                    m_convRunning = false;
+    QVector<HexConverter::Direction> m_convQueue; ///< направления, правленные во время задачи
+
+    // Трассировка: опрос последней операции для строки состояния
+    QTimer* m_traceTimer = nullptr;
+    quint64 m_traceSerial = 0;
 
     // Гард от рекурсий при взаимном обновлении полей
     bool m_convBusy = false;
-
-    static QVector<quint8> parseBytes(const QString& text);
 };
@@ -1,22 +1,33 @@
 // pixelgridwidget.cpp
 #include "pixelgridwidget.h"
+#include "glyphio.h"
+#include "trace.h"
 #include <QPainter>
 #include <QMouseEvent>
 #include <QImage>
+#include <QPaintEvent>
 #include <algorithm>
 
 /** \brief Конструктор: включаем трекинг мыши и инициализируем сетку. */
 PixelGridWidget::PixelGridWidget(QWidget* parent) : QWidget(parent) {
     setMouseTracking(true);
     // Важно: setGridSize внутри не вызывает виртуальные методы (используем calcSizeHint()).
-    setGridSize(m_rows, m_cols/8);
+    setGridSize(m_rows, m_cols);
+    m_history.clear(); // начальная сетка — не шаг истории
 }
 
 /** \brief Невиртуальный расчёт рекомендуемого размера (учитывает клетки и зазоры). */
 QSize PixelGridWidget::calcSizeHint() const {
-    int w = m_cols * (m_cell + m_gap) + m_gap;
-    int h = m_rows * (m_cell + m_gap) + m_gap;
-    return { std::max(200, w), std::max(150, h) };
+    const QSize s = contentSize();
+    return { std::max(200, s.width()), std::max(150, s.height()) };
+}
+
+/** \brief Область клеток: с рамками — (cell + gap) на клетку, в обзоре — ⌈n · cell / shrink⌉. */
+QSize PixelGridWidget::contentSize() const {
+    if (isLod())
+        return { int((qint64(m_cols) * m_cell + m_shrink - 1) / m_shrink),
+                 int((qint64(m_rows) * m_cell + m_shrink - 1) / m_shrink) };
+    return { m_cols * (m_cell + m_gap) + m_gap, m_rows * (m_cell + m_gap) + m_gap };
 }
 
 /** \brief Виртуальный sizeHint(), делегирует в невиртуальный расчёт. */
@@ -25,54 +36,79 @@ QSize PixelGridWidget::sizeHint() const {
 }
 
 /** \brief Установить новый размер сетки, полностью очистив содержимое. */
-void PixelGridWidget::setGridSize(int rows, int bytesPerRow) {
+void PixelGridWidget::setGridSize(int rows, int cols) {
+    beginEdit();
     m_rows = std::max(1, rows);
-    m_cols = std::max(1, bytesPerRow) * 8;
+    m_cols = std::max(1, cols);
 
-    m_bits.resize(m_rows * m_cols);
-    m_bits.fill(false);
+    m_bits.reset(m_rows, m_cols * m_depth);
+    endEdit();
 
     updateGeometry();
     setMinimumSize(calcSizeHint());   // не трогаем виртуальные методы
-    update();
+    contentChanged();
     emit changed();
 }
 
 /** \brief Изменить размер сетки с сохранением пересекаемой области. */
-void PixelGridWidget::resizeGridPreserve(int rows, int bytesPerRow) {
+void PixelGridWidget::resizeGridPreserve(int rows, int cols) {
     const int newRows = std::max(1, rows);
-    const int newCols = std::max(1, bytesPerRow) * 8;
+    const int newCols = std::max(1, cols);
 
     if (newRows == m_rows && newCols == m_cols)
         return;
 
-    const int oldRows = m_rows;
-    const int oldCols = m_cols;
-    const QBitArray oldBits = m_bits;
-
+    beginEdit();
     m_rows = newRows;
     m_cols = newCols;
+    m_bits = m_bits.resized(m_rows, m_cols * m_depth);
+    endEdit();
 
-    QBitArray newBits(m_rows * m_cols);
-    newBits.fill(false);
-
-    const int copyRows = std::min(oldRows, m_rows);
-    const int copyCols = std::min(oldCols, m_cols);
-    for (int r = 0; r < copyRows; ++r)
-        for (int c = 0; c < copyCols; ++c)
-            newBits.setBit(r * m_cols + c, oldBits.testBit(r * oldCols + c));
+    updateGeometry();
+    setMinimumSize(calcSizeHint());
+    contentChanged();
+    emit changed();
+}
 
-    m_bits = std::move(newBits);
+/** \brief Заменить содержимое сетки готовой плоскостью (копия разделяемая, O(1)). */
+void PixelGridWidget::setBits(const BitPlane& bits, int depth) {
+    if (GrayDepth::isValid(depth) && depth != m_depth) {
+        m_depth = depth;
+        m_paintLevel = levels() - 1;
+    }
+    m_rows = std::max(1, bits.rows());
+    m_cols = std::max(1, bits.cols() / m_depth);
+    m_bits = (bits.rows() == m_rows && bits.cols() == m_cols * m_depth) ? bits
+                                                                        : bits.resized(m_rows, m_cols * m_depth);
+    m_history.clear(); // другой глиф — своя история
+    emit historyChanged();
 
     updateGeometry();
     setMinimumSize(calcSizeHint());
-    update();
+    contentChanged();
     emit changed();
 }
 
-/** \brief Установить размер клетки и обновить геометрию. */
-void PixelGridWidget::setCellSize(int px) {
-    m_cell = std::clamp(px, 6, 64);
+/** \brief Перевести рисунок в новую глубину пикселя; история правок начинается заново. */
+void PixelGridWidget::setDepth(int depth) {
+    if (!GrayDepth::isValid(depth) || depth == m_depth) return;
+    m_bits = GrayDepth::convert(m_bits, m_depth, depth);
+    m_depth = depth;
+    m_paintLevel = levels() - 1;
+    m_history.clear();
+    emit historyChanged();
+    contentChanged();
+    emit changed();
+}
+
+/**
+ * \brief Установить масштаб и обновить геометрию.
+ * \details Уменьшение (shrink > 1) — только при клетке 1 px. Плитки прежнего масштаба
+ *          остаются в кэше: возврат к нему не перерисовывает их заново.
+ */
+void PixelGridWidget::setZoom(int cell, int shrink) {
+    m_cell = std::clamp(cell, 1, 64);
+    m_shrink = m_cell == 1 ? std::clamp(shrink, 1, 16) : 1;
     updateGeometry();
     setMinimumSize(calcSizeHint());
     update();
@@ -80,125 +116,100 @@ void PixelGridWidget::setCellSize(int px) {
 
 /** \brief Очистить всю сетку. */
 void PixelGridWidget::clear() {
+    beginEdit();
     m_bits.fill(false);
-    update();
+    endEdit();
+    contentChanged();
     emit changed();
 }
 
 /** \brief Инвертировать все пиксели. */
 void PixelGridWidget::invert() {
-    for (int i = 0; i < m_bits.size(); ++i)
-        m_bits.setBit(i, !m_bits.testBit(i));
-    update();
+    beginEdit();
+    m_bits.invert();
+    endEdit();
+    contentChanged();
     emit changed();
 }
 
-/** \brief Сдвинуть изображение влево на 1 пиксель. */
+/** \brief Сдвинуть изображение влево на 1 пиксель (depth бит строки). */
 void PixelGridWidget::shiftLeft() {
-    for (int r = 0; r < m_rows; ++r) {
-        int base = r * m_cols;
-        for (int c = 0; c < m_cols - 1; ++c)
-            m_bits.setBit(base + c, m_bits.testBit(base + c + 1));
-        m_bits.clearBit(base + m_cols - 1);
-    }
-    update();
+    beginEdit();
+    for (int i = 0; i < m_depth; ++i)
+        m_bits.shiftLeft();
+    endEdit();
+    contentChanged();
     emit changed();
 }
 
-/** \brief Сдвинуть изображение вправо на 1 пиксель. */
+/** \brief Сдвинуть изображение вправо на 1 пиксель (depth бит строки). */
 void PixelGridWidget::shiftRight() {
-    for (int r = 0; r < m_rows; ++r) {
-        int base = r * m_cols;
-        for (int c = m_cols - 1; c > 0; --c)
-            m_bits.setBit(base + c, m_bits.testBit(base + c - 1));
-        m_bits.clearBit(base);
-    }
-    update();
+    beginEdit();
+    for (int i = 0; i < m_depth; ++i)
+        m_bits.shiftRight();
+    endEdit();
+    contentChanged();
     emit changed();
 }
 
 /** \brief Сдвинуть изображение вверх на 1 пиксель. */
 void PixelGridWidget::shiftUp() {
-    for (int r = 0; r < m_rows - 1; ++r)
-        for (int c = 0; c < m_cols; ++c)
-            m_bits.setBit(r * m_cols + c, m_bits.testBit((r + 1) * m_cols + c));
-    for (int c = 0; c < m_cols; ++c)
-        m_bits.clearBit((m_rows - 1) * m_cols + c);
-    update();
+    beginEdit();
+    m_bits.shiftUp();
+    endEdit();
+    contentChanged();
     emit changed();
 }
 
 /** \brief Сдвинуть изображение вниз на 1 пиксель. */
 void PixelGridWidget::shiftDown() {
-    for (int r = m_rows - 1; r > 0; --r)
-        for (int c = 0; c < m_cols; ++c)
-            m_bits.setBit(r * m_cols + c, m_bits.testBit((r - 1) * m_cols + c));
-    for (int c = 0; c < m_cols; ++c)
-        m_bits.clearBit(c);
-    update();
+    beginEdit();
+    m_bits.shiftDown();
+    endEdit();
+    contentChanged();
     emit changed();
 }
 
 /**
  * \brief Импорт массива байтов в сетку.
  * \param bytes     Последовательность байтов.
- * \param bpr       Байты на строку.
- * \param msbFirst  true — старший бит слева; false — младший слева.
+ * \param cols      Ширина сетки в пикселях (строка занимает ⌈cols / 8⌉ байт).
+ * \param format    Раскладка и порядок бит; число строк выводится из размера массива.
  * \return Успех/неуспех.
  */
-bool PixelGridWidget::importBytes(const QVector<quint8>& bytes, int bpr, bool msbFirst) {
-    if (bpr <= 0 || bytes.isEmpty() || (bytes.size() % bpr) != 0)
+bool PixelGridWidget::importBytes(const QVector<quint8>& bytes, int cols, const PackFormat& format) {
+    FC_TRACE_OPERATION("PixelGridWidget::importBytes");
+    // Серые уровни — только построчно: байт не делится между строками и столбцами пикселей.
+    const PackFormat packed = m_depth > 1 ? PackFormat{ PackLayout::RowMajor, true } : format;
+    const int h = cols > 0 ? BitPacker::rowsFor(packed, bytes.size(), cols * m_depth) : -1;
+    if (bytes.isEmpty() || h <= 0)
         return false;
 
-    const int h = bytes.size() / bpr;
-    setGridSize(h, bpr);
-    m_msbFirst = msbFirst;
-
-    int idx = 0;
-    for (int r = 0; r < m_rows; ++r) {
-        for (int b = 0; b < bpr; ++b) {
-            quint8 V = bytes[idx++];
-            if (m_msbFirst) {
-                for (int bit = 7; bit >= 0; --bit) {
-                    int col = b * 8 + (7 - bit);
-                    setPixel(r, col, (V >> bit) & 1);
-                }
-            } else {
-                for (int bit = 0; bit < 8; ++bit) {
-                    int col = b * 8 + bit;
-                    setPixel(r, col, (V >> bit) & 1);
-                }
-            }
-        }
+    beginEdit();
+    setGridSize(h, cols);
+    m_format = format;
+
+    const BitPacker::MutableRows dst{ m_bits.rowBytes(0), m_bits.strideBytes(), h, cols * m_depth };
+    if (m_depth > 1 && !format.msbFirst) {
+        QVector<quint8> msb = bytes;
+        GrayDepth::reversePixels(msb.data(), msb.size(), m_depth);
+        BitPacker::unpack(msb.constData(), dst, packed);
+    } else {
+        BitPacker::unpack(bytes.constData(), dst, packed);
     }
+    endEdit();
 
     setMinimumSize(calcSizeHint());
-    update();
+    contentChanged();
     emit changed();
     return true;
 }
 
 /** \brief Экспорт текущей сетки в массив байтов. */
 QVector<quint8> PixelGridWidget::exportBytes() const {
-    const int bpr = m_cols / 8;
-    QVector<quint8> out;
-    out.resize(m_rows * bpr);
-
-    int idx = 0;
-    for (int r = 0; r < m_rows; ++r) {
-        for (int b = 0; b < bpr; ++b) {
-            quint8 V = 0;
-            for (int x = 0; x < 8; ++x) {
-                const bool pix = pixel(r, b * 8 + x);
-                if (m_msbFirst)
-                    V |= (pix ? 1 : 0) << (7 - x);
-                else
-                    V |= (pix ? 1 : 0) << x;
-            }
-            out[idx++] = V;
-        }
-    }
-    return out;
+    FC_TRACE_OPERATION("PixelGridWidget::exportBytes");
+    return m_depth > 1 ? GlyphIO::exportLevels(m_bits, m_depth, m_format.msbFirst)
+                       : GlyphIO::exportBytes(m_bits, m_format);
 }
 
 /**
@@ -206,44 +217,14 @@ QVector<quint8> PixelGridWidget::exportBytes() const {
  * \details Префикс всегда `0x` (нижний регистр), гекс-цифры — верхний регистр.
  */
 QString PixelGridWidget::exportCWithAscii() const {
-    QString out;
-    const int bpr = m_cols / 8;
-
-    for (int r = 0; r < m_rows; ++r) {
-        QStringList hexes;
-        hexes.reserve(bpr);
-
-        for (int b = 0; b < bpr; ++b) {
-            quint8 V = 0;
-            for (int x = 0; x < 8; ++x) {
-                const bool pix = pixel(r, b * 8 + x);
-                if (m_msbFirst) V |= (pix ? 1 : 0) << (7 - x);
-                else            V |= (pix ? 1 : 0) << x;
-            }
-            const QString hx = QString::number(V, 16).rightJustified(2, QLatin1Char('0')).toUpper();
-            hexes << ("0x" + hx); // "0x" — нижний, цифры — верхние
-        }
-
-        QString art;
-        art.reserve(m_cols);
-        for (int c = 0; c < m_cols; ++c)
-            art += pixel(r, c) ? QLatin1Char('#') : QLatin1Char(' ');
-
-        // clazy: используем многоаргументную перегрузку вместо .arg(...).arg(...)
-        out += QStringLiteral("    %1,  // %2\n").arg(hexes.join(", "), art);
-    }
-    return out;
+    FC_TRACE_OPERATION("PixelGridWidget::exportCWithAscii");
+    return GlyphIO::exportCWithAscii(m_bits, m_depth, m_format);
 }
 
-/** \brief Сконвертировать в QImage (чёрный/белый). */
+/** \brief 1-битное QImage (Format_Mono) поверх буфера сетки, без копии; серый глиф — Indexed8. */
 QImage PixelGridWidget::toQImage() const {
-    QImage img(m_cols, m_rows, QImage::Format_ARGB32);
-    img.fill(Qt::white);
-    for (int r = 0; r < m_rows; ++r)
-        for (int c = 0; c < m_cols; ++c)
-            if (pixel(r, c))
-                img.setPixelColor(c, r, Qt::black);
-    return img;
+    FC_TRACE_OPERATION("PixelGridWidget::toQImage");
+    return GlyphIO::toImage(m_bits, m_depth);
 }
 
 /**
@@ -254,62 +235,195 @@ QImage PixelGridWidget::toQImage() const {
  * \param invert      Инвертировать после бинаризации.
  */
 bool PixelGridWidget::importFromImage(const QImage& src, bool autoResize, int threshold, bool invert) {
+    BinarizeOptions opt;
+    opt.threshold = threshold;
+    opt.invert = invert;
+    return importFromImage(src, autoResize, opt);
+}
+
+bool PixelGridWidget::importFromImage(const QImage& src, bool autoResize, const BinarizeOptions& opt) {
+    FC_TRACE_OPERATION("PixelGridWidget::importFromImage");
     if (src.isNull()) return false;
 
-    QImage g = src.convertToFormat(QImage::Format_Grayscale8);
-    const int w = g.width();
-    const int h = g.height();
+    beginEdit();
+    if (autoResize)
+        setGridSize(src.height(), src.width());
+
+    if (m_depth > 1)
+        GlyphIO::imageToLevels(src, m_bits, m_depth, opt.invert);
+    else
+        Binarizer::binarize(src, m_bits, opt);
+    endEdit();
+
+    setMinimumSize(calcSizeHint());
+    contentChanged();
+    emit changed();
+    return true;
+}
+
+/** \brief Прямоугольник клетки (r,c) в координатах виджета (без рамки). */
+QRect PixelGridWidget::cellRect(int r, int c) const {
+    if (isLod()) {
+        // В обзоре клетка может быть меньше пикселя: берётся пиксель, куда она попадает.
+        const int x0 = int(qint64(c) * m_cell / m_shrink), x1 = int(qint64(c + 1) * m_cell / m_shrink);
+        const int y0 = int(qint64(r) * m_cell / m_shrink), y1 = int(qint64(r + 1) * m_cell / m_shrink);
+        return { x0, y0, std::max(1, x1 - x0), std::max(1, y1 - y0) };
+    }
+    return { m_gap + c * (m_cell + m_gap), m_gap + r * (m_cell + m_gap), m_cell, m_cell };
+}
+
+/**
+ * \brief Плитка линий сетки на один период клетки (cell + gap), прозрачная внутри.
+ * \details Строится один раз на размер клетки; рамка клетки занимает [0..cell] по обеим осям,
+ *          как у прежнего drawRect(cell) пером 1 px.
+ */
+const QPixmap& PixelGridWidget::gridTile() {
+    const int period = m_cell + m_gap;
+    if (m_gridTile.isNull() || m_gridTile.width() != period) {
+        QImage tile(period, period, QImage::Format_ARGB32_Premultiplied);
+        tile.fill(Qt::transparent);
+        const QRgb line = qRgb(220, 220, 220);
+        for (int i = 0; i <= std::min(m_cell, period - 1); ++i) {
+            tile.setPixel(i, 0, line);
+            tile.setPixel(0, i, line);
+            if (m_cell < period) {
+                tile.setPixel(i, m_cell, line);
+                tile.setPixel(m_cell, i, line);
+            }
+        }
+        m_gridTile = QPixmap::fromImage(tile);
+    }
+    return m_gridTile;
+}
+
+/**
+ * \brief Отрисовка только открытой области: заливка залитых клеток отрезками по строкам
+ *        и линии сетки одной плиткой из кэша.
+ */
+void PixelGridWidget::paintEvent(QPaintEvent* e) {
+    FC_TRACE_SCOPE("PixelGridWidget::paintEvent");
+    QElapsedTimer frame;
+    frame.start();
+
+    QPainter p(this);
+    const QRect exposed = e->rect();
+    p.fillRect(exposed, Qt::white);
+    if (isLod()) {
+        paintLod(p, exposed & QRect(QPoint(), contentSize()));
+        recordFrame(frame.nsecsElapsed());
+        return;
+    }
+
+    const int period = m_cell + m_gap;
+    const QRect content(m_gap, m_gap, m_cols * period, m_rows * period);
+    const QRect area = exposed & content;
+    if (!area.isEmpty()) {
+        const int c0 = (area.left()   - m_gap) / period;
+        const int c1 = std::min(m_cols - 1, (area.right()  - m_gap) / period);
+        const int r0 = (area.top()    - m_gap) / period;
+        const int r1 = std::min(m_rows - 1, (area.bottom() - m_gap) / period);
+
+        // Соседние клетки строки одного уровня — один fillRect (зазоры закроет сетка).
+        for (int r = r0; r <= r1; ++r) {
+            int c = c0;
+            while (c <= c1) {
+                const int v = pixel(r, c);
+                if (!v) { ++c; continue; }
+                const int start = c;
+                while (c <= c1 && pixel(r, c) == v) ++c;
+                const QRect a = cellRect(r, start), b = cellRect(r, c - 1);
+                const int shade = GrayDepth::shade(v, m_depth);
+                p.fillRect(QRect(a.topLeft(), b.bottomRight()), QColor(shade, shade, shade));
+            }
+        }
 
-    if (autoResize) {
-        const int bpr = (w + 7) / 8;
-        setGridSize(h, bpr);
+        p.drawTiledPixmap(area, gridTile(), QPoint((area.left() - m_gap) % period,
+                                                   (area.top()  - m_gap) % period));
     }
 
-    const int useW = std::min(m_cols, w);
-    const int useH = std::min(m_rows, h);
+    recordFrame(frame.nsecsElapsed());
+}
+
+/**
+ * \brief Уровень детализации: открытая область закрывается плитками кэша; промах строит
+ *        плитку из битов (ближайший сосед), так что прокрутка перерисовывает лишь новые края.
+ */
+void PixelGridWidget::paintLod(QPainter& p, const QRect& area) {
+    if (area.isEmpty()) return;
+    for (int ty = area.top() / kLodTile; ty <= area.bottom() / kLodTile; ++ty)
+        for (int tx = area.left() / kLodTile; tx <= area.right() / kLodTile; ++tx)
+            p.drawPixmap(tx * kLodTile, ty * kLodTile, lodTile(tx, ty));
+}
 
-    clear();
+namespace {
+/// \brief Плиток в кэше (~256 КБ каждая в формате экрана): хватает на несколько экранов и масштабов.
+constexpr int kMaxLodTiles = 192;
 
-    for (int y = 0; y < useH; ++y) {
-        for (int x = 0; x < useW; ++x) {
-            const int gray = qGray(g.pixel(x, y));
-            bool on = (gray < threshold);
-            if (invert) on = !on;
-            setPixel(y, x, on);
+quint64 tileKey(int cell, int shrink, int tx, int ty) {
+    return quint64(cell << 8 | shrink) << 48 | quint64(quint32(ty)) << 24 | quint32(tx);
+}
+} // namespace
+
+const QPixmap& PixelGridWidget::lodTile(int tx, int ty) {
+    const quint64 key = tileKey(m_cell, m_shrink, tx, ty);
+    auto it = m_tiles.find(key);
+    if (it == m_tiles.end()) {
+        if (m_tiles.size() >= kMaxLodTiles) {
+            auto oldest = m_tiles.begin();
+            for (auto i = m_tiles.begin(); i != m_tiles.end(); ++i)
+                if (i->used < oldest->used) oldest = i;
+            m_tiles.erase(oldest);
         }
+        const QRect target(tx * kLodTile, ty * kLodTile, kLodTile, kLodTile);
+        it = m_tiles.insert(key, { QPixmap::fromImage(GlyphIO::renderNearest(m_bits, m_depth, m_cell, m_shrink, target)), 0 });
     }
+    it->used = ++m_tileClock;
+    return it->pixmap;
+}
 
-    setMinimumSize(calcSizeHint());
+void PixelGridWidget::dropTiles(const QRect& area) {
+    const quint64 level = tileKey(m_cell, m_shrink, 0, 0);
+    const int tx0 = area.left() / kLodTile, tx1 = area.right() / kLodTile;
+    const int ty0 = area.top() / kLodTile,  ty1 = area.bottom() / kLodTile;
+    for (auto it = m_tiles.begin(); it != m_tiles.end();) {
+        const quint64 key = it.key();
+        const int tx = int(key & 0xFFFFFF), ty = int((key >> 24) & 0xFFFFFF);
+        const bool stale = (key & ~quint64(0xFFFFFFFFFFFF)) != level || !isLod()
+                        || (tx >= tx0 && tx <= tx1 && ty >= ty0 && ty <= ty1);
+        if (stale) it = m_tiles.erase(it);
+        else ++it;
+    }
+}
+
+void PixelGridWidget::contentChanged() {
+    m_tiles.clear();
     update();
-    emit changed();
-    return true;
 }
 
-/** \brief Отрисовка сетки и клеток. */
-void PixelGridWidget::paintEvent(QPaintEvent*) {
-    QPainter p(this);
-    p.fillRect(rect(), Qt::white);
-
-    const int cw = m_cell, ch = m_cell;
-    const int gap = m_gap;
-
-    for (int r = 0; r < m_rows; ++r) {
-        for (int c = 0; c < m_cols; ++c) {
-            const int x = gap + c * (cw + gap);
-            const int y = gap + r * (ch + gap);
-            const QRect cell(x, y, cw, ch);
-            p.fillRect(cell, pixel(r, c) ? Qt::black : Qt::white);
-            p.setPen(QColor(220, 220, 220));
-            p.drawRect(cell);
-        }
+/** \brief Учёт времени кадра; раз в секунду — сигнал со средним временем и частотой. */
+void PixelGridWidget::recordFrame(qint64 paintNs) {
+    if (!m_statWindow.isValid())
+        m_statWindow.start();
+    m_lastPaintMs = paintNs / 1e6;
+    m_statPaintNs += paintNs;
+    ++m_statFrames;
+
+    const qint64 windowMs = m_statWindow.elapsed();
+    if (windowMs >= 1000) {
+        emit frameStats(m_statPaintNs / 1e6 / m_statFrames, m_statFrames * 1000.0 / windowMs);
+        m_statPaintNs = 0;
+        m_statFrames = 0;
+        m_statWindow.restart();
     }
 }
 
 /** \brief Координаты мыши → индексы клетки. */
 bool PixelGridWidget::posToCell(const QPoint& pt, int& r, int& c) const {
-    const int cw = m_cell, ch = m_cell, gap = m_gap;
-    const int col = (pt.x() - gap) / (cw + gap);
-    const int row = (pt.y() - gap) / (ch + gap);
+    if (pt.x() < 0 || pt.y() < 0)
+        return false;
+    const int cw = m_cell, ch = m_cell, gap = isLod() ? 0 : m_gap;
+    const int col = int(qint64(pt.x() - gap) * m_shrink / (cw + gap));
+    const int row = int(qint64(pt.y() - gap) * m_shrink / (ch + gap));
     if (row < 0 || col < 0 || row >= m_rows || col >= m_cols)
         return false;
     r = row;
@@ -321,11 +435,12 @@ bool PixelGridWidget::posToCell(const QPoint& pt, int& r, int& c) const {
 void PixelGridWidget::mousePressEvent(QMouseEvent* e) {
     int r, c;
     if (!posToCell(e->pos(), r, c)) return;
-    if (e->button() == Qt::LeftButton)  m_drawValue = true;
-    if (e->button() == Qt::RightButton) m_drawValue = false;
+    if (e->button() == Qt::LeftButton)  m_drawValue = m_depth > 1 ? m_paintLevel : 1;
+    if (e->button() == Qt::RightButton) m_drawValue = 0;
+    beginEdit(); // весь штрих до отпускания кнопки — один шаг истории
     setPixel(r, c, m_drawValue);
     m_drag = true;
-    update();
+    updateCell(r, c);
     emit changed();
 }
 
@@ -334,14 +449,60 @@ void PixelGridWidget::mouseMoveEvent(QMouseEvent* e) {
     if (!m_drag) return;
     int r, c;
     if (!posToCell(e->pos(), r, c)) return;
+    if (pixel(r, c) == m_drawValue) return; // нечего перерисовывать
     setPixel(r, c, m_drawValue);
-    update();
+    updateCell(r, c);
+}
+
+/** \brief Запросить перерисовку одной клетки вместе с её рамкой. */
+void PixelGridWidget::updateCell(int r, int c) {
+    const QRect rc = cellRect(r, c).adjusted(-1, -1, 1, 1);
+    if (!m_tiles.isEmpty()) dropTiles(rc);
+    update(rc);
 }
 
 /** \brief Отпускание кнопки мыши — завершаем рисование. */
 void PixelGridWidget::mouseReleaseEvent(QMouseEvent*) {
     if (m_drag) {
         m_drag = false;
+        endEdit();
         emit changed();
     }
 }
+
+/** \brief Открыть шаг истории (вложенные вызовы объединяются в один шаг). */
+void PixelGridWidget::beginEdit() {
+    m_history.begin(m_bits);
+}
+
+/** \brief Закрыть шаг истории; на внешнем уровне фиксирует XOR-дельту. */
+void PixelGridWidget::endEdit() {
+    if (m_history.commit(m_bits))
+        emit historyChanged();
+}
+
+/** \brief Применить состояние после undo/redo: размер мог измениться. */
+void PixelGridWidget::applyHistoryState() {
+    const bool resized = m_bits.rows() != m_rows || m_bits.cols() != m_cols * m_depth;
+    m_rows = m_bits.rows();
+    m_cols = m_bits.cols() / m_depth;
+    if (resized) {
+        updateGeometry();
+        setMinimumSize(calcSizeHint());
+    }
+    contentChanged();
+    emit changed();
+    emit historyChanged();
+}
+
+/** \brief Отменить последний шаг. */
+void PixelGridWidget::undo() {
+    if (m_history.undo(m_bits))
+        applyHistoryState();
+}
+
+/** \brief Повторить отменённый шаг. */
+void PixelGridWidget::redo() {
+    if (m_history.redo(m_bits))
+        applyHistoryState();
+}
@@ -1,13 +1,31 @@
 // pixelgridwidget.h
 #pragma once
 #include <QWidget>
-#include <QBitArray>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QImage>
+#include <QPixmap>
+#include "binarizer.h"
+#include "bitpacker.h"
+#include "bitplane.h"
+#include "glyphhistory.h"
+#include "graydepth.h"
+
+class QPainter;
 
 /**
  * \brief Виджет редактирования пиксельной сетки глифа.
- * \details Хранит биты в QBitArray построчно, позволяет рисовать мышью,
+ * \details Хранит биты в BitPlane (строки выровнены на 64-битные слова), позволяет рисовать мышью,
  *          сдвигать, инвертировать, импортировать/экспортировать байты и изображения.
+ *
+ *          Клетки от kDetailCell px рисуются с рамками. Мельче (вплоть до 1/16 px на пиксель)
+ *          включается уровень детализации: видимая часть собирается из плиток kLodTile × kLodTile,
+ *          отрисованных GlyphIO::renderNearest без сетки. Плитки кэшируются по масштабу и
+ *          сбрасываются при изменении рисунка; штрих мышью сбрасывает только свои плитки.
+ *
+ *          При глубине 2 или 4 бита (setDepth()) пиксель — уровень серого (GrayDepth): плоскость
+ *          шириной cols() · depth() бит, клетки закрашиваются оттенком уровня, левая кнопка
+ *          рисует уровнем paintLevel(), правая стирает.
  */
 class PixelGridWidget : public QWidget {
     Q_OBJECT
@@ -17,31 +35,63 @@ public:
 
     /**
      * \brief Установить размер сетки, очистив содержимое.
-     * \param rows        Количество строк (в пикселях).
-     * \param bytesPerRow Байты в строке (ширина = bytesPerRow * 8).
+     * \param rows Количество строк (в пикселях).
+     * \param cols Ширина в пикселях, любая (не обязательно кратная 8).
      * \note Полностью сбрасывает текущий рисунок.
      */
-    void setGridSize(int rows, int bytesPerRow);
+    void setGridSize(int rows, int cols);
 
     /**
      * \brief Изменить размер сетки с сохранением рисунка в общей области.
-     * \param rows        Новое число строк.
-     * \param bytesPerRow Новое число байт на строку.
+     * \param rows Новое число строк.
+     * \param cols Новая ширина в пикселях.
      * \details Общая область (min(old,new)) копируется, добавленные зоны заполняются 0.
      */
-    void resizeGridPreserve(int rows, int bytesPerRow);
+    void resizeGridPreserve(int rows, int cols);
 
     /// \name Параметры геометрии/состояния
     /// @{
     int rows()  const { return m_rows; }
     int cols()  const { return m_cols; }
-    int bytesPerRow() const { return m_cols/8; }
-
-    void setMsbFirst(bool v) { m_msbFirst = v; }
-    bool msbFirst() const { return m_msbFirst; }
+    /** \brief Байт на строку в построчной раскладке: ⌈cols · depth / 8⌉. */
+    int bytesPerRow() const { return (m_cols * m_depth + 7) / 8; }
 
-    void setCellSize(int px);
+    /**
+     * \brief Глубина пикселя (1, 2 или 4 бита, GrayDepth): рисунок переводится в новую глубину.
+     * \details История правок сбрасывается: её шаги относятся к прежней раскладке бит.
+     */
+    void setDepth(int depth);
+    int  depth() const { return m_depth; }
+    /** \brief Число уровней пикселя: 2, 4 или 16. */
+    int  levels() const { return GrayDepth::levels(m_depth); }
+    /** \brief Уровень, которым рисует левая кнопка (1…levels() − 1). */
+    void setPaintLevel(int level) { m_paintLevel = qBound(1, level, levels() - 1); }
+    int  paintLevel() const { return m_paintLevel; }
+
+    void setMsbFirst(bool v) { m_format.msbFirst = v; }
+    bool msbFirst() const { return m_format.msbFirst; }
+    /** \brief Раскладка байтов для импорта/экспорта (строки, столбцы, страницы). */
+    void setPackLayout(PackLayout layout) { m_format.layout = layout; }
+    PackLayout packLayout() const { return m_format.layout; }
+    const PackFormat& packFormat() const { return m_format; }
+
+    /// \brief Наименьшая клетка с рамками; мельче — уровень детализации без сетки.
+    static constexpr int kDetailCell = 6;
+    /// \brief Сторона плитки уровня детализации, px.
+    static constexpr int kLodTile = 256;
+
+    /** \brief Клетка px × px (1…64). */
+    void setCellSize(int px) { setZoom(px, 1); }
+    /** \brief Масштаб: cell экранных пикселей на shrink пикселей глифа (shrink — уменьшение обзора). */
+    void setZoom(int cell, int shrink = 1);
     int  cellSize() const { return m_cell; }
+    int  zoomShrink() const { return m_shrink; }
+    /** \brief Экранных пикселей на пиксель глифа. */
+    double scale() const { return double(m_cell) / m_shrink; }
+    /** \brief Включён уровень детализации (клетки мельче kDetailCell). */
+    bool isLod() const { return m_cell < kDetailCell; }
+    /** \brief Размер области клеток в координатах виджета (без добавки до минимального размера). */
+    QSize contentSize() const;
     /// @}
 
     /// \name Редактирование
@@ -54,14 +104,52 @@ public:
     void shiftDown();
     /// @}
 
+    /// \name История правок (undo/redo)
+    /// @{
+    void undo();
+    void redo();
+    bool canUndo() const { return m_history.canUndo(); }
+    bool canRedo() const { return m_history.canRedo(); }
+    /** \brief Бюджет памяти истории, байты (старые шаги вытесняются). */
+    void setHistoryBudget(qsizetype bytes) { m_history.setBudget(bytes); emit historyChanged(); }
+    const GlyphHistory& history() const { return m_history; }
+    /// @}
+
+    /// \name Прямой доступ к битам (загрузка глифа из документа)
+    /// @{
+    const BitPlane& bits() const { return m_bits; }
+    /**
+     * \brief Заменить содержимое сетки готовой плоскостью.
+     * \details Размер сетки берётся из плоскости (ширина — bits.cols() / depth пикселей).
+     */
+    void setBits(const BitPlane& bits, int depth = 1);
+    /// @}
+
     /// \name Импорт/экспорт байтов и изображений
     /// @{
-    bool importBytes(const QVector<quint8>& bytes, int bytesPerRow, bool msbFirst);
+    /**
+     * \brief Байты в сетку шириной cols пикселей.
+     * \details При depth() > 1 байты — уровни exportLevels() (построчно, раскладка формата
+     *          не учитывается, msbFirst — порядок пикселей в байте).
+     */
+    bool importBytes(const QVector<quint8>& bytes, int cols, const PackFormat& format);
     QVector<quint8> exportBytes() const;
     QString exportCWithAscii() const;
 
     QImage toQImage() const;
     bool importFromImage(const QImage& src, bool autoResize = true, int threshold = 128, bool invert = false);
+    /**
+     * \brief Импорт с выбором режима бинаризации (порог, Оцу, дизеринг).
+     * \details При depth() > 1 яркость квантуется в уровни (GlyphIO::imageToLevels()),
+     *          из параметров учитывается только invert.
+     */
+    bool importFromImage(const QImage& src, bool autoResize, const BinarizeOptions& opt);
+    /// @}
+
+    /// \name Статистика отрисовки
+    /// @{
+    /** \brief Время последнего paintEvent, мс. */
+    double lastPaintMs() const { return m_lastPaintMs; }
     /// @}
 
     /// \name Размерные подсказки для layout/scroll area
@@ -74,6 +162,13 @@ public:
 signals:
     /** \brief Сигнал о том, что содержимое сетки изменилось. */
     void changed();
+    /**
+     * \brief Раз в секунду: среднее время paintEvent (мс) и число кадров в секунду.
+     * \details Позволяет проверить, что рисование мышью держит частоту обновления экрана.
+     */
+    void frameStats(double avgPaintMs, double fps);
+    /** \brief Изменилось состояние истории (можно обновить доступность undo/redo). */
+    void historyChanged();
 
 protected:
     void paintEvent(QPaintEvent*) override;
@@ -82,12 +177,38 @@ protected:
     void mouseReleaseEvent(QMouseEvent*) override;
 
 private:
-    /// \brief Прочитать бит пикселя (r,c).
-    inline bool pixel(int r, int c) const { return m_bits.testBit(r*m_cols + c); }
-    /// \brief Установить бит пикселя (r,c).
-    inline void setPixel(int r, int c, bool on) { m_bits.setBit(r*m_cols + c, on); }
+    /// \brief Уровень пикселя (r,c) (при глубине 1 — бит).
+    inline int pixel(int r, int c) const {
+        return m_depth == 1 ? int(m_bits.pixel(r, c)) : GrayDepth::level(m_bits, m_depth, r, c);
+    }
+    /// \brief Установить уровень пикселя (r,c).
+    inline void setPixel(int r, int c, int level) {
+        if (m_depth == 1) m_bits.setPixel(r, c, level != 0);
+        else GrayDepth::setLevel(m_bits, m_depth, r, c, level);
+    }
     /// \brief Преобразовать координату курсора в индексы ячейки.
     bool posToCell(const QPoint& p, int& r, int& c) const;
+    /// \brief Прямоугольник клетки (r,c) в координатах виджета.
+    QRect cellRect(int r, int c) const;
+    /// \brief Перерисовать только клетку (r,c).
+    void updateCell(int r, int c);
+    /// \brief Кэшированная плитка линий сетки на один период клетки.
+    const QPixmap& gridTile();
+    /// \brief Отрисовка уровня детализации: плитки из кэша поверх area.
+    void paintLod(QPainter& p, const QRect& area);
+    /// \brief Плитка (tx, ty) текущего масштаба (строится при промахе кэша).
+    const QPixmap& lodTile(int tx, int ty);
+    /// \brief Сбросить плитки, задевающие area текущего масштаба, и все плитки других масштабов.
+    void dropTiles(const QRect& area);
+    /// \brief Рисунок изменился целиком: сбросить плитки и перерисовать.
+    void contentChanged();
+    /// \brief Открыть/закрыть шаг истории вокруг правки.
+    void beginEdit();
+    void endEdit();
+    /// \brief Синхронизировать геометрию после undo/redo.
+    void applyHistoryState();
+    /// \brief Учесть время кадра для frameStats().
+    void recordFrame(qint64 paintNs);
 
     /**
      * \brief Невиртуальный расчёт рекомендуемого размера виджета по текущей сетке.
@@ -98,13 +219,32 @@ private:
 
     // --- Параметры сетки и хранение битов ---
     int       m_rows = 26;
-    int       m_cols = 16; ///< 2 байта * 8 = 16 колонок по умолчанию
+    int       m_cols = 16; ///< ширина в пикселях, по умолчанию 16
+    int       m_depth = 1; ///< бит на пиксель (GrayDepth); ширина m_bits — m_cols · m_depth
+    int       m_paintLevel = 1;
     int       m_cell = 18; ///< размер клетки в пикселях
+    int       m_shrink = 1; ///< пикселей глифа на m_cell экранных (обзор мельче 1 px)
     int       m_gap  = 1;  ///< зазор между клетками
-    QBitArray m_bits;
-    bool      m_msbFirst = true;
+    BitPlane  m_bits;
+    PackFormat m_format;
+
+    // --- История правок ---
+    GlyphHistory m_history;
+
+    // --- Кэш отрисовки и статистика кадров ---
+    struct LodTile {
+        QPixmap pixmap;
+        quint64 used = 0;   ///< m_tileClock последнего обращения (вытесняется самая старая)
+    };
+    QPixmap       m_gridTile;
+    QHash<quint64, LodTile> m_tiles;   ///< ключ: масштаб, строка и столбец плитки
+    quint64       m_tileClock = 0;
+    QElapsedTimer m_statWindow;
+    qint64        m_statPaintNs = 0;
+    int           m_statFrames = 0;
+    double        m_lastPaintMs = 0.0;
 
     // --- Временные состояния ввода мышью ---
     bool m_drag = false;
-    bool m_drawValue = true;
+    int  m_drawValue = 1;   ///< уровень, которым идёт штрих (0 — стирание)
 };
@@ -0,0 +1,191 @@
+// projectfile.cpp
+#include "projectfile.h"
+#include "fontdocument.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSaveFile>
+#include <QVector>
+#include <QtEndian>
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+namespace ProjectFile {
+
+namespace {
+
+constexpr char      kMagic[8] = { 'F', 'C', 'P', 'R', 'O', 'J', '\r', '\n' };
+constexpr int       kHeaderSize = 64;
+constexpr int       kRecordSize = 16;
+constexpr qsizetype kArenaAlign = 4096;
+
+// Смещения полей заголовка.
+constexpr int kVersionAt    = 8;   // quint16
+constexpr int kHeaderSizeAt = 10;  // quint16
+constexpr int kCountAt      = 12;  // quint32
+constexpr int kIndexAt      = 16;  // quint64
+constexpr int kArenaAt      = 24;  // quint64
+constexpr int kArenaSizeAt  = 32;  // quint64
+constexpr int kDepthAt      = 40;  // quint16, с версии 2 (в версии 1 — всегда 1)
+
+// Запись индекса на диске — та же раскладка, что у GlyphEntry.
+static_assert(sizeof(GlyphEntry) == kRecordSize, "GlyphEntry must match the index record");
+static_assert(offsetof(GlyphEntry, codepoint) == 0 && offsetof(GlyphEntry, offset) == 4
+                  && offsetof(GlyphEntry, rows) == 8 && offsetof(GlyphEntry, cols) == 10
+                  && offsetof(GlyphEntry, advance) == 12 && offsetof(GlyphEntry, flags) == 14,
+              "GlyphEntry layout must match the index record");
+
+qsizetype alignUp(qsizetype v, qsizetype a) { return (v + a - 1) / a * a; }
+
+bool fail(ProjectResult* result, const QString& message) {
+    if (result) result->error = message;
+    return false;
+}
+
+/// \brief Разобрать индекс: memcpy на little-endian машине, иначе поле за полем.
+void readIndex(const uchar* src, int count, QVector<GlyphEntry>& entries) {
+    entries.resize(count);
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    std::memcpy(entries.data(), src, size_t(count) * kRecordSize);
+#else
+    for (int i = 0; i < count; ++i, src += kRecordSize) {
+        GlyphEntry& e = entries[i];
+        e.codepoint = qFromLittleEndian<quint32>(src);
+        e.offset    = qFromLittleEndian<quint32>(src + 4);
+        e.rows      = qFromLittleEndian<quint16>(src + 8);
+        e.cols      = qFromLittleEndian<quint16>(src + 10);
+        e.advance   = qFromLittleEndian<quint16>(src + 12);
+        e.flags     = qFromLittleEndian<quint16>(src + 14);
+    }
+#endif
+}
+
+} // namespace
+
+bool load(const QString& path, FontDocument& doc, ProjectResult* result) {
+    QElapsedTimer timer;
+    timer.start();
+    if (result) *result = {};
+
+    auto file = std::make_shared<QFile>(path);
+    if (!file->open(QIODevice::ReadOnly))
+        return fail(result, QString("Не удалось открыть %1: %2").arg(path, file->errorString()));
+    const qint64 size = file->size();
+    if (size < kHeaderSize)
+        return fail(result, "Файл слишком короткий для проекта.");
+
+    // Отображение в память; без него — чтение целиком (например, на сетевых ФС).
+    QByteArray owned;
+    const uchar* base = file->map(0, size);
+    if (!base) {
+        owned = file->readAll();
+        if (owned.size() != size)
+            return fail(result, "Не удалось прочитать файл.");
+        base = reinterpret_cast<const uchar*>(owned.constData());
+    }
+
+    if (std::memcmp(base, kMagic, sizeof kMagic) != 0)
+        return fail(result, "Это не файл проекта FontCreator.");
+    const quint16 version = qFromLittleEndian<quint16>(base + kVersionAt);
+    if (version == 0 || version > kVersion)
+        return fail(result, QString("Версия проекта %1 не поддерживается (максимум %2).").arg(version).arg(kVersion));
+    const quint16 headerSize = qFromLittleEndian<quint16>(base + kHeaderSizeAt);
+    const quint32 count      = qFromLittleEndian<quint32>(base + kCountAt);
+    const quint64 indexAt    = qFromLittleEndian<quint64>(base + kIndexAt);
+    const quint64 arenaAt    = qFromLittleEndian<quint64>(base + kArenaAt);
+    const quint64 arenaSize  = qFromLittleEndian<quint64>(base + kArenaSizeAt);
+    const int     depth      = version >= 2 ? qFromLittleEndian<quint16>(base + kDepthAt) : 1;
+    if (headerSize < kHeaderSize || count > quint32(INT_MAX / kRecordSize)
+        || indexAt < headerSize || indexAt + quint64(count) * kRecordSize > quint64(size)
+        || arenaAt > quint64(size) || arenaSize > quint64(size) - arenaAt)
+        return fail(result, "Повреждённый заголовок проекта.");
+
+    QVector<GlyphEntry> entries;
+    readIndex(base + indexAt, int(count), entries);
+
+    QByteArray arena;
+    std::shared_ptr<const void> backing;
+    if (owned.isEmpty()) {
+        arena = QByteArray::fromRawData(reinterpret_cast<const char*>(base + arenaAt), qsizetype(arenaSize));
+        backing = file;   // отображение живёт, пока открыт файл
+    } else {
+        arena = owned.mid(qsizetype(arenaAt), qsizetype(arenaSize));
+    }
+    if (!doc.assign(arena, entries, backing, depth))
+        return fail(result, "Повреждённый индекс глифов проекта.");
+
+    if (result) {
+        result->fileBytes = size;
+        result->mapped = bool(backing);
+        result->elapsedNs = timer.nsecsElapsed();
+    }
+    return true;
+}
+
+bool save(const QString& path, const FontDocument& doc, ProjectResult* result) {
+    QElapsedTimer timer;
+    timer.start();
+    if (result) *result = {};
+
+    // Мусор арены (старые участки глифов, сменивших размер) в файл не пишется.
+    FontDocument packed = doc;
+    if (packed.arenaBytes() != packed.usedBytes())
+        packed.compact();
+    const int count = packed.glyphCount();
+
+    QVector<GlyphEntry> index = packed.entries();
+    for (int i = 0; i < count; ++i) {
+        GlyphEntry& e = index[i];
+        e.flags = packed.isShared(i) ? GlyphEntry::kSharedSlot : 0;
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+        e.codepoint = qToLittleEndian(e.codepoint);
+        e.offset    = qToLittleEndian(e.offset);
+        e.rows      = qToLittleEndian(e.rows);
+        e.cols      = qToLittleEndian(e.cols);
+        e.advance   = qToLittleEndian(e.advance);
+        e.flags     = qToLittleEndian(e.flags);
+#endif
+    }
+
+    const qsizetype indexBytes = qsizetype(count) * kRecordSize;
+    const qsizetype arenaAt = alignUp(kHeaderSize + indexBytes, kArenaAlign);
+    const qsizetype arenaSize = packed.arenaBytes();
+
+    QByteArray header(kHeaderSize, '\0');
+    uchar* h = reinterpret_cast<uchar*>(header.data());
+    std::memcpy(h, kMagic, sizeof kMagic);
+    // Одноцветный шрифт — версия 1: такой файл откроют и сборки без серых глифов.
+    qToLittleEndian<quint16>(packed.depth() > 1 ? kVersion : 1, h + kVersionAt);
+    qToLittleEndian<quint16>(kHeaderSize, h + kHeaderSizeAt);
+    qToLittleEndian<quint32>(quint32(count), h + kCountAt);
+    qToLittleEndian<quint64>(kHeaderSize, h + kIndexAt);
+    qToLittleEndian<quint64>(quint64(arenaAt), h + kArenaAt);
+    qToLittleEndian<quint64>(quint64(arenaSize), h + kArenaSizeAt);
+    if (packed.depth() > 1)
+        qToLittleEndian<quint16>(quint16(packed.depth()), h + kDepthAt);
+    const QByteArray padding(arenaAt - kHeaderSize - indexBytes, '\0');
+    const QByteArray& arena = packed.arena();
+
+    QSaveFile f(path);
+    if (!f.open(QIODevice::WriteOnly))
+        return fail(result, QString("Не удалось создать %1: %2").arg(path, f.errorString()));
+    const bool ok = f.write(header) == header.size()
+                 && f.write(reinterpret_cast<const char*>(index.constData()), indexBytes) == indexBytes
+                 && f.write(padding) == padding.size()
+                 && f.write(arena) == arena.size();
+    if (!ok) {
+        f.cancelWriting();
+        return fail(result, QString("Ошибка записи: %1").arg(f.errorString()));
+    }
+    if (!f.commit())
+        return fail(result, QString("Не удалось сохранить %1: %2").arg(path, f.errorString()));
+
+    if (result) {
+        result->fileBytes = arenaAt + arenaSize;
+        result->elapsedNs = timer.nsecsElapsed();
+    }
+    return true;
+}
+
+} // namespace ProjectFile
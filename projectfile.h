@@ -0,0 +1,54 @@
+// projectfile.h
+#pragma once
+#include <QString>
+#include <QtGlobal>
+
+class FontDocument;
+
+/** \brief Итог чтения/записи проекта. */
+struct ProjectResult {
+    qint64  fileBytes = 0;
+    qint64  elapsedNs = 0;
+    bool    mapped = false;   ///< арена читается прямо из отображённого файла (без копии)
+    QString error;
+};
+
+/**
+ * \brief Собственный двоичный формат проекта (*.fcp), пригодный для QFile::map.
+ * \details Все числа — little-endian:
+ *
+ *          | смещение     | содержимое                                                     |
+ *          |--------------|----------------------------------------------------------------|
+ *          | 0            | заголовок, 64 байта: сигнатура, версия, число глифов, смещения |
+ *          | 64           | индекс: по 16 байт на глиф {код, смещение, rows, cols, advance, флаги} |
+ *          | кратно 4096  | арена: битмапы глифов подряд (строки MSB-first, как в FontDocument) |
+ *
+ *          Запись индекса совпадает с GlyphEntry байт в байт, поэтому на little-endian машине
+ *          индекс копируется одним memcpy, а арена вообще не копируется: документ получает
+ *          QByteArray::fromRawData() поверх отображения, и ОС подгружает страницы глифов по
+ *          мере обращения. Арена выровнена на страницу.
+ *
+ *          Версия 2 добавляет в заголовок глубину пикселя (FontDocument::depth()); проекты
+ *          одноцветных шрифтов по-прежнему пишутся версией 1 и открываются старыми сборками.
+ */
+namespace ProjectFile {
+
+/// \brief Текущая версия формата; файлы более новой версии не открываются.
+constexpr quint16 kVersion = 2;
+/// \brief Расширение файла проекта.
+inline QString suffix() { return QStringLiteral("fcp"); }
+
+/**
+ * \brief Открыть проект в doc (при ошибке doc не меняется).
+ * \details Файл отображается в память; если отображение недоступно — читается целиком.
+ */
+bool load(const QString& path, FontDocument& doc, ProjectResult* result = nullptr);
+
+/**
+ * \brief Сохранить проект атомарно (QSaveFile: временный файл и переименование).
+ * \details Каждая секция пишется одним блоком прямо из памяти документа; мусор арены
+ *          (после изменения размеров глифов) в файл не попадает.
+ */
+bool save(const QString& path, const FontDocument& doc, ProjectResult* result = nullptr);
+
+} // namespace ProjectFile
@@ -0,0 +1,125 @@
+// sheetimportdialog.cpp
+#include "sheetimportdialog.h"
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPainter>
+#include <QPixmap>
+#include <QSpinBox>
+#include <QVBoxLayout>
+#include <algorithm>
+
+SheetImportDialog::SheetImportDialog(const QImage& sheet, QWidget* parent)
+    : QDialog(parent), m_sheet(sheet)
+{
+    setWindowTitle(QString("Импорт листа глифов %1x%2").arg(sheet.width()).arg(sheet.height()));
+
+    m_thumb = sheet.convertToFormat(QImage::Format_RGB32);
+    if (m_thumb.width() > kPreviewSize || m_thumb.height() > kPreviewSize)
+        m_thumb = m_thumb.scaled(kPreviewSize, kPreviewSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    m_scale = sheet.width() > 0 ? double(m_thumb.width()) / sheet.width() : 1.0;
+
+    auto *hl = new QHBoxLayout(this);
+    auto *left = new QVBoxLayout;
+    auto *form = new QFormLayout;
+
+    m_sbCellW    = addSpin(form, "Ширина клетки:", 1, 4096, 8);
+    m_sbCellH    = addSpin(form, "Высота клетки:", 1, 4096, 8);
+    m_sbMarginX  = addSpin(form, "Отступ слева:", 0, 4096, 0);
+    m_sbMarginY  = addSpin(form, "Отступ сверху:", 0, 4096, 0);
+    m_sbSpacingX = addSpin(form, "Промежуток X:", 0, 4096, 0);
+    m_sbSpacingY = addSpin(form, "Промежуток Y:", 0, 4096, 0);
+    m_sbFirstCode = addSpin(form, "Первый код:", 0, 0x10FFFF, 0x20);
+    m_sbFirstCode->setDisplayIntegerBase(16);
+    m_sbFirstCode->setPrefix("0x");
+
+    m_chkSkipBlank = new QCheckBox("Пропускать пустые клетки", this);
+    m_chkSkipBlank->setChecked(true);
+    form->addRow(QString(), m_chkSkipBlank);
+
+    m_cbMode = new QComboBox(this);
+    m_cbMode->addItem("Порог", int(BinarizeMode::Threshold));
+    m_cbMode->addItem("Оцу (авто)", int(BinarizeMode::Otsu));
+    m_cbMode->addItem("Флойд–Стейнберг", int(BinarizeMode::FloydSteinberg));
+    m_cbMode->addItem("Упорядоченный (Байер 8×8)", int(BinarizeMode::Ordered));
+    form->addRow("Бинаризация:", m_cbMode);
+    m_sbThreshold = addSpin(form, "Порог:", 0, 256, 128);
+    m_chkInvert = new QCheckBox("Инвертировать", this);
+    form->addRow(QString(), m_chkInvert);
+    left->addLayout(form);
+
+    m_lblInfo = new QLabel(this);
+    left->addWidget(m_lblInfo);
+    left->addStretch(1);
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    left->addWidget(buttons);
+    hl->addLayout(left);
+
+    m_lblPreview = new QLabel(this);
+    m_lblPreview->setAlignment(Qt::AlignCenter);
+    hl->addWidget(m_lblPreview, 1);
+
+    connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(m_chkSkipBlank, &QCheckBox::toggled, this, &SheetImportDialog::updatePreview);
+    connect(m_chkInvert, &QCheckBox::toggled, this, &SheetImportDialog::updatePreview);
+    connect(m_cbMode, qOverload<int>(&QComboBox::currentIndexChanged), this, &SheetImportDialog::updatePreview);
+
+    updatePreview();
+}
+
+QSpinBox* SheetImportDialog::addSpin(QFormLayout* form, const QString& label, int min, int max, int value) {
+    auto *sb = new QSpinBox(this);
+    sb->setRange(min, max);
+    sb->setValue(value);
+    form->addRow(label, sb);
+    connect(sb, qOverload<int>(&QSpinBox::valueChanged), this, &SheetImportDialog::updatePreview);
+    return sb;
+}
+
+SheetOptions SheetImportDialog::options() const {
+    SheetOptions opt;
+    opt.cellWidth  = m_sbCellW->value();
+    opt.cellHeight = m_sbCellH->value();
+    opt.marginX    = m_sbMarginX->value();
+    opt.marginY    = m_sbMarginY->value();
+    opt.spacingX   = m_sbSpacingX->value();
+    opt.spacingY   = m_sbSpacingY->value();
+    opt.firstCode  = quint32(m_sbFirstCode->value());
+    opt.skipBlank  = m_chkSkipBlank->isChecked();
+    opt.binarize.mode      = BinarizeMode(m_cbMode->currentData().toInt());
+    opt.binarize.threshold = m_sbThreshold->value();
+    opt.binarize.invert    = m_chkInvert->isChecked();
+    return opt;
+}
+
+/** \brief Лист с наложенной сеткой клеток и число клеток/кодов. */
+void SheetImportDialog::updatePreview() {
+    const SheetOptions opt = options();
+    m_sbThreshold->setEnabled(opt.binarize.mode != BinarizeMode::Otsu);
+    const QSize grid = SheetSlicer::gridSize(opt, m_sheet.width(), m_sheet.height());
+
+    QImage view = m_thumb;
+    {
+        QPainter p(&view);
+        p.setPen(QColor(255, 0, 0, 160));
+        p.setBrush(Qt::NoBrush);
+        for (int r = 0; r < grid.height(); ++r)
+            for (int c = 0; c < grid.width(); ++c) {
+                const QRect cell = SheetSlicer::cellRect(opt, r, c);
+                p.drawRect(QRectF(cell.x() * m_scale, cell.y() * m_scale,
+                                  cell.width() * m_scale, cell.height() * m_scale));
+            }
+    }
+    m_lblPreview->setPixmap(QPixmap::fromImage(view));
+
+    const int cells = grid.width() * grid.height();
+    m_lblInfo->setText(cells > 0
+        ? QString("Клеток: %1×%2 = %3, коды 0x%4–0x%5")
+              .arg(grid.width()).arg(grid.height()).arg(cells)
+              .arg(opt.firstCode, 0, 16).arg(opt.firstCode + quint32(cells) - 1, 0, 16)
+        : QString("Клетки не помещаются в изображение"));
+}
@@ -0,0 +1,48 @@
+// sheetimportdialog.h
+#pragma once
+#include <QDialog>
+#include <QImage>
+#include "sheetslicer.h"
+
+class QCheckBox;
+class QComboBox;
+class QFormLayout;
+class QLabel;
+class QSpinBox;
+
+/**
+ * \brief Диалог импорта листа глифов: размер клетки, отступы, промежутки, первый код,
+ *        пропуск пустых клеток и бинаризация; предпросмотр сетки поверх листа.
+ */
+class SheetImportDialog : public QDialog {
+    Q_OBJECT
+public:
+    explicit SheetImportDialog(const QImage& sheet, QWidget* parent = nullptr);
+
+    SheetOptions options() const;
+
+private slots:
+    void updatePreview();
+
+private:
+    static constexpr int kPreviewSize = 512;
+
+    QSpinBox* addSpin(QFormLayout* form, const QString& label, int min, int max, int value);
+
+    QImage     m_sheet;
+    QImage     m_thumb;       ///< уменьшенная копия листа для предпросмотра
+    double     m_scale = 1.0; ///< m_thumb / m_sheet
+    QSpinBox*  m_sbCellW = nullptr;
+    QSpinBox*  m_sbCellH = nullptr;
+    QSpinBox*  m_sbMarginX = nullptr;
+    QSpinBox*  m_sbMarginY = nullptr;
+    QSpinBox*  m_sbSpacingX = nullptr;
+    QSpinBox*  m_sbSpacingY = nullptr;
+    QSpinBox*  m_sbFirstCode = nullptr;
+    QCheckBox* m_chkSkipBlank = nullptr;
+    QComboBox* m_cbMode = nullptr;
+    QSpinBox*  m_sbThreshold = nullptr;
+    QCheckBox* m_chkInvert = nullptr;
+    QLabel*    m_lblPreview = nullptr;
+    QLabel*    m_lblInfo = nullptr;
+};
@@ -0,0 +1,92 @@
+// sheetslicer.cpp
+#include "sheetslicer.h"
+#include "fontdocument.h"
+#include "workstealingpool.h"
+#include <QElapsedTimer>
+#include <QVector>
+#include <algorithm>
+
+namespace SheetSlicer {
+
+namespace {
+
+/// \brief Сколько клеток размера cell с промежутком gap помещается в length после margin.
+int fit(int length, int margin, int cell, int gap) {
+    if (cell <= 0 || length - margin < cell) return 0;
+    return (length - margin - cell) / (cell + gap) + 1;
+}
+
+} // namespace
+
+QSize gridSize(const SheetOptions& opt, int width, int height) {
+    const int cols = fit(width, opt.marginX, opt.cellWidth, std::max(0, opt.spacingX));
+    const int rows = fit(height, opt.marginY, opt.cellHeight, std::max(0, opt.spacingY));
+    return { opt.columns > 0 ? std::min(opt.columns, cols) : cols,
+             opt.rows > 0 ? std::min(opt.rows, rows) : rows };
+}
+
+QRect cellRect(const SheetOptions& opt, int row, int col) {
+    return { opt.marginX + col * (opt.cellWidth + std::max(0, opt.spacingX)),
+             opt.marginY + row * (opt.cellHeight + std::max(0, opt.spacingY)),
+             opt.cellWidth, opt.cellHeight };
+}
+
+bool slice(const QImage& sheet, const SheetOptions& opt, FontDocument& out, SheetResult* result) {
+    SheetResult res;
+    QElapsedTimer timer;
+    timer.start();
+    out.clear();
+
+    const QSize grid = sheet.isNull() ? QSize() : gridSize(opt, sheet.width(), sheet.height());
+    res.columns = grid.width();
+    res.rows = grid.height();
+    const int cells = res.columns * res.rows;
+    if (cells <= 0 || opt.cellWidth > 0xFFFF || opt.cellHeight > 0xFFFF) {   // предел GlyphEntry
+        if (result) *result = res;
+        return false;
+    }
+
+    const QImage g = sheet.convertToFormat(QImage::Format_Grayscale8);
+    const uchar* gray = g.constBits();
+    const qsizetype bpl = g.bytesPerLine();
+
+    // Порог Оцу — один на весь лист, иначе у каждой клетки он был бы свой.
+    BinarizeOptions bin = opt.binarize;
+    if (bin.mode == BinarizeMode::Otsu) {
+        bin.threshold = Binarizer::otsuThreshold(g);
+        bin.mode = BinarizeMode::Threshold;
+    }
+    res.threshold = bin.threshold;
+
+    const int bpr = (opt.cellWidth + 7) / 8;
+    const qsizetype glyphBytes = qsizetype(bpr) * opt.cellHeight;
+    QByteArray packed(int(glyphBytes * cells), Qt::Uninitialized);
+    quint8* packedData = reinterpret_cast<quint8*>(packed.data());
+    QVector<char> blank(cells, 0);
+
+    WorkStealingPool::global().parallelFor(0, cells, 16, [&](int i0, int i1) {
+        for (int i = i0; i < i1; ++i) {
+            const QRect r = cellRect(opt, i / res.columns, i % res.columns);
+            quint8* dst = packedData + glyphBytes * i;
+            Binarizer::binarizeGray(gray + qsizetype(r.y()) * bpl + r.x(), bpl, r.width(), r.height(),
+                                    dst, bpr, bin);
+            blank[i] = std::all_of(dst, dst + glyphBytes, [](quint8 b) { return b == 0; });
+        }
+    });
+
+    int keep = cells;
+    if (opt.skipBlank)
+        keep -= int(std::count(blank.cbegin(), blank.cend(), char(1)));
+    out.reserve(keep, glyphBytes * keep);
+    for (int i = 0; i < cells; ++i) {
+        if (opt.skipBlank && blank[i]) { ++res.blank; continue; }
+        out.setGlyphBytes(opt.firstCode + quint32(i), opt.cellHeight, opt.cellWidth, packedData + glyphBytes * i);
+        ++res.imported;
+    }
+
+    res.elapsedNs = timer.nsecsElapsed();
+    if (result) *result = res;
+    return true;
+}
+
+} // namespace SheetSlicer
@@ -0,0 +1,59 @@
+// sheetslicer.h
+#pragma once
+#include <QImage>
+#include <QRect>
+#include "binarizer.h"
+
+class FontDocument;
+
+/**
+ * \brief Геометрия листа глифов (sprite sheet) и параметры импорта.
+ * \details Клетка (i, j) начинается в (marginX + j·(cellWidth + spacingX),
+ *          marginY + i·(cellHeight + spacingY)); клетки нумеруются по строкам,
+ *          коду клетки n соответствует firstCode + n.
+ */
+struct SheetOptions {
+    int     cellWidth  = 8;
+    int     cellHeight = 8;
+    int     marginX    = 0;   ///< отступ слева
+    int     marginY    = 0;   ///< отступ сверху
+    int     spacingX   = 0;   ///< промежуток между клетками по горизонтали
+    int     spacingY   = 0;   ///< промежуток между клетками по вертикали
+    int     columns    = 0;   ///< 0 — сколько помещается
+    int     rows       = 0;   ///< 0 — сколько помещается
+    quint32 firstCode  = 0x20;
+    bool    skipBlank  = true; ///< не создавать глифы из пустых клеток (код всё равно расходуется)
+    BinarizeOptions binarize;  ///< Otsu считается один раз по всему листу
+};
+
+/** \brief Итог нарезки. */
+struct SheetResult {
+    int    columns = 0;
+    int    rows = 0;
+    int    imported = 0;     ///< глифов добавлено
+    int    blank = 0;        ///< пустых клеток пропущено
+    int    threshold = 0;    ///< фактический порог (для Otsu — вычисленный)
+    qint64 elapsedNs = 0;
+};
+
+/**
+ * \brief Нарезка листа глифов в FontDocument.
+ * \details Лист один раз переводится в Grayscale8, затем клетки бинаризуются параллельно
+ *          (WorkStealingPool::global()) прямо из сканлайнов листа — без QImage::copy —
+ *          в общий упакованный буфер, откуда непустые глифы переносятся в документ.
+ */
+namespace SheetSlicer {
+
+/** \brief Число колонок/строк клеток, помещающихся в изображение w×h. */
+QSize gridSize(const SheetOptions& opt, int width, int height);
+
+/** \brief Прямоугольник клетки (row, col) на листе. */
+QRect cellRect(const SheetOptions& opt, int row, int col);
+
+/**
+ * \brief Нарезать лист; out очищается и заполняется глифами.
+ * \return false, если в изображение не помещается ни одной клетки.
+ */
+bool slice(const QImage& sheet, const SheetOptions& opt, FontDocument& out, SheetResult* result = nullptr);
+
+} // namespace SheetSlicer
@@ -0,0 +1,163 @@
+// textpreviewwidget.cpp
+#include "textpreviewwidget.h"
+#include "fontdocument.h"
+#include "glyphlistview.h"
+#include <QElapsedTimer>
+#include <QPainter>
+#include <QResizeEvent>
+#include <algorithm>
+
+namespace {
+constexpr int kNewLine = -2; ///< код перевода строки в m_codes
+}
+
+TextPreviewWidget::TextPreviewWidget(QWidget* parent) : QWidget(parent) {
+    setAttribute(Qt::WA_OpaquePaintEvent); // кадр закрывает весь виджет
+    setMinimumHeight(48);
+}
+
+void TextPreviewWidget::setGlyphModel(FontGlyphModel* model) {
+    m_doc = model ? model->document() : nullptr;
+    if (model) {
+        connect(model, &QAbstractItemModel::modelReset, this, &TextPreviewWidget::reload);
+        connect(model, &QAbstractItemModel::dataChanged, this,
+                [this](const QModelIndex& topLeft, const QModelIndex& bottomRight) {
+                    for (int r = topLeft.row(); r <= bottomRight.row(); ++r)
+                        glyphChanged(r);
+                });
+    }
+    reload();
+}
+
+void TextPreviewWidget::setText(const QString& text) {
+    if (text == m_text) return;
+    m_text = text;
+    remap();
+    update();
+}
+
+void TextPreviewWidget::setScale(int scale) {
+    scale = qBound(1, scale, 16);
+    if (scale == m_scale) return;
+    m_scale = scale;
+    m_layoutDirty = m_frameDirty = true;
+    update();
+}
+
+void TextPreviewWidget::setDeviceColors(const QColor& off, const QColor& on) {
+    m_off = off;
+    m_on = on;
+    if (!m_frame.isNull())
+        m_frame.setColorTable({ m_off.rgb(), m_on.rgb() });
+    update();
+}
+
+/** \brief Правка глифа: клетка атласа + кадр; раскладка — только если изменился размер. */
+void TextPreviewWidget::glyphChanged(int glyphIndex) {
+    if (!m_doc || glyphIndex < 0 || glyphIndex >= m_doc->glyphCount()) return;
+    const QSize before = glyphIndex < m_atlas.glyphCount() ? m_atlas.glyphSize(glyphIndex) : QSize();
+    if (!m_atlas.update(*m_doc, glyphIndex) || m_atlas.glyphSize(glyphIndex) != before)
+        m_layoutDirty = true;
+    m_frameDirty = true;
+    update();
+}
+
+void TextPreviewWidget::reload() {
+    if (m_doc) m_atlas.rebuild(*m_doc);
+    else m_atlas = GlyphAtlas(64);
+    m_missingW = std::max(2, m_atlas.cellSize().height() / 2);
+    remap();
+    update();
+}
+
+void TextPreviewWidget::remap() {
+    const QVector<uint> ucs = m_text.toUcs4();
+    m_codes.resize(ucs.size());
+    for (int i = 0; i < ucs.size(); ++i)
+        m_codes[i] = ucs[i] == '\n' ? kNewLine : m_doc ? m_doc->indexOf(ucs[i]) : -1;
+    m_layoutDirty = m_frameDirty = true;
+}
+
+/** \brief Перенос по символам: глиф, не влезающий в остаток строки, начинает новую. */
+void TextPreviewWidget::relayout() {
+    m_placed.clear();
+    const int width = m_frame.width(), height = m_frame.height();
+    const int lineH = m_atlas.glyphCount() ? m_atlas.cellSize().height() : 8;
+    int x = 0, y = 0;
+    for (int code : m_codes) {
+        if (y >= height) break;
+        if (code == kNewLine) {
+            x = 0;
+            y += lineH;
+            continue;
+        }
+        const int w = code >= 0 ? m_atlas.glyphSize(code).width() : m_missingW;
+        if (x > 0 && x + w > width) {
+            x = 0;
+            y += lineH;
+            if (y >= height) break;
+        }
+        m_placed.append({ code, x, y });
+        if (code >= 0) {
+            const int advance = m_doc->entry(code).advance;
+            x += advance ? advance : w;
+        } else {
+            x += w + 1;
+        }
+    }
+    m_layoutDirty = false;
+}
+
+void TextPreviewWidget::render() {
+    QElapsedTimer timer;
+    timer.start();
+
+    const QSize size(std::max(1, width() / m_scale), std::max(1, height() / m_scale));
+    if (m_frame.size() != size) {
+        m_frame = QImage(size, QImage::Format_Mono);
+        m_frame.setColorTable({ m_off.rgb(), m_on.rgb() });
+        m_layoutDirty = true;
+    }
+    if (m_layoutDirty) relayout();
+
+    m_frame.fill(0);
+    quint8* bits = m_frame.bits();
+    const qsizetype stride = m_frame.bytesPerLine();
+    for (const Placed& p : m_placed) {
+        if (p.index >= 0) m_atlas.blit(p.index, bits, stride, size.width(), size.height(), p.x, p.y);
+        else drawMissing(p, bits, stride);
+    }
+    m_frameDirty = false;
+
+    m_lastRenderMs = timer.nsecsElapsed() / 1e6;
+    emit rendered(m_lastRenderMs, int(m_placed.size()));
+}
+
+void TextPreviewWidget::drawMissing(const Placed& p, quint8* bits, qsizetype stride) {
+    const int lineH = m_atlas.glyphCount() ? m_atlas.cellSize().height() : 8;
+    const int x0 = p.x, x1 = std::min(p.x + m_missingW, m_frame.width()) - 1;
+    const int y0 = p.y + 1, y1 = std::min(p.y + lineH - 1, m_frame.height()) - 1;
+    auto set = [&](int x, int y) { bits[y * stride + x / 8] |= quint8(0x80 >> (x % 8)); };
+    for (int x = x0; x <= x1; ++x) {
+        if (y0 <= y1) set(x, y0);
+        if (y1 > y0) set(x, y1);
+    }
+    for (int y = y0; y <= y1; ++y) {
+        set(x0, y);
+        if (x1 > x0) set(x1, y);
+    }
+}
+
+void TextPreviewWidget::paintEvent(QPaintEvent*) {
+    if (m_frameDirty || m_frame.isNull()) render();
+    QPainter p(this);
+    p.fillRect(rect(), m_off);
+    p.setRenderHint(QPainter::SmoothPixmapTransform, false);
+    p.drawImage(QRect(0, 0, m_frame.width() * m_scale, m_frame.height() * m_scale), m_frame);
+}
+
+void TextPreviewWidget::resizeEvent(QResizeEvent* e) {
+    if (e->size() / m_scale != e->oldSize() / m_scale)
+        m_frameDirty = true;
+    QWidget::resizeEvent(e);
+}
@@ -0,0 +1,89 @@
+// textpreviewwidget.h
+#pragma once
+#include <QColor>
+#include <QImage>
+#include <QString>
+#include <QVector>
+#include <QWidget>
+#include "glyphatlas.h"
+
+class FontDocument;
+class FontGlyphModel;
+
+/**
+ * \brief Предпросмотр произвольного текста текущим шрифтом "как на устройстве".
+ * \details Глифы накладываются из кэша GlyphAtlas в 1-битный кадр размером с экран
+ *          устройства (виджет / масштаб), кадр рисуется одним drawImage с увеличением
+ *          без сглаживания. Правка глифа обновляет только его клетку атласа и кадр;
+ *          раскладка строк пересчитывается лишь при смене текста, ширины или размеров глифов.
+ *          Серый шрифт показывается маской атласа (уровень не меньше половины — закрашен).
+ *
+ *          Источник изменений — FontGlyphModel: dataChanged (глиф сохранён из редактора
+ *          по PixelGridWidget::changed) и modelReset (изменился состав шрифта).
+ */
+class TextPreviewWidget : public QWidget {
+    Q_OBJECT
+public:
+    explicit TextPreviewWidget(QWidget* parent = nullptr);
+
+    /** \brief Подключить шрифт через модель списка глифов. */
+    void setGlyphModel(FontGlyphModel* model);
+
+    void setText(const QString& text);
+    const QString& text() const { return m_text; }
+
+    /** \brief Увеличение: один пиксель устройства — scale × scale пикселей экрана. */
+    void setScale(int scale);
+    int  scale() const { return m_scale; }
+
+    /** \brief Цвета погашенного и зажжённого пикселя устройства. */
+    void setDeviceColors(const QColor& off, const QColor& on);
+
+    /** \brief Время последней перерисовки кадра (раскладка + наложение глифов), мс. */
+    double lastRenderMs() const { return m_lastRenderMs; }
+
+public slots:
+    /** \brief Глиф изменился: обновить его клетку атласа. */
+    void glyphChanged(int glyphIndex);
+    /** \brief Состав шрифта изменился: перестроить атлас и раскладку. */
+    void reload();
+
+signals:
+    /** \brief Кадр перерисован: время, мс, и число выведенных глифов. */
+    void rendered(double ms, int glyphs);
+
+protected:
+    void paintEvent(QPaintEvent*) override;
+    void resizeEvent(QResizeEvent*) override;
+
+private:
+    /// \brief Позиция глифа в кадре; index < 0 — символа нет в шрифте (рамка).
+    struct Placed {
+        int index;
+        int x;
+        int y;
+    };
+
+    /// \brief Символы текста → индексы глифов (при смене текста или шрифта).
+    void remap();
+    /// \brief Разбить текст на строки по ширине кадра.
+    void relayout();
+    /// \brief Собрать 1-битный кадр из атласа.
+    void render();
+    /// \brief Рамка на месте отсутствующего глифа.
+    void drawMissing(const Placed& p, quint8* bits, qsizetype stride);
+
+    const FontDocument* m_doc = nullptr;
+    GlyphAtlas       m_atlas{ 64 };
+    QString          m_text;
+    QVector<int>     m_codes;   ///< индекс глифа на символ; -1 — нет, kNewLine — перевод строки
+    QVector<Placed>  m_placed;
+    QImage           m_frame;   ///< кадр устройства, Format_Mono
+    QColor           m_off{ 255, 255, 255 };
+    QColor           m_on{ 0, 0, 0 };
+    int              m_scale = 2;
+    int              m_missingW = 4; ///< ширина рамки отсутствующего глифа, px
+    bool             m_layoutDirty = true;
+    bool             m_frameDirty = true;
+    double           m_lastRenderMs = 0.0;
+};
@@ -0,0 +1,198 @@
+// trace.cpp
+#include "trace.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Trace {
+
+namespace detail {
+std::atomic<bool> g_enabled{ qEnvironmentVariableIsSet("FONTCREATOR_TRACE") };
+
+qint64 now() {
+    static const QElapsedTimer epoch = [] { QElapsedTimer t; t.start(); return t; }();
+    return epoch.nsecsElapsed();
+}
+} // namespace detail
+
+namespace {
+
+static_assert((kRingCapacity & (kRingCapacity - 1)) == 0, "ring capacity must be a power of two");
+
+/// \brief Ячейка кольца; поля атомарны, чтобы выгрузка могла читать их во время записи.
+struct Slot {
+    std::atomic<const char*> name{ nullptr };
+    std::atomic<qint64>      start{ 0 };
+    std::atomic<qint64>      end{ 0 };
+};
+
+/**
+ * \brief Кольцо одного потока: пишет только владелец, читает выгрузка.
+ * \details head — число записанных событий за всё время; событие i лежит в ячейке
+ *          i % kRingCapacity и достоверно, пока i + kRingCapacity > head.
+ */
+struct Ring {
+    std::atomic<quint64>     head{ 0 };
+    std::atomic<quint64>     tail{ 0 };   ///< события до tail стёрты clear()
+    std::atomic<const char*> threadName{ nullptr };
+    int                      tid = 0;
+    Slot                     slots[kRingCapacity];
+};
+
+struct Registry {
+    std::mutex                         mutex;
+    std::vector<std::unique_ptr<Ring>> rings;   // живут до выхода: события завершённых потоков нужны в выгрузке
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+thread_local Ring*        t_ring = nullptr;
+thread_local const char*  t_threadName = nullptr;
+
+/// \brief Кольцо текущего потока (создаётся при первом событии, не раньше).
+Ring& localRing() {
+    if (!t_ring) {
+        Registry& reg = registry();
+        auto r = std::make_unique<Ring>();
+        r->threadName.store(t_threadName, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        r->tid = int(reg.rings.size()) + 1;
+        reg.rings.push_back(std::move(r));
+        t_ring = reg.rings.back().get();
+    }
+    return *t_ring;
+}
+
+std::atomic<const char*> g_lastName{ nullptr };
+std::atomic<qint64>      g_lastNs{ 0 };
+std::atomic<quint64>     g_lastSerial{ 0 };
+
+void appendString(QByteArray& out, const char* s) {
+    out += '"';
+    for (; *s; ++s) {
+        const char c = *s;
+        if (c == '"' || c == '\\') out += '\\';
+        if (uchar(c) >= 0x20) out += c;
+    }
+    out += '"';
+}
+
+/// \brief нс → мкс (единица trace_event) с точностью до нс.
+QByteArray micros(qint64 ns) {
+    return QByteArray::number(double(ns) / 1000.0, 'f', 3);
+}
+
+} // namespace
+
+namespace detail {
+void record(const char* name, qint64 startNs, qint64 endNs, bool operation) {
+    Ring& r = localRing();
+    const quint64 h = r.head.load(std::memory_order_relaxed);
+    Slot& s = r.slots[h & (kRingCapacity - 1)];
+    s.name.store(name, std::memory_order_relaxed);
+    s.start.store(startNs, std::memory_order_relaxed);
+    s.end.store(endNs, std::memory_order_relaxed);
+    r.head.store(h + 1, std::memory_order_release);
+
+    if (operation) {
+        g_lastName.store(name, std::memory_order_relaxed);
+        g_lastNs.store(endNs - startNs, std::memory_order_relaxed);
+        g_lastSerial.fetch_add(1, std::memory_order_release);
+    }
+}
+} // namespace detail
+
+void setEnabled(bool on) {
+    detail::g_enabled.store(on, std::memory_order_relaxed);
+}
+
+bool isEnabled() {
+    return detail::g_enabled.load(std::memory_order_relaxed);
+}
+
+void setThreadName(const char* name) {
+    t_threadName = name;
+    if (t_ring) t_ring->threadName.store(name, std::memory_order_relaxed);
+}
+
+Operation lastOperation() {
+    Operation op;
+    op.serial = g_lastSerial.load(std::memory_order_acquire);
+    op.name = g_lastName.load(std::memory_order_relaxed);
+    op.durationNs = g_lastNs.load(std::memory_order_relaxed);
+    return op;
+}
+
+void clear() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto& r : reg.rings)
+        r->tail.store(r->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+QByteArray toChromeJson() {
+    struct Event { const char* name; qint64 start, end; };
+    QByteArray out;
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    auto separator = [&] { if (!first) out += ",\n"; first = false; };
+
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    std::vector<Event> events;
+    for (const auto& r : reg.rings) {
+        // Снимок без остановки писателя: ячейки, которые он мог затереть за время
+        // копирования, отбрасываются по повторному чтению head.
+        const quint64 h1 = r->head.load(std::memory_order_acquire);
+        const quint64 from = std::max(r->tail.load(std::memory_order_relaxed),
+                                      h1 > quint64(kRingCapacity) ? h1 - kRingCapacity : quint64(0));
+        events.clear();
+        for (quint64 i = from; i < h1; ++i) {
+            const Slot& s = r->slots[i & (kRingCapacity - 1)];
+            events.push_back({ s.name.load(std::memory_order_relaxed),
+                               s.start.load(std::memory_order_relaxed),
+                               s.end.load(std::memory_order_relaxed) });
+        }
+        const quint64 h2 = r->head.load(std::memory_order_acquire);
+        const size_t torn = h2 >= from + kRingCapacity ? size_t(std::min(h2 - from - kRingCapacity + 1, h1 - from)) : 0;
+
+        separator();
+        out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + QByteArray::number(r->tid)
+             + ",\"args\":{\"name\":";
+        if (const char* name = r->threadName.load(std::memory_order_relaxed))
+            appendString(out, name);
+        else
+            out += "\"поток " + QByteArray::number(r->tid) + '"';
+        out += "}}";
+
+        for (size_t i = torn; i < events.size(); ++i) {
+            const Event& e = events[i];
+            if (!e.name) continue;
+            separator();
+            out += "{\"name\":";
+            appendString(out, e.name);
+            out += ",\"cat\":\"fc\",\"ph\":\"X\",\"pid\":1,\"tid\":" + QByteArray::number(r->tid)
+                 + ",\"ts\":" + micros(e.start) + ",\"dur\":" + micros(e.end - e.start) + '}';
+        }
+    }
+    out += "]}\n";
+    return out;
+}
+
+bool writeChromeJson(const QString& path, QString* error) {
+    const QByteArray json = toChromeJson();
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate) || f.write(json) != json.size()) {
+        if (error) *error = f.errorString();
+        return false;
+    }
+    return true;
+}
+
+} // namespace Trace
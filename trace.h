@@ -0,0 +1,91 @@
+// trace.h
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+/**
+ * \brief Трассировка горячих путей: интервалы в кольцевых буферах потоков, выгрузка в
+ *        формате Chrome trace_event (chrome://tracing, Perfetto).
+ * \details Интервал задаётся областью видимости:
+ *
+ *              void PixelGridWidget::shiftLeft() {
+ *                  FC_TRACE_SCOPE("PixelGridWidget::shiftLeft");
+ *                  ...
+ *
+ *          Выключенная трассировка стоит одного relaxed-чтения флага на входе в область.
+ *          Включённая — двух чтений монотонных часов и записи в буфер своего потока без
+ *          блокировок; при переполнении затираются самые старые события. Имена — строковые
+ *          литералы: хранится только указатель.
+ *
+ *          Без FONTCREATOR_TRACE (опция CMake) макросы не порождают кода.
+ */
+namespace Trace {
+
+/// \brief Событий в буфере одного потока.
+constexpr int kRingCapacity = 1 << 14;
+
+/** \brief Включить/выключить запись (по умолчанию — по переменной окружения FONTCREATOR_TRACE). */
+void setEnabled(bool on);
+bool isEnabled();
+
+/** \brief Имя текущего потока в выгрузке (по умолчанию — "поток N"); name — литерал.
+ *         Буфер при этом не создаётся: поток без событий памяти не занимает. */
+void setThreadName(const char* name);
+
+/** \brief Последняя завершённая операция (FC_TRACE_OPERATION) в любом потоке. */
+struct Operation {
+    const char* name = nullptr;
+    qint64      durationNs = 0;
+    quint64     serial = 0;     ///< растёт с каждой операцией; 0 — ещё не было
+};
+Operation lastOperation();
+
+/** \brief Забыть записанные события (буферы потоков остаются). */
+void clear();
+
+/** \brief Все события в формате Chrome trace_event JSON ({"traceEvents": [...]}). */
+QByteArray toChromeJson();
+
+/** \brief Записать toChromeJson() в файл. */
+bool writeChromeJson(const QString& path, QString* error = nullptr);
+
+namespace detail {
+extern std::atomic<bool> g_enabled;
+qint64 now();
+void record(const char* name, qint64 startNs, qint64 endNs, bool operation);
+}
+
+/** \brief Интервал от конструктора до деструктора. */
+class Scope {
+public:
+    explicit Scope(const char* name, bool operation = false)
+        : m_name(detail::g_enabled.load(std::memory_order_relaxed) ? name : nullptr),
+          m_operation(operation), m_start(m_name ? detail::now() : 0) {}
+    ~Scope() {
+        if (m_name) detail::record(m_name, m_start, detail::now(), m_operation);
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* m_name;
+    bool        m_operation;
+    qint64      m_start;
+};
+
+} // namespace Trace
+
+#define FC_TRACE_CONCAT_(a, b) a##b
+#define FC_TRACE_CONCAT(a, b) FC_TRACE_CONCAT_(a, b)
+
+#ifdef FONTCREATOR_TRACE
+/// \brief Интервал до конца области видимости.
+#define FC_TRACE_SCOPE(name) const Trace::Scope FC_TRACE_CONCAT(fcTrace_, __LINE__)(name)
+/// \brief То же, и интервал становится "последней операцией" для строки состояния.
+#define FC_TRACE_OPERATION(name) const Trace::Scope FC_TRACE_CONCAT(fcTrace_, __LINE__)(name, true)
+#else
+#define FC_TRACE_SCOPE(name) do {} while (false)
+#define FC_TRACE_OPERATION(name) do {} while (false)
+#endif
@@ -0,0 +1,159 @@
+// workstealingpool.cpp
+#include "workstealingpool.h"
+#include "trace.h"
+#include <algorithm>
+
+namespace {
+/// \brief Пул и индекс рабочего потока, в котором исполняется код (или nullptr/-1).
+thread_local const WorkStealingPool* t_pool = nullptr;
+thread_local int t_index = -1;
+}
+
+WorkStealingPool::WorkStealingPool(int threads) {
+    if (threads <= 0)
+        threads = int(std::max(1u, std::thread::hardware_concurrency()));
+    m_workers.reserve(size_t(threads));
+    for (int i = 0; i < threads; ++i)
+        m_workers.push_back(std::make_unique<Worker>());
+    m_threads.reserve(size_t(threads));
+    for (int i = 0; i < threads; ++i)
+        m_threads.emplace_back([this, i] { run(i); });
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lk(m_sleepMutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& t : m_threads)
+        t.join();
+}
+
+WorkStealingPool& WorkStealingPool::global() {
+    static WorkStealingPool pool;
+    return pool;
+}
+
+/** \brief Поставить задачу: из рабочего потока — в свою очередь, иначе по кругу. */
+void WorkStealingPool::submit(Task task) {
+    const int n = int(m_workers.size());
+    const int target = (t_pool == this) ? t_index : int(m_nextQueue.fetch_add(1) % unsigned(n));
+
+    m_pending.fetch_add(1);
+    {
+        Worker& w = *m_workers[size_t(target)];
+        std::lock_guard<std::mutex> lk(w.mutex);
+        w.queue.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lk(m_sleepMutex);
+        m_queued.fetch_add(1);
+    }
+    m_wake.notify_one();
+}
+
+bool WorkStealingPool::take(int self, Task& out) {
+    const int n = int(m_workers.size());
+    if (self >= 0) {
+        Worker& w = *m_workers[size_t(self)];
+        std::lock_guard<std::mutex> lk(w.mutex);
+        if (!w.queue.empty()) {
+            out = std::move(w.queue.back());
+            w.queue.pop_back();
+            m_queued.fetch_sub(1);
+            return true;
+        }
+    }
+    const int start = self >= 0 ? self + 1 : 0;
+    for (int k = 0; k < n; ++k) {
+        const int victim = (start + k) % n;
+        if (victim == self) continue;
+        Worker& w = *m_workers[size_t(victim)];
+        std::lock_guard<std::mutex> lk(w.mutex);
+        if (!w.queue.empty()) {
+            out = std::move(w.queue.front());
+            w.queue.pop_front();
+            m_queued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::finishOne() {
+    if (m_pending.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lk(m_sleepMutex);
+        m_idle.notify_all();
+    }
+}
+
+void WorkStealingPool::run(int index) {
+    t_pool = this;
+    t_index = index;
+    Trace::setThreadName("WorkStealingPool");
+    Task task;
+    for (;;) {
+        if (take(index, task)) {
+            task();
+            task = nullptr;
+            finishOne();
+            continue;
+        }
+        std::unique_lock<std::mutex> lk(m_sleepMutex);
+        m_wake.wait(lk, [this] { return m_stop || m_queued.load() > 0; });
+        if (m_stop && m_queued.load() == 0)
+            return;
+    }
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lk(m_sleepMutex);
+    m_idle.wait(lk, [this] { return m_pending.load() == 0; });
+}
+
+/**
+ * \brief Параллельный цикл: куски диапазона разбирают по общему счётчику вызывающий поток
+ *        и помощники из пула; чужие задачи вызывающий поток не выполняет.
+ */
+void WorkStealingPool::parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& fn) {
+    if (end <= begin) return;
+    grain = std::max(1, grain);
+    if (end - begin <= grain || m_threads.size() <= 1) {
+        fn(begin, end);
+        return;
+    }
+
+    struct Loop {
+        std::atomic<long long>  next;      ///< начало следующего невзятого куска
+        std::atomic<int>        left;      ///< кусков ещё не выполнено
+        std::mutex              mutex;
+        std::condition_variable done;
+    };
+    const int chunks = int((static_cast<long long>(end) - begin + grain - 1) / grain);
+    auto loop = std::make_shared<Loop>();
+    loop->next.store(begin);
+    loop->left.store(chunks);
+
+    // Помощник берёт куски, пока они есть; опоздавший сразу выходит и fn не трогает,
+    // поэтому ссылка на fn живёт не дольше вызова.
+    const std::function<void(int, int)>* body = &fn;
+    auto drain = [loop, body, end, grain] {
+        for (;;) {
+            const long long i0 = loop->next.fetch_add(grain);
+            if (i0 >= end) return;
+            (*body)(int(i0), int(std::min<long long>(end, i0 + grain)));
+            if (loop->left.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lk(loop->mutex);
+                loop->done.notify_all();
+            }
+        }
+    };
+    const int helpers = std::min(chunks - 1, threadCount());
+    for (int k = 0; k < helpers; ++k)
+        submit(drain);
+
+    drain();
+    std::unique_lock<std::mutex> lk(loop->mutex);
+    loop->done.wait(lk, [&] { return loop->left.load() == 0; });
+}
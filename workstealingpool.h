@@ -0,0 +1,72 @@
+// workstealingpool.h
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * \brief Пул потоков с перехватом задач (work stealing).
+ * \details У каждого рабочего потока своя очередь: свои задачи он берёт с конца (LIFO,
+ *          горячий кэш), чужие — перехватывает с начала (FIFO). Задачи, поставленные
+ *          из рабочего потока, попадают в его собственную очередь.
+ *
+ *          parallelFor() блокирует вызывающий поток, но тот сам разбирает куски своего
+ *          диапазона (чужих задач не берёт), а разобрав их, спит до конца последнего куска.
+ *          Поэтому вложенные вызовы из задач не приводят к взаимоблокировке.
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    /** \param threads Число потоков; 0 — по числу ядер. */
+    explicit WorkStealingPool(int threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    int threadCount() const { return int(m_threads.size()); }
+
+    /** \brief Поставить задачу в очередь. */
+    void submit(Task task);
+
+    /** \brief Дождаться завершения всех поставленных задач (нельзя звать из задачи). */
+    void wait();
+
+    /**
+     * \brief Разбить [begin, end) на куски по grain и выполнить fn(i0, i1) параллельно.
+     * \details Куски берутся по общему счётчику вызывающим потоком и не более чем
+     *          threadCount() помощниками из пула. Возвращается, когда все куски выполнены.
+     */
+    void parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& fn);
+
+    /** \brief Общий пул приложения (создаётся при первом обращении). */
+    static WorkStealingPool& global();
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> queue;
+    };
+
+    void run(int index);
+    /// \brief Взять задачу: сначала из своей очереди (self ≥ 0), затем украсть у других.
+    bool take(int self, Task& out);
+    void finishOne();
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    std::mutex              m_sleepMutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::atomic<int>        m_queued{0};   ///< задач в очередях
+    std::atomic<int>        m_pending{0};  ///< поставлено и ещё не завершено
+    std::atomic<unsigned>   m_nextQueue{0};
+    bool                    m_stop = false;
+};